@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+################################################
+#            compare_microbench.py             #
+#  (comparison of two microbenchmark results)  #
+################################################
+
+import argparse
+import csv
+import json
+import sys
+
+KEYS = ["name", "width", "height", "quality", "subsampling", "threads"]  # the fields to identify a case
+
+
+def load(filename):
+    with open(filename) as f:
+        if filename.endswith(".csv"):
+            rows = list(csv.DictReader(f))
+        else:
+            rows = json.load(f)
+    return {tuple(str(row[key]) for key in KEYS): float(row["ns_per_op"]) for row in rows}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the results of bin/microbench between two commits")
+    parser.add_argument("base", help="results of the base commit (JSON or CSV)")
+    parser.add_argument("target", help="results of the target commit (JSON or CSV)")
+    parser.add_argument("--threshold", type=float, default=5.0, help="percentage to mark a change")
+    args = parser.parse_args()
+
+    base = load(args.base)
+    target = load(args.target)
+    print("%-28s %6s %6s %4s %4s %3s %12s %12s %8s" % (
+        "name", "width", "height", "q", "samp", "thr", "base ns/op", "target ns/op", "change"))
+    regressed = False
+    for case in sorted(base.keys() & target.keys()):
+        change = (target[case] / base[case] - 1.0) * 100.0
+        mark = ""
+        if change > args.threshold:
+            mark = " slower"
+            regressed = True
+        elif change < -args.threshold:
+            mark = " faster"
+        print("%-28s %6s %6s %4s %4s %3s %12.1f %12.1f %+7.1f%%%s" % (
+            case + (base[case], target[case], change, mark)))
+    for case in sorted(base.keys() ^ target.keys()):
+        print("%-28s only in %s" % (case[0], args.base if case in base else args.target))
+    sys.exit(1 if regressed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+######################################################
+#                loopback_bench.py                   #
+#  (end-to-end benchmark on the loopback interface)  #
+######################################################
+
+import argparse
+import copy
+import json
+import math
+import os
+import re
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+CONF_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "conf")
+NODE_ID_FORMAT = "display%d"                       # the node ID of each display client
+STAGES = ["wait_us", "sync_us", "view_us"]         # the stages recorded by the display clients
+PERCENTILES = [50, 90, 99]                         # the reported percentiles
+FPS_PATTERN = re.compile(r"(\d+): ([0-9.]+)fps")   # the frame rate logged by the head node
+CLK_TCK = os.sysconf("SC_CLK_TCK")                 # the clock ticks per second
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Run head_server and display clients on localhost")
+    parser.add_argument("--bin", default=os.path.join(CONF_DIR, "..", "bin"), help="directory of the binaries")
+    parser.add_argument("--head-conf", default=os.path.join(CONF_DIR, "head_conf.json"))
+    parser.add_argument("--display-conf", default=os.path.join(CONF_DIR, "display_conf.json"))
+    parser.add_argument("--displays", type=int, default=4, help="number of the display clients")
+    parser.add_argument("--columns", type=int, default=0, help="number of the columns (default: all in a row)")
+    parser.add_argument("--width", type=int, help="resolution of each display")
+    parser.add_argument("--height", type=int, help="resolution of each display")
+    parser.add_argument("--video", help="video source (default: video.src in the head config)")
+    parser.add_argument("--source-type", help="video.source_type (video or tile_container)")
+    parser.add_argument("--warmup", type=float, default=5.0, help="seconds before measuring")
+    parser.add_argument("--duration", type=float, default=20.0, help="seconds to measure")
+    parser.add_argument("--json", help="write the report to this file")
+    parser.add_argument("--keep", action="store_true", help="keep the working directory")
+    return parser.parse_args()
+
+
+def load_json(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def write_json(path, obj):
+    with open(path, "w") as f:
+        json.dump(obj, f, indent=4)
+
+
+def make_configs(args, work_dir):
+    """Write the head config and the display configs for the loopback addresses"""
+    head = load_json(args.head_conf)
+    column = args.columns if args.columns > 0 else args.displays
+    if args.displays % column != 0:
+        sys.exit("Number of displays must be a multiple of columns")
+    head["layout"]["column"] = column
+    head["layout"]["row"] = args.displays // column
+    if args.width:
+        head["resolution"]["width"] = args.width
+    if args.height:
+        head["resolution"]["height"] = args.height
+    if args.video:
+        head["video"]["src"] = os.path.abspath(args.video)
+    if args.source_type:
+        head["video"]["source_type"] = args.source_type
+    node_ids = [NODE_ID_FORMAT % i for i in range(args.displays)]
+    head["display_node"] = [{"node_id": node_id} for node_id in node_ids]
+    head["relay_node"] = []
+    head_conf = os.path.join(work_dir, "head_conf.json")
+    write_json(head_conf, head)
+
+    # emulate the framebuffers on tmpfs if available
+    fb_dir = "/dev/shm" if os.path.isdir("/dev/shm") else work_dir
+    base = load_json(args.display_conf)
+    display_confs = []
+    for i, node_id in enumerate(node_ids):
+        display = copy.deepcopy(base)
+        display["head_node"] = {"ip": "127.0.0.1", "port": head["port"]["frontend_server"]}
+        display["node"] = {"id": node_id}
+        display["device"] = {"framebuffer": os.path.join(fb_dir, "tdw_bench_fb%d" % i)}
+        display["benchmark"] = {"stats_file": os.path.join(work_dir, "display%d.csv" % i)}
+        path = os.path.join(work_dir, "display%d_conf.json" % i)
+        write_json(path, display)
+        display_confs.append((path, display["device"]["framebuffer"], display["benchmark"]["stats_file"]))
+    return head_conf, display_confs
+
+
+def launch(cmd, log_path):
+    log = open(log_path, "w")
+    return subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT)
+
+
+def cpu_seconds(pid):
+    """Get the CPU time (user + system) of a process"""
+    with open("/proc/%d/stat" % pid) as f:
+        fields = f.read().rsplit(")", 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / CLK_TCK
+
+
+def loopback_bytes():
+    """Get the bytes sent on the loopback interface"""
+    with open("/proc/net/dev") as f:
+        for line in f:
+            name, _, counters = line.partition(":")
+            if name.strip() == "lo":
+                return int(counters.split()[8])
+    return 0
+
+
+def count_lines(path):
+    if not os.path.exists(path):
+        return 0
+    with open(path) as f:
+        return sum(1 for _ in f)
+
+
+def read_samples(path, begin, end):
+    """Read the elapsed time of the frames recorded in the measured window"""
+    samples = {stage: [] for stage in STAGES + ["frame_us"]}
+    with open(path) as f:
+        rows = f.read().splitlines()[1:]
+    for row in rows[max(begin-1, 0):max(end-1, 0)]:
+        values = row.split(",")
+        if len(values) != len(STAGES):
+            continue
+        values = [int(v) for v in values]
+        for stage, value in zip(STAGES, values):
+            samples[stage].append(value)
+        samples["frame_us"].append(sum(values))
+    return samples
+
+
+def percentile(values, p):
+    if not values:
+        return float("nan")
+    values = sorted(values)
+    return values[min(len(values)-1, max(0, int(math.ceil(p/100.0*len(values)))-1))]
+
+
+def snapshot(procs, stats_files):
+    return {
+        "time": time.time(),
+        "cpu": {name: cpu_seconds(proc.pid) for name, proc in procs},
+        "bytes": loopback_bytes(),
+        "frames": [count_lines(path) for path in stats_files],
+    }
+
+
+def check_alive(procs, work_dir):
+    for name, proc in procs:
+        if proc.poll() is not None:
+            log_path = os.path.join(work_dir, name + ".log")
+            with open(log_path) as f:
+                tail = f.read()[-2000:]
+            sys.exit("%s exited with %d\n%s" % (name, proc.returncode, tail))
+
+
+def make_report(args, pre, post, work_dir, stats_files):
+    elapsed = post["time"] - pre["time"]
+    frames = [b-a for a, b in zip(pre["frames"], post["frames"])]
+    samples = {stage: [] for stage in STAGES + ["frame_us"]}
+    for path, a, b in zip(stats_files, pre["frames"], post["frames"]):
+        for stage, values in read_samples(path, a, b).items():
+            samples[stage].extend(values)
+    with open(os.path.join(work_dir, "head.log")) as f:
+        head_fps = [float(m.group(2)) for m in FPS_PATTERN.finditer(f.read())]
+    return {
+        "displays": args.displays,
+        "duration_s": elapsed,
+        "fps": min(frames) / elapsed,
+        "head_fps_log": head_fps,
+        "latency_us": {
+            stage: {"p%d" % p: percentile(values, p) for p in PERCENTILES} for stage, values in samples.items()
+        },
+        "cpu_percent": {name: 100.0*(post["cpu"][name]-pre["cpu"][name])/elapsed for name in post["cpu"]},
+        "wire_bytes": post["bytes"] - pre["bytes"],
+        "wire_mbps": 8.0*(post["bytes"]-pre["bytes"])/elapsed/1e6,
+    }
+
+
+def print_report(report):
+    print("displays     : %d" % report["displays"])
+    print("duration     : %.1f s" % report["duration_s"])
+    print("end-to-end   : %.2f fps" % report["fps"])
+    print("bytes on wire: %d (%.1f Mbit/s)" % (report["wire_bytes"], report["wire_mbps"]))
+    print("latency [us] : " + "  ".join("%8s" % ("p%d" % p) for p in PERCENTILES))
+    for stage, values in report["latency_us"].items():
+        print("  %-10s : " % stage + "  ".join("%8s" % values["p%d" % p] for p in PERCENTILES))
+    print("CPU [%]      :")
+    for name, usage in sorted(report["cpu_percent"].items()):
+        print("  %-10s : %6.1f" % (name, usage))
+
+
+def main():
+    args = parse_args()
+    work_dir = tempfile.mkdtemp(prefix="tdw_bench_")
+    head_conf, display_confs = make_configs(args, work_dir)
+    stats_files = [stats for _, _, stats in display_confs]
+    procs = []
+    try:
+        # launch the head node and the display nodes
+        procs.append(("head", launch([os.path.join(args.bin, "head_server"), head_conf],
+                                     os.path.join(work_dir, "head.log"))))
+        time.sleep(1.0)
+        for i, (conf, _, _) in enumerate(display_confs):
+            name = "display%d" % i
+            procs.append((name, launch([os.path.join(args.bin, "display_client"), conf],
+                                       os.path.join(work_dir, name + ".log"))))
+
+        # measure after warming up
+        time.sleep(args.warmup)
+        check_alive(procs, work_dir)
+        pre = snapshot(procs, stats_files)
+        time.sleep(args.duration)
+        check_alive(procs, work_dir)
+        post = snapshot(procs, stats_files)
+    finally:
+        for _, proc in procs:
+            if proc.poll() is None:
+                proc.send_signal(signal.SIGTERM)
+        for _, proc in procs:
+            try:
+                proc.wait(timeout=5)
+            except subprocess.TimeoutExpired:
+                proc.kill()
+        for _, fb_file, _ in display_confs:
+            if fb_file.startswith("/dev/shm") and os.path.exists(fb_file):
+                os.remove(fb_file)
+
+    report = make_report(args, pre, post, work_dir, stats_files)
+    print_report(report)
+    if args.json:
+        write_json(args.json, report)
+    if args.keep:
+        print("logs are kept in " + work_dir)
+    else:
+        shutil.rmtree(work_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,33 @@
+#!/usr/bin/env python3
+###############################################
+#               merge_traces.py               #
+#  (merger of the frame traces of the nodes)  #
+###############################################
+
+import argparse
+import json
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Merge the trace files of the head node and the display nodes")
+    parser.add_argument("traces", nargs="+", help="trace files written by head_server and display_client")
+    parser.add_argument("-o", "--output", default="merged_trace.json", help="merged trace file")
+    args = parser.parse_args()
+
+    # give each node its own process ID (the nodes may share the same PIDs)
+    merged = []
+    for pid, filename in enumerate(args.traces, 1):
+        with open(filename) as f:
+            events = json.load(f)["traceEvents"]
+        for event in events:
+            event["pid"] = pid
+        merged.extend(events)
+        print("%s: %d events" % (filename, len(events)))
+
+    with open(args.output, "w") as f:
+        json.dump({"traceEvents": merged, "displayTimeUnit": "ms"}, f)
+    print("Wrote %s (open it in chrome://tracing or https://ui.perfetto.dev)" % args.output)
+
+
+if __name__ == "__main__":
+    main()
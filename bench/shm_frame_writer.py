@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+##############################################
+#            shm_frame_writer.py             #
+#  (producer of a shared memory frame ring)  #
+##############################################
+
+import argparse
+import mmap
+import os
+import struct
+import sys
+import time
+
+SHM_RING_MAGIC = 0x52574454   # the magic number of a shared memory ring ("TDWR")
+SHM_RING_VERSION = 1          # the format version of a shared memory ring
+SHM_RING_HEADER_SIZE = 4096   # the size reserved for the header (the slots are page aligned)
+HEADER_FORMAT = "<6I2Q"       # magic, version, width, height, slot_num, reserved, slot_size, write_seq
+WRITE_SEQ_OFFSET = 32         # the offset of write_seq in the header
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Write raw BGR frames from stdin into a shared memory ring read by head_server "
+                    "(e.g. ffmpeg -re -i video.mp4 -f rawvideo -pix_fmt bgr24 - | shm_frame_writer.py 1920 1080)"
+    )
+    parser.add_argument("width", type=int, help="width of the frames")
+    parser.add_argument("height", type=int, help="height of the frames")
+    parser.add_argument("--name", default="tdw_frames", help="name of the shared memory (video.src of head_server)")
+    parser.add_argument("--slots", type=int, default=4, help="number of the frame slots in the ring")
+    parser.add_argument("--fps", type=float, default=0, help="frame rate to write the frames (0 not to pace)")
+    args = parser.parse_args()
+
+    # create the ring (the slot size is rounded up to pages)
+    frame_size = args.width * args.height * 3
+    slot_size = (frame_size + mmap.PAGESIZE - 1) // mmap.PAGESIZE * mmap.PAGESIZE
+    path = "/dev/shm/" + args.name
+    fd = os.open(path, os.O_RDWR | os.O_CREAT | os.O_TRUNC, 0o644)
+    os.ftruncate(fd, SHM_RING_HEADER_SIZE + slot_size * args.slots)
+    ring = mmap.mmap(fd, SHM_RING_HEADER_SIZE + slot_size * args.slots)
+    struct.pack_into(HEADER_FORMAT, ring, 0, SHM_RING_MAGIC, SHM_RING_VERSION,
+                     args.width, args.height, args.slots, 0, slot_size, 0)
+    print("Writing %dx%d frames into %s with %d slots" % (args.width, args.height, path, args.slots))
+
+    # write each frame into its slot before publishing the number of the written frames
+    stdin = sys.stdin.buffer
+    write_seq = 0
+    next_t = time.monotonic()
+    try:
+        while True:
+            frame = stdin.read(frame_size)
+            if len(frame) < frame_size:
+                break
+            offset = SHM_RING_HEADER_SIZE + (write_seq % args.slots) * slot_size
+            ring[offset:offset + frame_size] = frame
+            write_seq += 1
+            struct.pack_into("<Q", ring, WRITE_SEQ_OFFSET, write_seq)
+            if args.fps > 0:
+                next_t += 1 / args.fps
+                time.sleep(max(0, next_t - time.monotonic()))
+    except KeyboardInterrupt:
+        pass
+    print("Wrote %d frames" % write_seq)
+    ring.close()
+    os.close(fd)
+
+
+if __name__ == "__main__":
+    main()
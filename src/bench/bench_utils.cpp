@@ -0,0 +1,167 @@
+/****************************************
+*            bench_utils.cpp            *
+*  (utilities for the microbenchmarks)  *
+****************************************/
+
+#include "bench_utils.hpp"
+
+/* constructor */
+BenchReporter::BenchReporter(const std::string& format, const std::string& output,
+                             const std::string& filter, const int min_time):
+    format(format),
+    output(output),
+    filter(filter),
+    min_time(min_time)
+{}
+
+/* check if a benchmark is selected by the filter */
+const bool BenchReporter::isEnabled(const std::string& name){
+    return this->filter.empty() || name.find(this->filter) != std::string::npos;
+}
+
+/* get the minimum time to repeat a benchmark */
+const int BenchReporter::getMinTime(){
+    return this->min_time;
+}
+
+/* repeat a function until stopped (at least MIN_ITERATIONS times) */
+void BenchReporter::runThread(const bench_func_t& func, std::atomic_bool& stop, long& count){
+    while(count < MIN_ITERATIONS || !stop.load(std::memory_order_acquire)){
+        func();
+        ++count;
+    }
+}
+
+/* repeat functions concurrently (one thread for each function) and record the time */
+void BenchReporter::measure(const std::string& name, const case_params_t& params,
+                            const std::vector<bench_func_t>& funcs, const double bytes_per_op){
+    // warm up the caches and the allocators
+    for(const bench_func_t& func : funcs){
+        func();
+    }
+    
+    // run the functions for the minimum time
+    const int thre_num = funcs.size();
+    std::atomic_bool stop(false);
+    std::vector<long> counts(thre_num, 0);
+    std::vector<std::thread> thres;
+    const hr_clock_t start_t = _chrono::high_resolution_clock::now();
+    for(int i=0; i<thre_num; ++i){
+        thres.push_back(std::thread(std::bind(&BenchReporter::runThread, this,
+                                              std::cref(funcs[i]), std::ref(stop), std::ref(counts[i]))));
+    }
+    std::this_thread::sleep_for(_chrono::milliseconds(this->min_time));
+    stop.store(true, std::memory_order_release);
+    for(std::thread& thre : thres){
+        thre.join();
+    }
+    const hr_clock_t end_t = _chrono::high_resolution_clock::now();
+    
+    long op_num = 0;
+    for(const long count : counts){
+        op_num += count;
+    }
+    const double elapsed_ns = _chrono::duration_cast<_chrono::nanoseconds>(end_t-start_t).count();
+    this->record(name, params, op_num, elapsed_ns, bytes_per_op);
+}
+
+/* record the time measured by the caller (the time per operation is the wall time over all the threads) */
+void BenchReporter::record(const std::string& name, const case_params_t& params,
+                           const long op_num, const double elapsed_ns, const double bytes_per_op){
+    const double ns_per_op = elapsed_ns / (double)op_num;
+    const double mb_per_s = bytes_per_op * (double)op_num / BYTES_PER_MB / (elapsed_ns/1e9);
+    this->results.push_back(std::make_tuple(name, params, op_num, ns_per_op, mb_per_s));
+    if(!this->output.empty()){
+        std::ostringstream msg;
+        msg << std::fixed << std::setprecision(1) << name << ": " << ns_per_op << " ns/op";
+        _ml::notice(msg.str());
+    }
+}
+
+/* format the results in JSON (one object per line to compare across commits with a text diff) */
+const std::string BenchReporter::toJson(){
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(1) << "[" << std::endl;
+    for(int i=0; i<int(this->results.size()); ++i){
+        const bench_result_t& result = this->results[i];
+        const case_params_t& params = std::get<1>(result);
+        json << "  {\"name\": \"" << std::get<0>(result) << "\""
+             << ", \"width\": " << std::get<0>(params)
+             << ", \"height\": " << std::get<1>(params)
+             << ", \"quality\": " << std::get<2>(params)
+             << ", \"subsampling\": \"" << getSubsamplingName(std::get<3>(params)) << "\""
+             << ", \"threads\": " << std::get<4>(params)
+             << ", \"iterations\": " << std::get<2>(result)
+             << ", \"ns_per_op\": " << std::get<3>(result)
+             << ", \"mb_per_s\": " << std::get<4>(result) << "}"
+             << (i+1<int(this->results.size()) ? "," : "") << std::endl;
+    }
+    json << "]" << std::endl;
+    return json.str();
+}
+
+/* format the results in CSV */
+const std::string BenchReporter::toCsv(){
+    std::ostringstream csv;
+    csv << std::fixed << std::setprecision(1)
+        << "name,width,height,quality,subsampling,threads,iterations,ns_per_op,mb_per_s" << std::endl;
+    for(const bench_result_t& result : this->results){
+        const case_params_t& params = std::get<1>(result);
+        csv << std::get<0>(result) << ","
+            << std::get<0>(params) << ","
+            << std::get<1>(params) << ","
+            << std::get<2>(params) << ","
+            << getSubsamplingName(std::get<3>(params)) << ","
+            << std::get<4>(params) << ","
+            << std::get<2>(result) << ","
+            << std::get<3>(result) << ","
+            << std::get<4>(result) << std::endl;
+    }
+    return csv.str();
+}
+
+/* write the results (to stdout if no file is given) */
+void BenchReporter::write(){
+    const std::string results = this->format==FORMAT_CSV ? this->toCsv() : this->toJson();
+    if(this->output.empty()){
+        std::cout << results << std::flush;
+        return;
+    }
+    std::ofstream ofs(this->output);
+    if(!ofs){
+        _ml::caution("Failed to write benchmark results", this->output);
+        std::exit(EXIT_FAILURE);
+    }
+    ofs << results;
+    _ml::notice("Wrote " + std::to_string(this->results.size()) + " results to " + this->output);
+}
+
+/* fill a frame with a gradient and noise (to keep the entropy close to a video frame) */
+void fillSyntheticFrame(unsigned char *frame, const int width, const int height, const int seed){
+    unsigned int noise = seed * 2654435761u + 1;
+    for(int y=0; y<height; ++y){
+        for(int x=0; x<width; ++x){
+            noise = noise * 1103515245u + 12345u;
+            const int rand_val = (noise >> 16) & 0x1f;
+            unsigned char *pixel = frame + (y*width+x)*PIXEL_SIZE;
+            pixel[0] = (unsigned char)((x*255/width + rand_val) & 0xff);
+            pixel[1] = (unsigned char)((y*255/height + rand_val) & 0xff);
+            pixel[2] = (unsigned char)(((x+y+seed)*4 + rand_val) & 0xff);
+        }
+    }
+}
+
+/* get the name of a subsampling type */
+const std::string getSubsamplingName(const int subsampling){
+    switch(subsampling){
+    case TJSAMP_444:
+        return "444";
+    case TJSAMP_422:
+        return "422";
+    case TJSAMP_420:
+        return "420";
+    case TJSAMP_GRAY:
+        return "gray";
+    }
+    return "-";
+}
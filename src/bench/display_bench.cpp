@@ -0,0 +1,279 @@
+/**************************************************
+*                display_bench.cpp                *
+*  (microbenchmarks for the display node stages)  *
+**************************************************/
+
+#include "display_bench.hpp"
+#include "frame_decoder.hpp"
+#include "sync_message_generator.hpp"
+#include "color_corrector.hpp"
+#include <memory>
+#include <algorithm>
+
+/* encode a synthetic tile with the frame index in front (as sent by the head node) */
+const std::string makeJpegTile(const int width, const int height, const int quality,
+                               const int subsampling, const int seed, const int id){
+    std::vector<unsigned char> raw_frame(width*height*PIXEL_SIZE);
+    fillSyntheticFrame(raw_frame.data(), width, height, seed);
+    
+    const tjhandle handle = tjInitCompress();
+    unsigned char *jpeg_frame = NULL;
+    unsigned long jpeg_size = 0;
+    const int tj_stat = tjCompress2(handle, raw_frame.data(), width, width*PIXEL_SIZE, height, TJPF_RGB,
+                                    &jpeg_frame, &jpeg_size, subsampling, quality, TJFLAG_FASTDCT);
+    if(tj_stat == JPEG_FAILED){
+        const std::string err_msg(tjGetErrorStr());
+        _ml::caution("Failed to encode synthetic tile", err_msg);
+        std::exit(EXIT_FAILURE);
+    }
+    const std::string jpeg_str = std::to_string(id) + std::string(jpeg_frame, jpeg_frame+jpeg_size);
+    tjFree(jpeg_frame);
+    tjDestroy(handle);
+    return jpeg_str;
+}
+
+/* resources of a decoder in the benchmarks */
+struct DecoderBench{
+    const tranbuf_ptr_t recv_buf;           // the receive framebuffer (unused)
+    const viewbuf_ptr_t view_buf;           // the view framebuffer
+    std::unique_ptr<FrameDecoder> decoder;  // the decoder
+    const std::string jpeg_str;             // the JPEG tile to decode
+    const int scale;                        // the denominator of the scale to decode the tile at
+    
+    DecoderBench(const int width, const int height, const int page_num,  // constructor
+                 const std::string& jpeg_str, const int scale);
+};
+
+/* constructor */
+DecoderBench::DecoderBench(const int width, const int height, const int page_num, const std::string& jpeg_str,
+                           const int scale):
+    recv_buf(std::make_shared<TransceiveFramebuffer>(DISP_BENCH_BUF_NUM)),
+    view_buf(std::make_shared<ViewFramebuffer>(width, height, page_num)),
+    decoder(new FrameDecoder(recv_buf, view_buf, DECODE_BENCH_FPS, false)),
+    jpeg_str(jpeg_str),
+    scale(scale)
+{}
+
+/* decode a tile and release the page at once */
+void runDecode(DecoderBench *bench){
+    bench->decoder->decodeFrame(bench->jpeg_str, 0, bench->scale);
+    bench->view_buf->deactivatePage();
+}
+
+/* decode the frames assigned to a decoder thread (or only hand off the pages) */
+void runPipelineDecoder(const viewbuf_ptr_t view_buf, FrameDecoder *decoder, const std::vector<std::string> *jpeg_strs,
+                        const int thre_id, const int thre_num, const int frame_num){
+    const int page_num = jpeg_strs->size();
+    for(int i=thre_id; i<frame_num; i+=thre_num){
+        if(decoder != NULL){
+            decoder->decodeFrame((*jpeg_strs)[i%page_num], i);
+        }else{
+            view_buf->getDrawPage(i%page_num);
+            view_buf->activatePage(i%page_num);
+        }
+    }
+}
+
+/* display the frames in order as the frame viewer does */
+void runPipelineViewer(const viewbuf_ptr_t view_buf, const int frame_num){
+    for(int i=0; i<frame_num; ++i){
+        view_buf->getDisplayPage();
+        view_buf->deactivatePage();
+    }
+}
+
+/* pass frames from the decoder threads to the viewer through the view framebuffer (return the elapsed time [ns]) */
+const double runPipeline(const int width, const int height, const int thre_num, const int frame_num,
+                         const std::vector<std::string>& jpeg_strs, const bool decode){
+    const int page_num = jpeg_strs.size();
+    const tranbuf_ptr_t recv_buf = std::make_shared<TransceiveFramebuffer>(DISP_BENCH_BUF_NUM);
+    const viewbuf_ptr_t view_buf = std::make_shared<ViewFramebuffer>(width, height, page_num);
+    std::vector<std::unique_ptr<FrameDecoder>> decoders;
+    for(int i=0; i<thre_num; ++i){
+        decoders.emplace_back(new FrameDecoder(recv_buf, view_buf, DECODE_BENCH_FPS, false));
+    }
+    
+    const hr_clock_t start_t = _chrono::high_resolution_clock::now();
+    std::vector<std::thread> thres;
+    for(int i=0; i<thre_num; ++i){
+        FrameDecoder *decoder = decode ? decoders[i].get() : NULL;
+        thres.push_back(std::thread(std::bind(runPipelineDecoder, view_buf, decoder, &jpeg_strs, i, thre_num, frame_num)));
+    }
+    runPipelineViewer(view_buf, frame_num);
+    for(std::thread& thre : thres){
+        thre.join();
+    }
+    const hr_clock_t end_t = _chrono::high_resolution_clock::now();
+    return _chrono::duration_cast<_chrono::nanoseconds>(end_t-start_t).count();
+}
+
+/* run the benchmarks of decoding the tiles */
+void runDecodeBenches(BenchReporter& reporter, const bool quick){
+    const int tile_num = quick ? 1 : sizeof(TILE_SIZE_LIST)/sizeof(TILE_SIZE_LIST[0]);
+    const int quality_num = quick ? 1 : sizeof(QUALITY_LIST)/sizeof(QUALITY_LIST[0]);
+    const int subsampling_num = quick ? 1 : sizeof(SUBSAMPLING_LIST)/sizeof(SUBSAMPLING_LIST[0]);
+    for(int i=0; i<tile_num; ++i){
+        const int width = TILE_SIZE_LIST[i][0];
+        const int height = TILE_SIZE_LIST[i][1];
+        for(int q=0; q<quality_num; ++q){
+            for(int s=0; s<subsampling_num; ++s){
+                const std::string jpeg_str = makeJpegTile(width, height, QUALITY_LIST[q], SUBSAMPLING_LIST[s], i, 0);
+                for(const int thre_num : THREAD_NUM_LIST){
+                    std::vector<std::unique_ptr<DecoderBench>> benches;
+                    std::vector<bench_func_t> funcs;
+                    for(int t=0; t<thre_num; ++t){
+                        benches.emplace_back(new DecoderBench(width, height, 1, jpeg_str, DECODE_SCALE_FULL));
+                        funcs.push_back(std::bind(runDecode, benches.back().get()));
+                    }
+                    reporter.measure("decoder.decode",
+                                     std::make_tuple(width, height, QUALITY_LIST[q], SUBSAMPLING_LIST[s], thre_num),
+                                     funcs, width*height*PIXEL_SIZE);
+                    if(quick){
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* run the benchmarks of decoding a tile at each scale and upscaling it into the page (full scale for comparison) */
+void runScaledDecodeBenches(BenchReporter& reporter, const bool quick){
+    const int tile_num = quick ? 1 : sizeof(TILE_SIZE_LIST)/sizeof(TILE_SIZE_LIST[0]);
+    const std::string names[] = {"decoder.scaled_decode/full", "decoder.scaled_decode/half",
+                                 "decoder.scaled_decode/quarter"};
+    const int scales[] = {DECODE_SCALE_FULL, DECODE_SCALE_HALF, DECODE_SCALE_QUARTER};
+    for(int i=0; i<tile_num; ++i){
+        const int width = TILE_SIZE_LIST[i][0];
+        const int height = TILE_SIZE_LIST[i][1];
+        const std::string jpeg_str = makeJpegTile(width, height, QUALITY_LIST[0], SUBSAMPLING_LIST[0], i, 0);
+        for(int s=0; s<3; ++s){
+            if(!reporter.isEnabled(names[s])){
+                continue;
+            }
+            DecoderBench bench(width, height, 1, jpeg_str, scales[s]);
+            const std::vector<bench_func_t> funcs = {std::bind(runDecode, &bench)};
+            reporter.measure(names[s], std::make_tuple(width, height, QUALITY_LIST[0], SUBSAMPLING_LIST[0], 1),
+                             funcs, width*height*PIXEL_SIZE);
+        }
+    }
+}
+
+/* run the benchmarks of the view framebuffer (page handoff only, and with decoding) */
+void runPipelineBenches(BenchReporter& reporter, const bool quick, const bool decode){
+    const std::string name = decode ? "viewbuf.decode_pipeline" : "viewbuf.handoff";
+    const int tile_num = quick ? 1 : sizeof(TILE_SIZE_LIST)/sizeof(TILE_SIZE_LIST[0]);
+    for(int i=0; i<tile_num; ++i){
+        const int width = TILE_SIZE_LIST[i][0];
+        const int height = TILE_SIZE_LIST[i][1];
+        for(const int thre_num : THREAD_NUM_LIST){
+            // the view framebuffer has as many pages as the display node allocates
+            const int page_num = thre_num + VIEWBUF_EXTRA_NUM;
+            std::vector<std::string> jpeg_strs;
+            for(int p=0; p<page_num; ++p){
+                jpeg_strs.push_back(makeJpegTile(width, height, QUALITY_LIST[0], SUBSAMPLING_LIST[0], p, p));
+            }
+            
+            // scale the frame count to the minimum time with a short calibration run
+            const int calib_num = page_num * PIPELINE_CALIB_ROUND;
+            const double calib_ns = runPipeline(width, height, thre_num, calib_num, jpeg_strs, decode);
+            const double target_ns = reporter.getMinTime() * 1e6;
+            const int frame_num = std::max(calib_num, (int)(calib_num*target_ns/calib_ns));
+            
+            const double elapsed_ns = runPipeline(width, height, thre_num, frame_num, jpeg_strs, decode);
+            reporter.record(name, std::make_tuple(width, height, QUALITY_LIST[0], SUBSAMPLING_LIST[0], thre_num),
+                            frame_num, elapsed_ns, width*height*PIXEL_SIZE);
+            if(quick){
+                break;
+            }
+        }
+    }
+}
+
+/* run the benchmark of generating the sync messages */
+void runSyncBenches(BenchReporter& reporter){
+    const tranbuf_ptr_t recv_buf = std::make_shared<TransceiveFramebuffer>(DISP_BENCH_BUF_NUM);
+    SyncMessageGenerator generator(SYNC_BENCH_FPS, SYNC_BENCH_JITTER, SYNC_BENCH_TUNING_TERM,
+                                   recv_buf, SUBSAMPLING_LIST[0], QUALITY_LIST[0]);
+    const std::vector<bench_func_t> funcs = {std::bind(&SyncMessageGenerator::generate, &generator)};
+    reporter.measure("sync.generate", std::make_tuple(PARAM_NONE, PARAM_NONE, PARAM_NONE, PARAM_NONE, 1), funcs, 0);
+}
+
+/* copy a frame into another buffer row by row with the color correction (as the frame viewer presents a page) */
+void runPresent(ColorCorrector *corrector, unsigned char *dst, const unsigned char *src,
+                const int width, const int height)
+{
+    const size_t pitch = (size_t)width * PIXEL_SIZE;
+    for(int i=0; i<height; ++i){
+        corrector->correctRow(dst+pitch*i, src+pitch*i, width);
+    }
+}
+
+/* make a 3D LUT of a panel with a warm tint and crosstalk between the channels (RGB values with red varying fastest) */
+const std::vector<double> makeBenchLattice(const int size){
+    std::vector<double> values;
+    for(int b=0; b<size; ++b){
+        for(int g=0; g<size; ++g){
+            for(int r=0; r<size; ++r){
+                const double red = (double)r / (size-1);
+                const double green = (double)g / (size-1);
+                const double blue = (double)b / (size-1);
+                values.push_back(std::min(0.92*red + 0.08*green, 1.0));
+                values.push_back(std::pow(green, 1.1));
+                values.push_back(0.85*blue + 0.05*red*green);
+            }
+        }
+    }
+    return values;
+}
+
+/* run the benchmarks of presenting a frame with each kind of the color correction (a plain copy for comparison) */
+void runColorBenches(BenchReporter& reporter, const bool quick){
+    const int tile_num = quick ? 1 : sizeof(TILE_SIZE_LIST)/sizeof(TILE_SIZE_LIST[0]);
+    const std::string names[] = {"viewer.present/copy", "viewer.present/curves",
+                                 "viewer.present/lut3d_17", "viewer.present/lut3d_33"};
+    for(int i=0; i<tile_num; ++i){
+        const int width = TILE_SIZE_LIST[i][0];
+        const int height = TILE_SIZE_LIST[i][1];
+        std::vector<unsigned char> src(width*height*PIXEL_SIZE);
+        std::vector<unsigned char> dst(width*height*PIXEL_SIZE);
+        fillSyntheticFrame(src.data(), width, height, i);
+        
+        ColorCorrector correctors[4];
+        correctors[1].setCurves(COLOR_BENCH_GAIN, COLOR_BENCH_GAMMA, COLOR_BENCH_OFFSET);
+        correctors[2].setLattice(COLOR_BENCH_LUT_SIZES[0], makeBenchLattice(COLOR_BENCH_LUT_SIZES[0]));
+        correctors[3].setLattice(COLOR_BENCH_LUT_SIZES[1], makeBenchLattice(COLOR_BENCH_LUT_SIZES[1]));
+        for(int c=0; c<4; ++c){
+            if(!reporter.isEnabled(names[c])){
+                continue;
+            }
+            const std::vector<bench_func_t> funcs = {
+                std::bind(runPresent, &correctors[c], dst.data(), src.data(), width, height)
+            };
+            reporter.measure(names[c], std::make_tuple(width, height, PARAM_NONE, PARAM_NONE, 1),
+                             funcs, width*height*PIXEL_SIZE);
+        }
+    }
+}
+
+/* run the benchmarks of decoding and viewing */
+void runDisplayBenches(BenchReporter& reporter, const bool quick){
+    if(reporter.isEnabled("decoder.decode")){
+        runDecodeBenches(reporter, quick);
+    }
+    if(reporter.isEnabled("decoder.scaled_decode")){
+        runScaledDecodeBenches(reporter, quick);
+    }
+    if(reporter.isEnabled("viewbuf.handoff")){
+        runPipelineBenches(reporter, quick, false);
+    }
+    if(reporter.isEnabled("viewbuf.decode_pipeline")){
+        runPipelineBenches(reporter, quick, true);
+    }
+    if(reporter.isEnabled("sync.generate")){
+        runSyncBenches(reporter);
+    }
+    if(reporter.isEnabled("viewer.present")){
+        runColorBenches(reporter, quick);
+    }
+}
@@ -0,0 +1,118 @@
+/***********************************************
+*                head_bench.cpp                *
+*  (microbenchmarks for the head node stages)  *
+***********************************************/
+
+#include "head_bench.hpp"
+#include "frame_encoder.hpp"
+#include <memory>
+
+/* resources of an encoder in the benchmarks */
+struct EncoderBench{
+    jpeg_params_t ycbcr_format_list;        // the YCbCr formats applied for the tiles
+    jpeg_params_t quality_list;             // the quality factors applied for the tiles
+    std::vector<tranbuf_ptr_t> send_bufs;   // the send framebuffers
+    std::unique_ptr<FrameEncoder> encoder;  // the encoder
+    cv::Mat source_frame;                   // the synthetic source frame
+    cv::Mat work_frame;                     // the frame resized in place
+    
+    EncoderBench(const int frame_w, const int frame_h, const int column, const int row,  // constructor
+                 const int width, const int height, const int ycbcr_format, const int quality, const int seed);
+};
+
+/* constructor (prepare an encoder and a synthetic source frame) */
+EncoderBench::EncoderBench(const int frame_w, const int frame_h, const int column, const int row,
+                           const int width, const int height, const int ycbcr_format, const int quality,
+                           const int seed):
+    ycbcr_format_list(column*row),
+    quality_list(column*row),
+    send_bufs(column*row),
+    source_frame(cv::Size(frame_w, frame_h), CV_8UC3)
+{
+    for(int i=0; i<column*row; ++i){
+        this->ycbcr_format_list[i].store(ycbcr_format, std::memory_order_release);
+        this->quality_list[i].store(quality, std::memory_order_release);
+        this->send_bufs[i] = std::make_shared<TransceiveFramebuffer>(HEAD_BENCH_BUF_NUM);
+    }
+    const tile_shape_list_t tile_shapes(column*row, std::forward_as_tuple(width, height, ROTATION_NONE));
+    this->encoder.reset(new FrameEncoder(frame_w, frame_h, column, row, 0, 0, width, height, tile_shapes,
+                                         this->ycbcr_format_list, this->quality_list, this->send_bufs));
+    fillSyntheticFrame(this->source_frame.data, frame_w, frame_h, seed);
+}
+
+/* resize a copy of the source frame (a decoded video frame is a new buffer each time) */
+void runResize(EncoderBench *bench){
+    bench->source_frame.copyTo(bench->work_frame);
+    bench->encoder->resize(bench->work_frame);
+}
+
+/* encode a tile and take it out of the send framebuffer */
+void runEncode(EncoderBench *bench){
+    bench->encoder->encode(0);
+    bench->send_bufs[0]->pop();
+}
+
+/* run the benchmarks of resizing the source frames onto the wall */
+void runResizeBenches(BenchReporter& reporter, const bool quick){
+    const int source_num = quick ? 1 : sizeof(SOURCE_SIZE_LIST)/sizeof(SOURCE_SIZE_LIST[0]);
+    for(int i=0; i<source_num; ++i){
+        const int frame_w = SOURCE_SIZE_LIST[i][0];
+        const int frame_h = SOURCE_SIZE_LIST[i][1];
+        for(const int thre_num : THREAD_NUM_LIST){
+            std::vector<std::unique_ptr<EncoderBench>> benches;
+            std::vector<bench_func_t> funcs;
+            for(int t=0; t<thre_num; ++t){
+                benches.emplace_back(new EncoderBench(frame_w, frame_h, WALL_COLUMN, WALL_ROW,
+                                                      WALL_TILE_W, WALL_TILE_H, TJSAMP_420, QUALITY_LIST[0], t));
+                funcs.push_back(std::bind(runResize, benches.back().get()));
+            }
+            reporter.measure("encoder.resize",
+                             std::make_tuple(frame_w, frame_h, PARAM_NONE, PARAM_NONE, thre_num),
+                             funcs, frame_w*frame_h*PIXEL_SIZE);
+            if(quick){
+                break;
+            }
+        }
+    }
+}
+
+/* run the benchmarks of encoding the tiles */
+void runEncodeBenches(BenchReporter& reporter, const bool quick){
+    const int tile_num = quick ? 1 : sizeof(TILE_SIZE_LIST)/sizeof(TILE_SIZE_LIST[0]);
+    const int quality_num = quick ? 1 : sizeof(QUALITY_LIST)/sizeof(QUALITY_LIST[0]);
+    const int subsampling_num = quick ? 1 : sizeof(SUBSAMPLING_LIST)/sizeof(SUBSAMPLING_LIST[0]);
+    for(int i=0; i<tile_num; ++i){
+        const int width = TILE_SIZE_LIST[i][0];
+        const int height = TILE_SIZE_LIST[i][1];
+        for(int q=0; q<quality_num; ++q){
+            for(int s=0; s<subsampling_num; ++s){
+                for(const int thre_num : THREAD_NUM_LIST){
+                    std::vector<std::unique_ptr<EncoderBench>> benches;
+                    std::vector<bench_func_t> funcs;
+                    for(int t=0; t<thre_num; ++t){
+                        benches.emplace_back(new EncoderBench(width, height, 1, 1, width, height,
+                                                              SUBSAMPLING_LIST[s], QUALITY_LIST[q], t));
+                        runResize(benches.back().get());
+                        funcs.push_back(std::bind(runEncode, benches.back().get()));
+                    }
+                    reporter.measure("encoder.encode",
+                                     std::make_tuple(width, height, QUALITY_LIST[q], SUBSAMPLING_LIST[s], thre_num),
+                                     funcs, width*height*PIXEL_SIZE);
+                    if(quick){
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* run the benchmarks of resizing and encoding */
+void runHeadBenches(BenchReporter& reporter, const bool quick){
+    if(reporter.isEnabled("encoder.resize")){
+        runResizeBenches(reporter, quick);
+    }
+    if(reporter.isEnabled("encoder.encode")){
+        runEncodeBenches(reporter, quick);
+    }
+}
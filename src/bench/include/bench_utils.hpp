@@ -0,0 +1,73 @@
+/****************************************
+*            bench_utils.hpp            *
+*  (utilities for the microbenchmarks)  *
+****************************************/
+
+#ifndef BENCH_UTILS_HPP
+#define BENCH_UTILS_HPP
+
+#include "async_logger.hpp"
+#include "sync_utils.hpp"
+#include <string>
+#include <vector>
+#include <tuple>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+extern "C"{
+    #include <turbojpeg.h>
+}
+
+using bench_func_t = std::function<void()>;
+using case_params_t = std::tuple<int, int, int, int, int>;  // width, height, quality, subsampling, threads
+using bench_result_t = std::tuple<std::string, case_params_t, long, double, double>;
+
+const std::string FORMAT_JSON = "json";   // the format to write the results in JSON
+const std::string FORMAT_CSV = "csv";     // the format to write the results in CSV
+const int PARAM_NONE = -1;                // the value of the parameters not applied to a benchmark
+const int MIN_ITERATIONS = 3;             // the minimum number of the iterations in each thread
+const int MIN_TIME_DEFAULT = 300;         // the default time to repeat a benchmark [ms]
+const double BYTES_PER_MB = 1000000.0;    // the number of the bytes in a megabyte
+const int PIXEL_SIZE = 3;                 // the number of the bytes in an RGB pixel
+const int THREAD_NUM_LIST[] = {1, 2, 4};  // the numbers of the threads swept in the benchmarks
+const int TILE_SIZE_LIST[][2] = {         // the resolutions of the tiles
+    {960, 540}, {1920, 1080}, {3840, 2160}
+};
+const int QUALITY_LIST[] = {80, 50, 95};  // the quality factors of the tiles
+const int SUBSAMPLING_LIST[] = {          // the YCbCr formats of the tiles
+    TJSAMP_420, TJSAMP_422, TJSAMP_444
+};
+
+/* runner and reporter of the microbenchmarks */
+class BenchReporter{
+    private:
+        const std::string format;             // the format of the results
+        const std::string output;             // the file to write the results (stdout if empty)
+        const std::string filter;             // the substring to select the benchmarks
+        const int min_time;                   // the minimum time to repeat a benchmark [ms]
+        std::vector<bench_result_t> results;  // the results of the benchmarks
+        
+        void runThread(const bench_func_t& func, std::atomic_bool& stop,  // repeat a function until stopped
+                       long& count);
+        const std::string toJson();                                       // format the results in JSON
+        const std::string toCsv();                                        // format the results in CSV
+    
+    public:
+        BenchReporter(const std::string& format, const std::string& output,  // constructor
+                      const std::string& filter, const int min_time);
+        const bool isEnabled(const std::string& name);                       // check if a benchmark is selected
+        const int getMinTime();                                              // get the minimum time of a benchmark
+        void measure(const std::string& name, const case_params_t& params,   // repeat functions concurrently and record the time
+                     const std::vector<bench_func_t>& funcs, const double bytes_per_op);
+        void record(const std::string& name, const case_params_t& params,    // record the time measured by the caller
+                    const long op_num, const double elapsed_ns, const double bytes_per_op);
+        void write();                                                        // write the results
+};
+
+void fillSyntheticFrame(unsigned char *frame, const int width,  // fill a frame with a gradient and noise
+                        const int height, const int seed);
+const std::string getSubsamplingName(const int subsampling);    // get the name of a subsampling type
+
+#endif  /* BENCH_UTILS_HPP */
@@ -0,0 +1,24 @@
+/**************************************************
+*                display_bench.hpp                *
+*  (microbenchmarks for the display node stages)  *
+**************************************************/
+
+#ifndef DISPLAY_BENCH_HPP
+#define DISPLAY_BENCH_HPP
+
+#include "bench_utils.hpp"
+
+const int DISP_BENCH_BUF_NUM = 1;                                 // the size of the receive framebuffer in the benchmarks
+const int DECODE_BENCH_FPS = 30;                                  // the target frame rate of the decoders
+const int SYNC_BENCH_FPS = 30;                                    // the target frame rate of the sync message generator
+const double SYNC_BENCH_JITTER = 2.0;                             // the acceptable jitter of the frame rate
+const int SYNC_BENCH_TUNING_TERM = 30;                            // the term of tuning the JPEG parameters
+const int PIPELINE_CALIB_ROUND = 4;                               // the number of the rounds of the view buffer to calibrate the frame count
+const std::vector<double> COLOR_BENCH_GAIN = {0.95, 1.0, 0.9};    // the gain of the curves of a drifted panel (RGB)
+const std::vector<double> COLOR_BENCH_GAMMA = {1.05, 1.0, 1.1};   // the gamma of the curves of a drifted panel (RGB)
+const std::vector<double> COLOR_BENCH_OFFSET = {0.0, 0.01, 0.0};  // the offset of the curves of a drifted panel (RGB)
+const int COLOR_BENCH_LUT_SIZES[] = {17, 33};                     // the numbers of the lattice points of the 3D LUTs
+
+void runDisplayBenches(BenchReporter& reporter, const bool quick);  // run the benchmarks of decoding and viewing
+
+#endif  /* DISPLAY_BENCH_HPP */
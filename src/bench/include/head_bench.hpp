@@ -0,0 +1,22 @@
+/***********************************************
+*                head_bench.hpp                *
+*  (microbenchmarks for the head node stages)  *
+***********************************************/
+
+#ifndef HEAD_BENCH_HPP
+#define HEAD_BENCH_HPP
+
+#include "bench_utils.hpp"
+
+const int WALL_COLUMN = 2;           // the number of the displays in the benchmark wall (horizontal)
+const int WALL_ROW = 2;              // the number of the displays in the benchmark wall (vertical)
+const int WALL_TILE_W = 960;         // the width of a display in the benchmark wall
+const int WALL_TILE_H = 540;         // the height of a display in the benchmark wall
+const int SOURCE_SIZE_LIST[][2] = {  // the resolutions of the source frames to resize
+    {1920, 1080}, {1280, 720}, {3840, 2160}
+};
+const int HEAD_BENCH_BUF_NUM = 1;    // the size of the send framebuffer in the benchmarks
+
+void runHeadBenches(BenchReporter& reporter, const bool quick);  // run the benchmarks of resizing and encoding
+
+#endif  /* HEAD_BENCH_HPP */
@@ -0,0 +1,16 @@
+/*************************************************
+*                    main.hpp                    *
+*  (main function for the microbenchmark suite)  *
+*************************************************/
+
+#ifndef MAIN_HPP
+#define MAIN_HPP
+
+#include "head_bench.hpp"
+#include "display_bench.hpp"
+#include "queue_bench.hpp"
+
+const std::string USAGE = "Usage: microbench [--format json|csv] [--output <file>] "  // the usage of the command
+                          "[--filter <name>] [--min-time <ms>] [--quick]";
+
+#endif  /* MAIN_HPP */
@@ -0,0 +1,18 @@
+/*******************************************
+*             queue_bench.hpp              *
+*  (microbenchmarks for the frame queues)  *
+*******************************************/
+
+#ifndef QUEUE_BENCH_HPP
+#define QUEUE_BENCH_HPP
+
+#include "bench_utils.hpp"
+
+const int QUEUE_BENCH_BUF_NUM = 4;  // the size of the framebuffer in the benchmarks
+const int JPEG_SIZE_LIST[] = {      // the sizes of the JPEG tiles passed through the queue
+    64*1024, 256*1024, 1024*1024
+};
+
+void runQueueBenches(BenchReporter& reporter, const bool quick);  // run the benchmarks of the transceive framebuffer
+
+#endif  /* QUEUE_BENCH_HPP */
@@ -0,0 +1,49 @@
+/*************************************************
+*                    main.cpp                    *
+*  (main function for the microbenchmark suite)  *
+*************************************************/
+
+#include "main.hpp"
+
+/* main function */
+int main(int argc, char *argv[]){
+    // parse the command line arguments
+    std::string format = FORMAT_JSON;
+    std::string output;
+    std::string filter;
+    int min_time = MIN_TIME_DEFAULT;
+    bool quick = false;
+    for(int i=1; i<argc; ++i){
+        const std::string arg(argv[i]);
+        if(arg == "--quick"){
+            quick = true;
+            continue;
+        }
+        if(i+1 >= argc){
+            _ml::caution("Argument is invalid: " + arg, USAGE);
+            std::exit(EXIT_FAILURE);
+        }
+        const std::string value(argv[++i]);
+        if(arg == "--format" && (value == FORMAT_JSON || value == FORMAT_CSV)){
+            format = value;
+        }else if(arg == "--output"){
+            output = value;
+        }else if(arg == "--filter"){
+            filter = value;
+        }else if(arg == "--min-time"){
+            min_time = std::stoi(value);
+        }else{
+            _ml::caution("Argument is invalid: " + arg, USAGE);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    
+    // run the benchmarks stage by stage
+    BenchReporter reporter(format, output, filter, min_time);
+    runHeadBenches(reporter, quick);
+    runQueueBenches(reporter, quick);
+    runDisplayBenches(reporter, quick);
+    reporter.write();
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,39 @@
+/*******************************************
+*             queue_bench.cpp              *
+*  (microbenchmarks for the frame queues)  *
+*******************************************/
+
+#include "queue_bench.hpp"
+#include "transceive_framebuffer.hpp"
+#include <memory>
+
+/* push a JPEG tile and pop it again (the copies into and out of the buffer are included) */
+void runPushPop(const tranbuf_ptr_t buf, const std::string *jpeg_str){
+    buf->push(*jpeg_str);
+    buf->pop();
+}
+
+/* run the benchmarks of the transceive framebuffer (one buffer per thread) */
+void runQueueBenches(BenchReporter& reporter, const bool quick){
+    if(!reporter.isEnabled("tranbuf.push_pop")){
+        return;
+    }
+    const int size_num = quick ? 1 : sizeof(JPEG_SIZE_LIST)/sizeof(JPEG_SIZE_LIST[0]);
+    for(int i=0; i<size_num; ++i){
+        const std::string jpeg_str(JPEG_SIZE_LIST[i], 'x');
+        const std::string name = "tranbuf.push_pop/" + std::to_string(JPEG_SIZE_LIST[i]/1024) + "k";
+        for(const int thre_num : THREAD_NUM_LIST){
+            std::vector<tranbuf_ptr_t> bufs;
+            std::vector<bench_func_t> funcs;
+            for(int t=0; t<thre_num; ++t){
+                bufs.push_back(std::make_shared<TransceiveFramebuffer>(QUEUE_BENCH_BUF_NUM));
+                funcs.push_back(std::bind(runPushPop, bufs.back(), &jpeg_str));
+            }
+            reporter.measure(name, std::make_tuple(PARAM_NONE, PARAM_NONE, PARAM_NONE, PARAM_NONE, thre_num),
+                             funcs, JPEG_SIZE_LIST[i]);
+            if(quick){
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,315 @@
+/*********************************************
+*              async_logger.cpp              *
+*  (logging tools with a background writer)  *
+*********************************************/
+
+#include "async_logger.hpp"
+
+/* constructor */
+LogQueue::LogQueue(const int size, const int tid):
+    records(size),
+    mask(size-1),
+    head(0),
+    tail(0),
+    dropped(0),
+    tid(tid)
+{}
+
+/* push a record (the strings are moved into the queue) */
+const bool LogQueue::push(LogRecord& record){
+    const uint64_t index = this->head.load(std::memory_order_relaxed);
+    if(index-this->tail.load(std::memory_order_acquire) > this->mask){
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    this->records[index & this->mask] = std::move(record);
+    this->head.store(index+1, std::memory_order_release);
+    return true;
+}
+
+/* pop a record */
+const bool LogQueue::pop(LogRecord& record){
+    const uint64_t index = this->tail.load(std::memory_order_relaxed);
+    if(index == this->head.load(std::memory_order_acquire)){
+        return false;
+    }
+    record = std::move(this->records[index & this->mask]);
+    this->tail.store(index+1, std::memory_order_release);
+    return true;
+}
+
+/* get and reset the number of the dropped records */
+const uint64_t LogQueue::takeDropped(){
+    return this->dropped.exchange(0, std::memory_order_relaxed);
+}
+
+/* get the ID of the thread */
+const int LogQueue::getTid(){
+    return this->tid;
+}
+
+namespace async_logger{
+    /* state of the repeated warnings in the current window */
+    struct RateLimit{
+        int64_t window_t;  // the start time of the window
+        int count;         // the number of the warnings in the window
+        int suppressed;    // the number of the warnings not written in the window
+    };
+    
+    /* state of the logger (never destructed to be used until the process exits) */
+    struct LoggerState{
+        std::mutex queues_lock;                         // the mutex lock of the queue list
+        std::vector<std::shared_ptr<LogQueue>> queues;  // the queues of all the threads
+        std::mutex write_lock;                          // the mutex lock to drain the queues and write the records
+        std::map<std::string, RateLimit> rate_limits;   // the repeated warnings keyed by the message
+        std::ofstream file;                             // the output file (the console is used if not open)
+        bool json = false;                              // the flag to write a JSON object per line
+    };
+    
+    static LoggerState *state = new LoggerState();              // the state of the logger
+    static std::once_flag writer_flag;                          // the flag to launch the writer once
+    static thread_local std::shared_ptr<LogQueue> local_queue;  // the queue of the calling thread
+    
+    static const int64_t now();                                      // get the current time [ns since the epoch]
+    static void launchWriter();                                      // launch the background writer
+    static void runWriter();                                         // write the queued records periodically
+    static LogQueue& getQueue();                                     // get the queue of the calling thread
+    static void push(const int level, const std::string& msg,        // queue a record
+                     const std::string& suppl);
+    static const bool compareTime(const LogRecord& record1,          // compare the time of the records
+                                  const LogRecord& record2);
+    static const bool limitRate(const LogRecord& record,             // check if a repeated warning is written
+                                std::ostream& out);
+    static void expireRateLimits(const int64_t time,                 // write the warnings suppressed in the past windows
+                                 std::ostream& out);
+    static void format(const LogRecord& record, std::ostream& out);  // format a record
+    static const std::string escape(const std::string& str);         // escape a string in JSON
+}
+
+/* get the current time */
+const int64_t async_logger::now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+/* launch the background writer (the queued records are also written at exit) */
+void async_logger::launchWriter(){
+    std::atexit(_ml::flush);
+    std::thread(_ml::runWriter).detach();
+}
+
+/* write the queued records periodically (in the background thread) */
+void async_logger::runWriter(){
+    while(true){
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOG_FLUSH_INTERVAL));
+        _ml::flush();
+    }
+}
+
+/* get the queue of the calling thread (registered on the first record) */
+LogQueue& async_logger::getQueue(){
+    if(!_ml::local_queue){
+        std::call_once(_ml::writer_flag, _ml::launchWriter);
+        std::lock_guard<std::mutex> queues_lock(_ml::state->queues_lock);
+        _ml::local_queue = std::make_shared<LogQueue>(LOG_QUEUE_SIZE, _ml::state->queues.size());
+        _ml::state->queues.push_back(_ml::local_queue);
+    }
+    return *_ml::local_queue;
+}
+
+/* queue a record (without blocking on the output) */
+void async_logger::push(const int level, const std::string& msg, const std::string& suppl){
+    LogQueue& queue = _ml::getQueue();
+    LogRecord record = {_ml::now(), level, queue.getTid(), msg, suppl};
+    queue.push(record);
+}
+
+/* compare the time of the records */
+const bool async_logger::compareTime(const LogRecord& record1, const LogRecord& record2){
+    return record1.time < record2.time;
+}
+
+/* check if a repeated warning is written (LOG_RATE_BURST warnings of the same message in a window) */
+const bool async_logger::limitRate(const LogRecord& record, std::ostream& out){
+    _ml::expireRateLimits(record.time, out);
+    RateLimit& limit = _ml::state->rate_limits[record.msg];
+    if(limit.count < LOG_RATE_BURST){
+        if(limit.count == 0){
+            limit.window_t = record.time;
+        }
+        ++limit.count;
+        return true;
+    }
+    ++limit.suppressed;
+    return false;
+}
+
+/* write the warnings suppressed in the windows which have passed */
+void async_logger::expireRateLimits(const int64_t time, std::ostream& out){
+    auto limit = _ml::state->rate_limits.begin();
+    while(limit != _ml::state->rate_limits.end()){
+        if(time-limit->second.window_t <= LOG_RATE_WINDOW){
+            ++limit;
+            continue;
+        }
+        if(limit->second.suppressed > 0){
+            const LogRecord summary = {time, LOG_LEVEL_WARN, 0, limit->first,
+                                       std::to_string(limit->second.suppressed) + " similar warnings suppressed"};
+            _ml::format(summary, out);
+        }
+        limit = _ml::state->rate_limits.erase(limit);
+    }
+}
+
+/* escape a string in JSON */
+const std::string async_logger::escape(const std::string& str){
+    std::ostringstream escaped;
+    for(const char c : str){
+        switch(c){
+        case '"':
+            escaped << "\\\"";
+            break;
+        case '\\':
+            escaped << "\\\\";
+            break;
+        case '\n':
+            escaped << "\\n";
+            break;
+        default:
+            if((unsigned char)c < 0x20){
+                escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+            }else{
+                escaped << c;
+            }
+        }
+    }
+    return escaped.str();
+}
+
+/* format a record (in the same text as the console or in a JSON object) */
+void async_logger::format(const LogRecord& record, std::ostream& out){
+    if(_ml::state->json){
+        const std::string level_names[] = {"debug", "info", "warning", "error"};
+        out << "{\"time_ns\":" << record.time
+            << ",\"level\":\"" << level_names[record.level]
+            << "\",\"thread\":" << record.tid
+            << ",\"msg\":\"" << _ml::escape(record.msg)
+            << "\",\"suppl\":\"" << _ml::escape(record.suppl) << "\"}\n";
+        return;
+    }
+    switch(record.level){
+    case LOG_LEVEL_NOTICE:
+        out << GREEN << "[Info] " << RESET << record.msg << ".\n";
+        break;
+    case LOG_LEVEL_WARN:
+        out << YELLOW << "[Warning] " << RESET << record.msg << ". (" << record.suppl << ")\n";
+        break;
+    case LOG_LEVEL_CAUTION:
+        out << RED << "[Error] " << RESET << record.msg << ". (" << record.suppl << ")\n";
+        break;
+    default:
+        out << CYAN << "[Debug] " << RESET << record.msg << "\n";
+    }
+}
+
+/* set the output file and format (call after parsing the config file) */
+void async_logger::init(const log_params_t& params){
+    std::string log_file, log_format;
+    std::tie(log_file, log_format) = params;
+    _ml::flush();
+    std::lock_guard<std::mutex> write_lock(_ml::state->write_lock);
+    if(log_format != LOG_FORMAT_TEXT && log_format != LOG_FORMAT_JSON){
+        std::cerr << RED << "[Error] " << RESET << "Log format is invalid. (" << log_format << ")" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    _ml::state->json = log_format == LOG_FORMAT_JSON;
+    if(!log_file.empty()){
+        _ml::state->file.open(log_file, std::ios::out|std::ios::app);
+        if(!_ml::state->file){
+            std::cerr << RED << "[Error] " << RESET << "Failed to open log file. (" << log_file << ")" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/* write all the queued records (in order of the time across the threads) */
+void async_logger::flush(){
+    std::lock_guard<std::mutex> write_lock(_ml::state->write_lock);
+    std::vector<std::shared_ptr<LogQueue>> queues;
+    {
+        std::lock_guard<std::mutex> queues_lock(_ml::state->queues_lock);
+        queues = _ml::state->queues;
+    }
+    
+    // drain the queues
+    std::vector<LogRecord> records;
+    LogRecord record;
+    for(const std::shared_ptr<LogQueue>& queue : queues){
+        while(queue->pop(record)){
+            records.push_back(std::move(record));
+        }
+        const uint64_t dropped = queue->takeDropped();
+        if(dropped > 0){
+            records.push_back({_ml::now(), LOG_LEVEL_WARN, queue->getTid(),
+                               "Log records were dropped", std::to_string(dropped) + " records in a full queue"});
+        }
+    }
+    std::stable_sort(records.begin(), records.end(), _ml::compareTime);
+    
+    // write the records (the cautions are written to stderr on the console)
+    std::ostringstream out, err;
+    for(const LogRecord& record : records){
+        if(record.level == LOG_LEVEL_WARN && !_ml::limitRate(record, out)){
+            continue;
+        }
+        _ml::format(record, record.level==LOG_LEVEL_CAUTION && !_ml::state->file.is_open() ? err : out);
+    }
+    _ml::expireRateLimits(_ml::now(), out);
+    if(_ml::state->file.is_open()){
+        _ml::state->file << out.str() << std::flush;
+    }else{
+        std::cout << out.str() << std::flush;
+        std::cerr << err.str() << std::flush;
+    }
+}
+
+/* print a notice */
+void async_logger::notice(const std::string& msg){
+#if LOG_MIN_LEVEL <= LOG_LEVEL_NOTICE
+    _ml::push(LOG_LEVEL_NOTICE, msg, "");
+#endif
+}
+
+/* print a warning (LOG_RATE_BURST warnings of the same message are written in LOG_RATE_WINDOW) */
+void async_logger::warn(const std::string& msg, const std::string& suppl){
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+    _ml::push(LOG_LEVEL_WARN, msg, suppl);
+#endif
+}
+
+/* print a caution */
+void async_logger::caution(const std::string& msg, const std::string& suppl){
+    _ml::push(LOG_LEVEL_CAUTION, msg, suppl);
+}
+
+/* print a string variable for debug */
+void async_logger::debug(const std::string& var){
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+    _ml::push(LOG_LEVEL_DEBUG, var, "");
+#endif
+}
+
+/* print a int variable for debug */
+void async_logger::debug(const int var){
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+    _ml::push(LOG_LEVEL_DEBUG, std::to_string(var), "");
+#endif
+}
+
+/* print a double variable for debug */
+void async_logger::debug(const double var){
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+    _ml::push(LOG_LEVEL_DEBUG, std::to_string(var), "");
+#endif
+}
@@ -6,13 +6,25 @@
 #include "base_config_parser.hpp"
 
 /* constructor (parse a json file) */
-BaseConfigParser::BaseConfigParser(const std::string& conf_file){
+BaseConfigParser::BaseConfigParser(const std::string& conf_file):
+    conf_file(conf_file)
+{
+    if(!this->readFile()){
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+/* read the json file (the parsed json is kept if the file is invalid) */
+const bool BaseConfigParser::readFile(){
+    _pt::ptree conf;
     try{
-        _pt::read_json(conf_file, this->conf);
+        _pt::read_json(this->conf_file, conf);
     }catch(...){
-        _ml::caution("Failed to read config file", conf_file);
-        std::exit(EXIT_FAILURE);
+        _ml::caution("Failed to read config file", this->conf_file);
+        return false;
     }
+    this->conf = conf;
+    return true;
 }
 
 /* read the parameters in the config file */
@@ -38,3 +50,73 @@ const std::string BaseConfigParser::getStrParam(const std::string& key){
     return param;
 }
 
+
+/* get an optional int parameter */
+const int BaseConfigParser::getIntParam(const std::string& key, const int default_param){
+    return this->conf.get<int>(key, default_param);
+}
+
+/* get an optional string parameter */
+const std::string BaseConfigParser::getStrParam(const std::string& key, const std::string& default_param){
+    return this->conf.get<std::string>(key, default_param);
+}
+
+/* get an optional bool parameter */
+const bool BaseConfigParser::getBoolParam(const std::string& key, const bool default_param){
+    return this->conf.get<bool>(key, default_param);
+}
+
+/* get the options of TCP sockets */
+const sockopt_params_t BaseConfigParser::getSocketParams(){
+    const bool tcp_nodelay = this->getBoolParam("socket.tcp_nodelay", true);
+    const bool tcp_cork = this->getBoolParam("socket.tcp_cork", false);
+    const int sndbuf_size = this->getIntParam("socket.send_buffer_size", SOCKBUF_SIZE_DEFAULT);
+    const int rcvbuf_size = this->getIntParam("socket.recv_buffer_size", SOCKBUF_SIZE_DEFAULT);
+    return std::forward_as_tuple(tcp_nodelay, tcp_cork, sndbuf_size, rcvbuf_size);
+}
+
+/* get the parameters of the frame tracer (tracing is disabled without the trace file) */
+const trace_params_t BaseConfigParser::getTraceParams(){
+    const std::string trace_file = this->getStrParam("trace.file", "");
+    const int event_num = this->getIntParam("trace.events_per_thread", TRACE_EVENTS_DEFAULT);
+    return std::forward_as_tuple(trace_file, event_num);
+}
+
+/* get the parameters of the metrics endpoint (the endpoint is disabled with port 0) */
+const metrics_params_t BaseConfigParser::getMetricsParams(){
+    const std::string ip_addr = this->getStrParam("metrics.address", "127.0.0.1");
+    const int port = this->getIntParam("metrics.port", METRICS_PORT_DISABLED);
+    return std::forward_as_tuple(ip_addr, port);
+}
+
+/* get the parameters of the logger (the console is used without a log file) */
+const log_params_t BaseConfigParser::getLogParams(){
+    const std::string log_file = this->getStrParam("log.file", "");
+    const std::string log_format = this->getStrParam("log.format", LOG_FORMAT_TEXT);
+    return std::forward_as_tuple(log_file, log_format);
+}
+
+/* get the placement of the threads (the roles which are not given are neither pinned nor prioritized) */
+const thread_params_t BaseConfigParser::getThreadParams(){
+    thread_params_t params;
+    const auto threads = this->conf.get_child_optional("threads");
+    if(!threads){
+        return params;
+    }
+    for(const auto& role : *threads){
+        if(std::find(THREAD_ROLES.begin(), THREAD_ROLES.end(), role.first) == THREAD_ROLES.end()){
+            _ml::warn("Unknown thread role is ignored", role.first);
+            continue;
+        }
+        ThreadPlacement& placement = params[role.first];
+        const auto cores = role.second.get_child_optional("cores");
+        if(cores){
+            for(const auto& core : *cores){
+                placement.cores.push_back(core.second.get_value<int>());
+            }
+        }
+        placement.rt_priority = role.second.get<int>("realtime_priority", 0);
+        placement.nice = role.second.get<int>("nice", 0);
+    }
+    return params;
+}
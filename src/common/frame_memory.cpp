@@ -0,0 +1,63 @@
+/*******************************************
+*            frame_memory.cpp             *
+*  (memory blocks to put the raw frames)  *
+*******************************************/
+
+#include "frame_memory.hpp"
+
+/* constructor (allocate huge pages, and fall back to the normal pages) */
+FrameMemory::FrameMemory(const size_t size):
+    size((size+HUGE_PAGE_SIZE-1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE)
+{
+    // try the huge page pool first, and then transparent huge pages
+    if(this->map(MAP_HUGETLB)){
+        this->pages = PAGES_HUGETLB;
+    }else if(this->map(0)){
+        this->pages = madvise(this->ptr, this->size, MADV_HUGEPAGE)==0 ? PAGES_THP : PAGES_NORMAL;
+    }else{
+        _ml::caution("Failed to allocate frame memory", std::strerror(errno));
+        std::exit(EXIT_FAILURE);
+    }
+    
+    // fault in all the pages now instead of in the first frames, and keep them in the memory
+    std::memset(this->ptr, 0, this->size);
+    this->locked = mlock(this->ptr, this->size) == 0;
+    if(!this->locked){
+        _ml::warn("Could not lock frame memory", std::string(std::strerror(errno)) + " (raise RLIMIT_MEMLOCK)");
+    }
+    _ml::notice("Allocated " + std::to_string(this->size>>20) + " MiB of frame memory on " + this->pages + " pages"
+                + (this->locked ? " (locked)" : ""));
+}
+
+/* destructor (release the block) */
+FrameMemory::~FrameMemory(){
+    if(this->locked){
+        munlock(this->ptr, this->size);
+    }
+    munmap(this->ptr, this->size);
+}
+
+/* map anonymous memory (the mapping is page aligned, so the rows are aligned as well) */
+const bool FrameMemory::map(const int flags){
+    void *addr = mmap(NULL, this->size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|flags, -1, 0);
+    if(addr == MAP_FAILED){
+        return false;
+    }
+    this->ptr = (unsigned char*)addr;
+    return true;
+}
+
+/* get the address of the block */
+unsigned char *FrameMemory::getData(){
+    return this->ptr;
+}
+
+/* get the size of the block */
+const size_t FrameMemory::getSize(){
+    return this->size;
+}
+
+/* pad a row to the alignment (so that each row starts at a cache line) */
+const size_t alignRow(const size_t row_size){
+    return (row_size+FRAME_ROW_ALIGN-1) / FRAME_ROW_ALIGN * FRAME_ROW_ALIGN;
+}
@@ -0,0 +1,207 @@
+/********************************************
+*             frame_tracer.cpp              *
+*  (tracer of the lifecycle of the frames)  *
+********************************************/
+
+#include "frame_tracer.hpp"
+
+/* round up the number of the events to a power of 2 (to index the ring with a mask) */
+static const uint64_t roundUpEventNum(const int event_num){
+    uint64_t ring_size = 1;
+    while(ring_size < (uint64_t)event_num){
+        ring_size <<= 1;
+    }
+    return ring_size;
+}
+
+/* constructor (allocate the ring) */
+TraceRing::TraceRing(const int event_num, const int tid):
+    events(roundUpEventNum(event_num)),
+    mask(roundUpEventNum(event_num)-1),
+    head(0),
+    tid(tid)
+{}
+
+/* write an event (only the owner thread writes, so no lock is needed) */
+void TraceRing::push(const TraceEvent& event){
+    const uint64_t index = this->head.load(std::memory_order_relaxed);
+    this->events[index & this->mask] = event;
+    this->head.store(index+1, std::memory_order_release);
+}
+
+/* copy the events not overwritten (the events overwritten while copying are dropped) */
+const std::vector<TraceEvent> TraceRing::snapshot(){
+    const uint64_t ring_size = this->mask + 1;
+    const uint64_t pre_head = this->head.load(std::memory_order_acquire);
+    const uint64_t first = pre_head>ring_size ? pre_head-ring_size : 0;
+    std::vector<TraceEvent> copied;
+    for(uint64_t i=first; i<pre_head; ++i){
+        copied.push_back(this->events[i & this->mask]);
+    }
+    const uint64_t post_head = this->head.load(std::memory_order_acquire);
+    const uint64_t valid_first = post_head>ring_size ? post_head-ring_size : 0;
+    if(valid_first > first){
+        copied.erase(copied.begin(), copied.begin()+std::min(valid_first-first, (uint64_t)copied.size()));
+    }
+    return copied;
+}
+
+/* get the ID of the thread */
+const int TraceRing::getTid(){
+    return this->tid;
+}
+
+/* set the name of the thread */
+void TraceRing::setName(const std::string& name){
+    std::lock_guard<std::mutex> name_guard(this->name_lock);
+    this->name = name;
+}
+
+/* get the name of the thread */
+const std::string TraceRing::getName(){
+    std::lock_guard<std::mutex> name_guard(this->name_lock);
+    return this->name;
+}
+
+namespace frame_tracer{
+    static std::atomic_bool enabled(false);                // the flag to record the events
+    static std::string trace_file;                         // the file to write the events
+    static std::string process;                            // the name of this process in the trace
+    static int event_num = TRACE_EVENTS_DEFAULT;           // the number of the events kept in each thread
+    static std::mutex rings_lock;                          // the mutex lock of the rings
+    static std::vector<std::unique_ptr<TraceRing>> rings;  // the rings of all the threads
+    static thread_local TraceRing *local_ring = NULL;      // the ring of the calling thread
+    
+    static TraceRing *getRing();                                 // get the ring of the calling thread
+    static void waitSignal();                                    // dump the events when interrupted
+    static const std::string formatTime(const int64_t time_ns);  // format a time in microseconds
+}
+
+/* get the ring of the calling thread (registered on the first event) */
+TraceRing *frame_tracer::getRing(){
+    if(_ft::local_ring == NULL){
+        std::lock_guard<std::mutex> rings_guard(_ft::rings_lock);
+        _ft::rings.emplace_back(new TraceRing(_ft::event_num, _ft::rings.size()+1));
+        _ft::local_ring = _ft::rings.back().get();
+    }
+    return _ft::local_ring;
+}
+
+/* dump the events when interrupted (the other threads are left running, so the process exits without cleanup) */
+void frame_tracer::waitSignal(){
+    sigset_t sig_set;
+    sigemptyset(&sig_set);
+    sigaddset(&sig_set, SIGINT);
+    sigaddset(&sig_set, SIGTERM);
+    int sig_num;
+    sigwait(&sig_set, &sig_num);
+    _ft::dump();
+    _ml::flush();
+    std::_Exit(EXIT_SUCCESS);
+}
+
+/* format a time in microseconds (without losing the nanoseconds in a double) */
+const std::string frame_tracer::formatTime(const int64_t time_ns){
+    std::ostringstream time_us;
+    time_us << time_ns/1000 << "." << std::setw(3) << std::setfill('0') << time_ns%1000;
+    return time_us.str();
+}
+
+/* enable the tracer (the tracer stays disabled if no trace file is given) */
+void frame_tracer::init(const trace_params_t& params, const std::string& process_name){
+    std::tie(_ft::trace_file, _ft::event_num) = params;
+    _ft::process = process_name;
+    if(_ft::trace_file.empty()){
+        return;
+    }
+    _ft::enabled.store(true, std::memory_order_release);
+    
+    // catch SIGINT and SIGTERM in a dedicated thread (the threads launched later inherit the mask)
+    sigset_t sig_set;
+    sigemptyset(&sig_set);
+    sigaddset(&sig_set, SIGINT);
+    sigaddset(&sig_set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sig_set, NULL);
+    std::thread(_ft::waitSignal).detach();
+    _ml::notice("Tracing frames into " + _ft::trace_file + " (written on SIGINT or SIGTERM)");
+}
+
+/* check if the tracer is enabled */
+const bool frame_tracer::isEnabled(){
+    return _ft::enabled.load(std::memory_order_relaxed);
+}
+
+/* get the current time (the wall clock is used to merge the traces of the nodes) */
+const int64_t frame_tracer::now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+/* name the calling thread in the trace */
+void frame_tracer::setThreadName(const std::string& name){
+    if(!_ft::isEnabled()){
+        return;
+    }
+    _ft::getRing()->setName(name);
+}
+
+/* record a stage which started at start_t */
+void frame_tracer::record(const int stage, const int seq, const int tile, const int64_t start_t){
+    if(!_ft::isEnabled()){
+        return;
+    }
+    const TraceEvent event = {start_t, _ft::now()-start_t, seq, (short)tile, (char)stage, TRACE_PHASE_COMPLETE};
+    _ft::getRing()->push(event);
+}
+
+/* record a point in the lifecycle */
+void frame_tracer::mark(const int stage, const int seq, const int tile){
+    if(!_ft::isEnabled()){
+        return;
+    }
+    const TraceEvent event = {_ft::now(), 0, seq, (short)tile, (char)stage, TRACE_PHASE_INSTANT};
+    _ft::getRing()->push(event);
+}
+
+/* write the events to the trace file (in Chrome trace format, readable with Perfetto) */
+void frame_tracer::dump(){
+    if(!_ft::isEnabled()){
+        return;
+    }
+    std::ofstream ofs(_ft::trace_file, std::ios::out|std::ios::trunc);
+    if(!ofs){
+        _ml::warn("Failed to write trace file", _ft::trace_file);
+        return;
+    }
+    
+    // name the process and the threads
+    const int pid = getpid();
+    ofs << "{\"traceEvents\": [" << std::endl;
+    ofs << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid
+        << ", \"tid\": 0, \"args\": {\"name\": \"" << _ft::process << "\"}}";
+    std::lock_guard<std::mutex> rings_guard(_ft::rings_lock);
+    int written_num = 0;
+    for(const std::unique_ptr<TraceRing>& ring : _ft::rings){
+        ofs << "," << std::endl
+            << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << ring->getTid()
+            << ", \"args\": {\"name\": \"" << ring->getName() << "\"}}";
+        
+        // write the events (the timestamps are in microseconds)
+        for(const TraceEvent& event : ring->snapshot()){
+            ofs << "," << std::endl
+                << "{\"name\": \"" << TRACE_STAGE_NAMES[(int)event.stage] << "\", \"cat\": \"frame\""
+                << ", \"ph\": \"" << event.phase << "\", \"pid\": " << pid << ", \"tid\": " << ring->getTid()
+                << ", \"ts\": " << _ft::formatTime(event.start_t);
+            if(event.phase == TRACE_PHASE_COMPLETE){
+                ofs << ", \"dur\": " << _ft::formatTime(event.dur_t);
+            }else{
+                ofs << ", \"s\": \"t\"";
+            }
+            ofs << ", \"args\": {\"seq\": " << event.seq << ", \"tile\": " << event.tile << "}}";
+            ++written_num;
+        }
+    }
+    ofs << std::endl << "], \"displayTimeUnit\": \"ms\"}" << std::endl;
+    _ml::notice("Wrote " + std::to_string(written_num) + " trace events into " + _ft::trace_file);
+}
@@ -0,0 +1,89 @@
+/*********************************************
+*              async_logger.hpp              *
+*  (logging tools with a background writer)  *
+*********************************************/
+
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+#define LOG_LEVEL_DEBUG 0    // the level of the debug messages
+#define LOG_LEVEL_NOTICE 1   // the level of the notices
+#define LOG_LEVEL_WARN 2     // the level of the warnings
+#define LOG_LEVEL_CAUTION 3  // the level of the cautions
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG  // the lowest level compiled in (set with -DLOG_MIN_LEVEL)
+#endif
+
+using log_params_t = std::tuple<std::string, std::string>;
+
+const std::string GREEN("\033[0;32m");       // the declaration to use green
+const std::string YELLOW("\033[0;33m");      // the declaration to use yellow
+const std::string RED("\033[0;31m");         // the declaration to use red
+const std::string CYAN("\033[0;36m");        // the declaration to use cyan
+const std::string RESET("\033[0m");          // the declaration to reset color
+const std::string LOG_FORMAT_TEXT = "text";  // the output format for the console
+const std::string LOG_FORMAT_JSON = "json";  // the output format of a JSON object per line
+const int LOG_QUEUE_SIZE = 1024;             // the number of the records queued in each thread (a power of 2)
+const int LOG_FLUSH_INTERVAL = 20;           // the interval to write the queued records [ms]
+const int LOG_RATE_BURST = 5;                // the number of the same warnings written in a window
+const int64_t LOG_RATE_WINDOW = 1000000000;  // the window to limit the repeated warnings [ns]
+
+/* record of a log message */
+struct LogRecord{
+    int64_t time;       // the time to log the message [ns since the epoch]
+    int level;          // the level
+    int tid;            // the ID of the logging thread
+    std::string msg;    // the message
+    std::string suppl;  // the supplement
+};
+
+/* lock-free queue of the records logged by a single thread (read by the writer) */
+class LogQueue{
+    private:
+        std::vector<LogRecord> records;  // the records
+        const uint64_t mask;             // the index mask of the queue
+        std::atomic<uint64_t> head;      // the number of the pushed records
+        std::atomic<uint64_t> tail;      // the number of the popped records
+        std::atomic<uint64_t> dropped;   // the number of the records dropped in a full queue
+        const int tid;                   // the ID of the thread
+    
+    public:
+        LogQueue(const int size, const int tid);  // constructor
+        const bool push(LogRecord& record);       // push a record (dropped without blocking if the queue is full)
+        const bool pop(LogRecord& record);        // pop a record
+        const uint64_t takeDropped();             // get and reset the number of the dropped records
+        const int getTid();                       // get the ID of the thread
+};
+
+/* logging tools (the records are queued in each thread and written by a background thread) */
+namespace async_logger{
+    void init(const log_params_t& params);                           // set the output file and format
+    void flush();                                                    // write all the queued records
+    void notice(const std::string& msg);                             // print a notice
+    void warn(const std::string& msg, const std::string& suppl);     // print a warning (rate limited)
+    void caution(const std::string& msg, const std::string& suppl);  // print a caution
+    void debug(const std::string& var);                              // print a string variable
+    void debug(const int var);                                       // print a int variable
+    void debug(const double var);                                    // print a double variable
+}
+
+namespace _ml = async_logger;
+
+#endif  /* ASYNC_LOGGER_HPP */
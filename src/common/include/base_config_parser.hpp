@@ -6,7 +6,11 @@
 #ifndef BASE_CONFIG_PARSER_HPP
 #define BASE_CONFIG_PARSER_HPP
 
-#include "mutex_logger.hpp"
+#include "async_logger.hpp"
+#include "socket_utils.hpp"
+#include "frame_tracer.hpp"
+#include "metrics.hpp"
+#include "thread_utils.hpp"
 #include <tuple>
 #include <cstdlib>
 #include <boost/property_tree/ptree.hpp>
@@ -21,14 +25,27 @@ class BaseConfigParser{
         virtual const bool readParams(const _pt::ptree& conf);  // read the parameters
     
     protected:
-        _pt::ptree conf;  // a parsed json
+        std::string conf_file;  // the path of the json file
+        _pt::ptree conf;        // a parsed json
         
+        const bool readFile();                                  // read the json file
         const int getIntParam(const std::string& key);          // get an int parameter
         const double getDoubleParam(const std::string& key);    // get a double parameter
         const std::string getStrParam(const std::string& key);  // get a string parameter
+        const int getIntParam(const std::string& key,           // get an optional int parameter
+                              const int default_param);
+        const std::string getStrParam(const std::string& key,   // get an optional string parameter
+                                      const std::string& default_param);
+        const bool getBoolParam(const std::string& key,         // get an optional bool parameter
+                                const bool default_param);
     
     public:
         BaseConfigParser(const std::string& filename);  // constructor
+        const sockopt_params_t getSocketParams();        // get the options of TCP sockets
+        const trace_params_t getTraceParams();           // get the parameters of the frame tracer
+        const metrics_params_t getMetricsParams();       // get the parameters of the metrics endpoint
+        const log_params_t getLogParams();               // get the parameters of the logger
+        const thread_params_t getThreadParams();         // get the placement of the threads
 };
 
 #endif  /* BASE_CONFIG_PARSER_HPP */
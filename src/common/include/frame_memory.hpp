@@ -0,0 +1,46 @@
+/*******************************************
+*            frame_memory.hpp             *
+*  (memory blocks to put the raw frames)  *
+*******************************************/
+
+#ifndef FRAME_MEMORY_HPP
+#define FRAME_MEMORY_HPP
+
+#include "async_logger.hpp"
+#include <string>
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+extern "C"{
+    #include <sys/mman.h>
+}
+
+const size_t FRAME_ROW_ALIGN = 64;              // the alignment of the rows of a frame (a cache line and the widest SIMD register)
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;  // the size of a huge page
+const std::string PAGES_HUGETLB = "hugetlb";    // the pages reserved in the huge page pool
+const std::string PAGES_THP = "thp";            // the pages promoted to transparent huge pages
+const std::string PAGES_NORMAL = "normal";      // the normal pages
+
+/* block of memory to put the raw frames (huge pages prefaulted and locked if the system allows) */
+class FrameMemory{
+    private:
+        unsigned char *ptr = nullptr;  // the address of the block
+        size_t size;                   // the size of the mapping (a multiple of the huge page size)
+        std::string pages;             // the kind of the pages backing the block
+        bool locked = false;           // the flag to have locked the block in the memory
+        
+        const bool map(const int flags);  // map anonymous memory
+    
+    public:
+        FrameMemory(const size_t size);  // constructor
+        ~FrameMemory();                  // destructor
+        unsigned char *getData();        // get the address of the block
+        const size_t getSize();          // get the size of the block
+};
+
+using framemem_ptr_t = std::shared_ptr<FrameMemory>;
+
+const size_t alignRow(const size_t row_size);  // pad a row to the alignment
+
+#endif  /* FRAME_MEMORY_HPP */
@@ -0,0 +1,93 @@
+/********************************************
+*             frame_tracer.hpp              *
+*  (tracer of the lifecycle of the frames)  *
+********************************************/
+
+#ifndef FRAME_TRACER_HPP
+#define FRAME_TRACER_HPP
+
+#include "async_logger.hpp"
+#include <string>
+#include <vector>
+#include <tuple>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <cstdlib>
+extern "C"{
+    #include <unistd.h>
+    #include <signal.h>
+    #include <pthread.h>
+}
+
+using trace_params_t = std::tuple<std::string, int>;
+
+const int TRACE_CAPTURE = 0;               // the stage to get a frame from the video source
+const int TRACE_RESIZE = 1;                // the stage to resize a frame onto the wall
+const int TRACE_ENCODE = 2;                // the stage to encode a tile
+const int TRACE_ENQUEUE = 3;               // the stage to push a tile into the send framebuffer
+const int TRACE_SEND = 4;                  // the stage to send a frame until the write is complete
+const int TRACE_RECEIVE = 5;               // the stage to take a received frame into the receive framebuffer
+const int TRACE_DECODE = 6;                // the stage to decode a frame
+const int TRACE_PAGE_READY = 7;            // the point when a decoded frame becomes displayable
+const int TRACE_PRESENT = 8;               // the stage to put a frame on the framebuffer
+const std::string TRACE_STAGE_NAMES[] = {  // the names of the stages in the trace
+    "capture", "resize", "encode", "enqueue", "send", "receive", "decode", "page_ready", "present"
+};
+const int TRACE_NO_TILE = -1;              // the tile index of the events not bound to a tile
+const int TRACE_EVENTS_DEFAULT = 65536;    // the default number of the events kept in each thread
+const char TRACE_PHASE_COMPLETE = 'X';     // the phase of a duration event in Chrome trace
+const char TRACE_PHASE_INSTANT = 'i';      // the phase of an instant event in Chrome trace
+
+/* event in the lifecycle of a frame */
+struct TraceEvent{
+    int64_t start_t;  // the start time [ns since the epoch]
+    int64_t dur_t;    // the duration [ns]
+    int seq;          // the sequence number of the frame
+    short tile;       // the index of the tile or the connection
+    char stage;       // the stage
+    char phase;       // the phase in Chrome trace
+};
+
+/* lock-free ring buffer of the events written by a single thread */
+class TraceRing{
+    private:
+        std::vector<TraceEvent> events;  // the events (the oldest one is overwritten)
+        const uint64_t mask;             // the index mask of the ring
+        std::atomic<uint64_t> head;      // the number of the written events
+        const int tid;                   // the ID of the thread in the trace
+        std::string name;                // the name of the thread
+        std::mutex name_lock;            // the mutex lock of the name
+    
+    public:
+        TraceRing(const int event_num, const int tid);  // constructor
+        void push(const TraceEvent& event);             // write an event
+        const std::vector<TraceEvent> snapshot();       // copy the events not overwritten
+        const int getTid();                             // get the ID of the thread
+        void setName(const std::string& name);          // set the name of the thread
+        const std::string getName();                    // get the name of the thread
+};
+
+/* tracer of the lifecycle of the frames (dumped in Chrome trace format) */
+namespace frame_tracer{
+    void init(const trace_params_t& params,                      // enable the tracer (call before launching threads)
+              const std::string& process_name);
+    const bool isEnabled();                                      // check if the tracer is enabled
+    const int64_t now();                                         // get the current time [ns since the epoch]
+    void setThreadName(const std::string& name);                 // name the calling thread in the trace
+    void record(const int stage, const int seq, const int tile,  // record a stage which started at start_t
+                const int64_t start_t);
+    void mark(const int stage, const int seq, const int tile);   // record a point in the lifecycle
+    void dump();                                                 // write the events to the trace file
+}
+
+namespace _ft = frame_tracer;
+
+#endif  /* FRAME_TRACER_HPP */
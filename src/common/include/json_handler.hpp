@@ -22,8 +22,9 @@ class JsonHandler{
         const std::string serialize();                             // serialize JSON
         void deserialize(const std::string& json_str);             // deserialize JSON
         const int getIntParam(const std::string& key);             // get an int parameter from JSON
-        const int getDoubleParam(const std::string& key);          // get a double parameter from JSON
+        const double getDoubleParam(const std::string& key);       // get a double parameter from JSON
         const std::string getStringParam(const std::string& key);  // get a string parameter from JSON
+        const bool hasParam(const std::string& key);               // check if JSON has a parameter
         void setIntParam(const std::string& key, const int param);              // set an int parameter in JSON
         void setDoubleParam(const std::string& key, const double param);        // set a double parameter in JSON
         void setStringParam(const std::string& key, const std::string& param);  // set a string parameter in JSON
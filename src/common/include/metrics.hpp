@@ -0,0 +1,80 @@
+/**********************************************
+*                 metrics.hpp                 *
+*  (counters, gauges and latency histograms)  *
+**********************************************/
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include "async_logger.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+
+using metrics_params_t = std::tuple<std::string, int>;
+using gauge_func_t = std::function<double()>;
+
+const int METRICS_PORT_DISABLED = 0;                                     // the port number to disable the metrics endpoint
+const int HIST_MIN_OCTAVE = 10;                                          // the power of 2 of the first bucket in a histogram (about 1us)
+const int HIST_OCTAVE_NUM = 26;                                          // the number of the powers of 2 in a histogram (about 1us to 68s)
+const int HIST_SUB_BITS = 2;                                             // the bits to divide each power of 2 linearly
+const int HIST_SUB_NUM = 1 << HIST_SUB_BITS;                             // the number of the linear buckets in each power of 2
+const int HIST_BUCKET_NUM = HIST_OCTAVE_NUM * HIST_SUB_NUM;              // the number of the buckets in a histogram
+const double NS_PER_SEC = 1e9;                                           // the nanoseconds in a second
+const std::string STAGE_METRIC_NAME = "tdw_stage_latency_seconds";       // the name of the latency histograms of the stages
+const std::string STAGE_METRIC_HELP = "Latency of each pipeline stage";  // the description of the latency histograms of the stages
+
+/* histogram of latencies with logarithmic-linear buckets (HDR-style, written without lock) */
+class LatencyHistogram{
+    private:
+        std::vector<std::atomic<uint64_t>> buckets;  // the counts of the values in each bucket
+        std::atomic<uint64_t> overflow;              // the count of the values over the last bucket
+        std::atomic<uint64_t> count;                 // the count of all the values
+        std::atomic<uint64_t> sum;                   // the sum of all the values [ns]
+    
+    public:
+        LatencyHistogram();                                             // constructor
+        void observe(const int64_t elapsed_ns);                         // add a value
+        void format(std::ostringstream& text, const std::string& name,  // format the histogram in Prometheus text
+                    const std::string& labels);
+};
+
+/* monotonic counter (written without lock) */
+class MetricCounter{
+    private:
+        std::atomic<uint64_t> value;  // the value
+    
+    public:
+        MetricCounter();                 // constructor
+        void add(const uint64_t delta);  // increase the value
+        const uint64_t get();            // get the value
+};
+
+using hist_ptr_t = std::shared_ptr<LatencyHistogram>;
+using counter_ptr_t = std::shared_ptr<MetricCounter>;
+
+/* registry of the metrics exported in Prometheus text format */
+namespace metrics{
+    const std::string labels(const std::vector<std::pair<std::string, std::string>>& pairs);  // format the labels
+    hist_ptr_t addHistogram(const std::string& name, const std::string& help,                // register a histogram
+                            const std::string& labels);
+    hist_ptr_t addStageHistogram(const std::string& stage,                                   // register a latency histogram of a stage
+                                 const std::vector<std::pair<std::string, std::string>>& pairs={});
+    counter_ptr_t addCounter(const std::string& name, const std::string& help,               // register a counter
+                             const std::string& labels);
+    void addGauge(const std::string& name, const std::string& help,                          // register a gauge
+                  const std::string& labels, const gauge_func_t& func);
+    const std::string format();                                                              // format all the metrics
+}
+
+namespace _mt = metrics;
+
+#endif  /* METRICS_HPP */
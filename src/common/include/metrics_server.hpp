@@ -0,0 +1,36 @@
+/**************************************************
+*               metrics_server.hpp                *
+*  (HTTP endpoint of the metrics for Prometheus)  *
+**************************************************/
+
+#ifndef METRICS_SERVER_HPP
+#define METRICS_SERVER_HPP
+
+#include "async_logger.hpp"
+#include "socket_utils.hpp"
+#include "metrics.hpp"
+#include <thread>
+
+const std::string HTTP_HEADER_END = "\r\n\r\n";  // the end of the header of an HTTP request
+
+/* HTTP endpoint of the metrics for Prometheus (served in its own thread) */
+class MetricsServer{
+    private:
+        _asio::io_service ios;   // the I/O event loop
+        _ip::tcp::acceptor acc;  // the TCP acceptor
+        std::thread serve_thre;  // the thread to serve the metrics
+        
+        void accept();                                                // start waiting for a scrape
+        void onAccept(const err_t& err, const sock_ptr_t sock);       // the callback when connected by a scraper
+        void onRecvRequest(const err_t& err, size_t t_bytes,          // the callback when receiving a request
+                           const sock_ptr_t sock, const streambuf_ptr_t stream_buf);
+        void onSendResponse(const err_t& err, size_t t_bytes,         // the callback when sending the metrics
+                            const sock_ptr_t sock, const std::shared_ptr<std::string> response);
+        void runService();                                            // run the event loop
+    
+    public:
+        MetricsServer(const metrics_params_t& params);  // constructor
+        ~MetricsServer();                               // destructor
+};
+
+#endif  /* METRICS_SERVER_HPP */
@@ -0,0 +1,34 @@
+/******************************************************
+*                 overlay_message.hpp                 *
+*  (overlay commands appended to the sync messages)   *
+******************************************************/
+
+#ifndef OVERLAY_MESSAGE_HPP
+#define OVERLAY_MESSAGE_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <boost/archive/iterators/base64_from_binary.hpp>
+#include <boost/archive/iterators/binary_from_base64.hpp>
+#include <boost/archive/iterators/transform_width.hpp>
+
+namespace _bai = boost::archive::iterators;
+
+const char OVERLAY_DELIMITER = '\n';          // the delimiter of the overlay commands following the sync message
+const std::string OVERLAY_RESET = "reset";    // the command to remove all the overlays and their resources
+const std::string OVERLAY_ATLAS = "atlas";    // the command to store a glyph atlas
+const std::string OVERLAY_SPRITE = "sprite";  // the command to store an RGBA sprite
+const std::string OVERLAY_TEXT = "text";      // the command to place a text drawn with a glyph atlas
+const std::string OVERLAY_IMAGE = "image";    // the command to place a sprite
+const std::string OVERLAY_CLEAR = "clear";    // the command to remove an overlay
+const std::string OVERLAY_BLEND = "blend";    // the command to set the edges overlapping the neighboring projectors
+const int OVERLAY_GLYPH_FIRST = 32;           // the first character in a glyph atlas (a space)
+const int OVERLAY_GLYPH_NUM = 95;             // the number of the characters in a glyph atlas (the printable ASCII)
+const int OVERLAY_SPRITE_CHANNEL_NUM = 4;     // the number of the channels of a sprite (BGRA)
+
+const std::string encodeBase64(const unsigned char *data, const size_t size);       // encode binary data in Base64
+const bool decodeBase64(const std::string& str, std::vector<unsigned char>& data);  // decode Base64 into binary data
+const std::vector<std::string> splitOverlayCmds(const std::string& sync_msg);       // split a sync message into the commands
+
+#endif  /* OVERLAY_MESSAGE_HPP */
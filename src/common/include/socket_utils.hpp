@@ -6,7 +6,10 @@
 #ifndef SOCKET_UTILS_HPP
 #define SOCKET_UTILS_HPP
 
+#include "async_logger.hpp"
 #include <memory>
+#include <tuple>
+#include <vector>
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
 
@@ -16,10 +19,32 @@ namespace _ph = boost::asio::placeholders;
 
 using sock_ptr_t = std::shared_ptr<_ip::tcp::socket>;
 using acc_ptr_t = std::shared_ptr<_ip::tcp::acceptor>;
+using streambuf_ptr_t = std::shared_ptr<_asio::streambuf>;
 using err_t = boost::system::error_code;
+using tcp_cork_t = _asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_CORK>;
+using sockopt_params_t = std::tuple<bool, bool, int, int>;
+using conn_params_t = std::tuple<std::string, std::vector<int>, bool>;
+using conn_list_t = std::vector<conn_params_t>;
 
-const std::string MSG_DELIMITER = "--EOM\r\n";         // the delimiter of TCP messages
-const int MSG_DELIMITER_LEN = MSG_DELIMITER.length();  // the length of the delimiter
+const std::string MSG_DELIMITER = "--EOM\r\n";           // the delimiter of TCP messages
+const int MSG_DELIMITER_LEN = MSG_DELIMITER.length();    // the length of the delimiter
+const std::string SYNC_HEAD = "sync";                    // the head of the sync message (followed by the overlay commands)
+const std::string HELLO_HEAD = "hello ";                 // the head of the hello message (followed by the node ID)
+const size_t HELLO_SIZE_MAX = 256;                       // the maximum size of a hello message
+const int SOCKBUF_SIZE_DEFAULT = 0;                      // the flag to keep the kernel default socket buffer size
+const int FRAME_ID_INDEX = 0;                            // the initial frame index
+const int FRAME_ID_LEN = 1;                              // the length of the frame index
+const int FRAME_ID_NUM = 10;                             // the number of the frame indices written in FRAME_ID_LEN digits
+const int TILE_SIZE_LEN = 10;                            // the length of the size field of each JPEG tile for a relay node
+const int CONN_NOT_FOUND = -1;                           // the return value when the connection is not registered
+
+void setSocketOptions(_ip::tcp::socket& sock, const sockopt_params_t& params);   // set the options of a TCP socket
+void setCork(_ip::tcp::socket& sock, const bool cork);                           // cork or uncork a TCP socket
+const int findConnection(const conn_list_t& conns, const std::string& ip_addr);  // find the connection of an IP address
+const std::string makeHelloMsg(const std::string& node_id);                      // make the hello message identifying a node
+const std::string parseHelloMsg(const std::string& msg,                          // get the key of a connection from its hello message
+                                const std::string& ip_addr);
+void bindSourceAddress(_ip::tcp::socket& sock, const std::string& ip_addr);      // bind the source address of a TCP socket
 
 #endif  /* SOCKET_UTILS_HPP */
 
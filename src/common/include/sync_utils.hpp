@@ -6,6 +6,7 @@
 #ifndef SYNC_UTILS_HPP
 #define SYNC_UTILS_HPP
 
+#include <string>
 #include <vector>
 #include <atomic>
 #include <chrono>
@@ -24,6 +25,9 @@ const int JPEG_PARAM_UP = 1;        // the flag to increase the JPEG parameter
 const int JPEG_PARAM_DOWN = 2;      // the flag to decrease the JPEG parameter
 const int JPEG_QUALITY_MIN = 1;     // the minimum value of the quality factor
 const int JPEG_QUALITY_MAX = 100;   // the maximum value of the quality factor
+const std::vector<std::string> NODE_PARAM_KEYS = {  // the parameters of each display node in the initial message
+    "width", "height", "recvbuf_num", "dec_thre_num", "ycbcr_format", "quality"
+};
 
 #endif  /* SYNC_UTILS_HPP */
 
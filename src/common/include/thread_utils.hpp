@@ -0,0 +1,57 @@
+/*************************************
+*          thread_utils.hpp          *
+*  (utilities to place the threads)  *
+*************************************/
+
+#ifndef THREAD_UTILS_HPP
+#define THREAD_UTILS_HPP
+
+#include "async_logger.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+extern "C"{
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+}
+
+/* placement of the threads of a role */
+struct ThreadPlacement{
+    std::vector<int> cores;  // the cores the threads are pinned to in turn (not pinned if empty)
+    int rt_priority = 0;     // the priority under SCHED_FIFO (SCHED_OTHER if 0)
+    int nice = 0;            // the nice value under SCHED_OTHER
+};
+
+using thread_params_t = std::map<std::string, ThreadPlacement>;
+
+const int CORE_NOT_PINNED = -1;                       // the flag not to pin a thread to a core
+const int RT_PRIORITY_MAX = 99;                       // the highest priority under SCHED_FIFO
+const int NICE_MIN = -20;                             // the lowest nice value
+const int NICE_MAX = 19;                              // the highest nice value
+const std::string THREAD_ROLE_ENCODER = "encoder";    // the role of the encoder thread of the head node
+const std::string THREAD_ROLE_SENDER = "sender";      // the role of the sender threads of the head node
+const std::string THREAD_ROLE_SYNC = "sync";          // the role of the I/O threads of the sync messages in the head node
+const std::string THREAD_ROLE_RECEIVER = "receiver";  // the role of the receiver thread of a display node
+const std::string THREAD_ROLE_DECODER = "decoder";    // the role of the decoder threads of a display node
+const std::string THREAD_ROLE_VIEWER = "viewer";      // the role of the viewer thread of a display node (it sends the sync messages)
+const std::vector<std::string> THREAD_ROLES = {       // the roles which can be placed
+    THREAD_ROLE_ENCODER, THREAD_ROLE_SENDER, THREAD_ROLE_SYNC, THREAD_ROLE_RECEIVER, THREAD_ROLE_DECODER, THREAD_ROLE_VIEWER
+};
+
+const int getCoreNum();                                          // get the number of the online cores
+void initThreadPlacement(const thread_params_t& params,          // set the placement of the roles
+                         const std::vector<std::string>& io_roles,
+                         const std::string& compute_role);
+const bool placeThread(const std::string& role, const int index,  // place the calling thread
+                       const int default_core);
+
+#endif  /* THREAD_UTILS_HPP */
@@ -0,0 +1,37 @@
+/*****************************************************
+*                  tile_codec.hpp                    *
+*  (lossless codec for the tiles of screen content)  *
+*****************************************************/
+
+#ifndef TILE_CODEC_HPP
+#define TILE_CODEC_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+const std::string TILE_CODEC_JPEG = "jpeg";    // the codec setting to encode all the tiles in JPEG
+const std::string TILE_CODEC_AUTO = "auto";    // the codec setting to choose the codec of each tile
+const std::string LOSSLESS_MAGIC = "TDWL";     // the magic number of a lossless tile (a JPEG tile starts with 0xFFD8)
+const int LOSSLESS_HEADER_SIZE = 12;           // the size of the header (the magic number, the width and the height)
+const int LOSSLESS_INDEX_NUM = 64;             // the number of the recently seen colors indexed by their hash
+const int LOSSLESS_RUN_MAX = 62;               // the longest run in an op
+const unsigned char LOSSLESS_OP_INDEX = 0x00;  // the op of an indexed color (00xxxxxx)
+const unsigned char LOSSLESS_OP_DIFF = 0x40;   // the op of a small difference from the previous pixel (01rrggbb)
+const unsigned char LOSSLESS_OP_LUMA = 0x80;   // the op of a difference led by green (10gggggg rrrrbbbb)
+const unsigned char LOSSLESS_OP_RUN = 0xc0;    // the op of the previous pixel repeated (11xxxxxx)
+const unsigned char LOSSLESS_OP_RGB = 0xfe;    // the op of a literal color
+const unsigned char LOSSLESS_OP_MASK = 0xc0;   // the mask of the 2-bit ops
+const int FLAT_SAMPLE_STEP = 8;                // the interval of the rows sampled to classify a tile
+constexpr double FLAT_RATIO_MIN = 0.75;        // the ratio of the pixels equal to the left one in screen content
+constexpr double LOSSLESS_RATIO_MAX = 0.25;    // the largest lossless tile to the raw tile (JPEG is used if larger)
+
+const bool isFlatTile(const unsigned char *pixels, const int width,       // check if a tile looks like screen content
+                      const int height, const int pitch);
+const bool encodeLosslessTile(const unsigned char *pixels,                // encode an RGB tile without loss
+                              const int width, const int height, const int pitch, std::string& tile);
+const bool isLosslessTile(const unsigned char *tile, const size_t size);  // check if a tile is lossless
+const bool decodeLosslessTile(const unsigned char *tile,                  // decode a lossless tile into RGB pixels
+                              const size_t size, unsigned char *pixels, const int pitch, const int page_height);
+
+#endif  /* TILE_CODEC_HPP */
@@ -7,6 +7,7 @@
 #define TRANSCEIVE_FRAMEBUFFER_HPP
 
 #include <mutex>
+#include <atomic>
 #include <thread>
 #include <chrono>
 #include <boost/circular_buffer.hpp>
@@ -18,13 +19,18 @@ const int TRANBUF_SPINLOCK_INTERVAL = 1;  // the interval time in the spinlock
 class TransceiveFramebuffer{
     private:
         boost::circular_buffer<std::string> jpeg_buf;  // the buffer
+        std::atomic_int capacity;                      // the number of the JPEG frames stored at most
         std::mutex lock;                               // the mutex lock
+        int pop_num = 0;                               // the number of the popped JPEG frames
     
     public:
-        TransceiveFramebuffer(const int jpegbuf_num);  // consructor
-        void push(const std::string& jpeg_frame);      // push a JPEG frame
-        const std::string pop();                       // pop a JPEG frame
-        const int getStoredNum();                      // get the number of stored JPEG frames
+        TransceiveFramebuffer(const int jpegbuf_num);                     // consructor
+        TransceiveFramebuffer(const int jpegbuf_num, const int max_num);  // consructor (resizable up to max_num)
+        void push(const std::string& jpeg_frame);                         // push a JPEG frame
+        std::string pop();                                                // pop a JPEG frame
+        std::string pop(int& seq);                                        // pop a JPEG frame with its sequence number
+        const int getStoredNum();                                         // get the number of stored JPEG frames
+        const bool setCapacity(const int jpegbuf_num);                    // change the number of the JPEG frames stored
 };
 
 using tranbuf_ptr_t = std::shared_ptr<TransceiveFramebuffer>;
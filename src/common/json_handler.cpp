@@ -25,7 +25,7 @@ const int JsonHandler::getIntParam(const std::string& key){
 }
 
 /* get a double parameter from JSON */
-const int JsonHandler::getDoubleParam(const std::string& key){
+const double JsonHandler::getDoubleParam(const std::string& key){
     return std::stod(this->json.get_optional<std::string>(key).get());
 }
 
@@ -34,6 +34,11 @@ const std::string JsonHandler::getStringParam(const std::string& key){
     return this->json.get_optional<std::string>(key).get();
 }
 
+/* check if JSON has a parameter */
+const bool JsonHandler::hasParam(const std::string& key){
+    return (bool)this->json.get_optional<std::string>(key);
+}
+
 /* set an int parameter in JSON */
 void JsonHandler::setIntParam(const std::string& key, const int param){
     this->json.put(key, param);
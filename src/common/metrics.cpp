@@ -0,0 +1,163 @@
+/**********************************************
+*                 metrics.cpp                 *
+*  (counters, gauges and latency histograms)  *
+**********************************************/
+
+#include "metrics.hpp"
+
+/* constructor */
+LatencyHistogram::LatencyHistogram():
+    buckets(HIST_BUCKET_NUM),
+    overflow(0),
+    count(0),
+    sum(0)
+{
+    for(std::atomic<uint64_t>& bucket : this->buckets){
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+/* add a value (the bucket is the power of 2 of the value and the next bits under it) */
+void LatencyHistogram::observe(const int64_t elapsed_ns){
+    const uint64_t value = elapsed_ns>0 ? elapsed_ns : 1;
+    const int octave = 63 - __builtin_clzll(value);
+    int index = 0;
+    if(octave >= HIST_MIN_OCTAVE){
+        const int sub_index = (value >> (octave-HIST_SUB_BITS)) & (HIST_SUB_NUM-1);
+        index = (octave-HIST_MIN_OCTAVE)*HIST_SUB_NUM + sub_index;
+    }
+    if(index < HIST_BUCKET_NUM){
+        this->buckets[index].fetch_add(1, std::memory_order_relaxed);
+    }else{
+        this->overflow.fetch_add(1, std::memory_order_relaxed);
+    }
+    this->count.fetch_add(1, std::memory_order_relaxed);
+    this->sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+/* format the histogram in Prometheus text (the buckets are cumulative and in seconds) */
+void LatencyHistogram::format(std::ostringstream& text, const std::string& name, const std::string& labels){
+    const std::string label_head = labels.empty() ? "{" : "{" + labels + ",";
+    uint64_t cumulative = 0;
+    for(int i=0; i<HIST_BUCKET_NUM; ++i){
+        cumulative += this->buckets[i].load(std::memory_order_relaxed);
+        const int octave = HIST_MIN_OCTAVE + i/HIST_SUB_NUM;
+        const uint64_t upper_ns = (1ULL << octave) + ((uint64_t)(i%HIST_SUB_NUM+1) << (octave-HIST_SUB_BITS));
+        text << name << "_bucket" << label_head << "le=\"" << (double)upper_ns/NS_PER_SEC << "\"} "
+             << cumulative << "\n";
+    }
+    const uint64_t total = cumulative + this->overflow.load(std::memory_order_relaxed);
+    text << name << "_bucket" << label_head << "le=\"+Inf\"} " << total << "\n";
+    const std::string label_set = labels.empty() ? "" : "{" + labels + "}";
+    text << name << "_sum" << label_set << " " << (double)this->sum.load(std::memory_order_relaxed)/NS_PER_SEC << "\n";
+    text << name << "_count" << label_set << " " << total << "\n";
+}
+
+/* constructor */
+MetricCounter::MetricCounter():
+    value(0)
+{}
+
+/* increase the value */
+void MetricCounter::add(const uint64_t delta){
+    this->value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+/* get the value */
+const uint64_t MetricCounter::get(){
+    return this->value.load(std::memory_order_relaxed);
+}
+
+namespace metrics{
+    /* metrics sharing a name (formatted under one HELP and TYPE line) */
+    struct MetricFamily{
+        std::string help;                               // the description
+        std::string type;                               // the type in Prometheus
+        std::map<std::string, hist_ptr_t> hists;        // the histograms keyed by the labels
+        std::map<std::string, counter_ptr_t> counters;  // the counters keyed by the labels
+        std::map<std::string, gauge_func_t> gauges;     // the gauges keyed by the labels
+    };
+    
+    static std::mutex lock;                               // the mutex lock of the registry
+    static std::vector<std::string> names;                // the names of the metrics in order of registration
+    static std::map<std::string, MetricFamily> families;  // the metrics keyed by the name
+    
+    static MetricFamily& getFamily(const std::string& name,  // get or create the metrics of a name
+                                   const std::string& help, const std::string& type);
+}
+
+/* get or create the metrics of a name */
+metrics::MetricFamily& metrics::getFamily(const std::string& name, const std::string& help, const std::string& type){
+    if(_mt::families.find(name) == _mt::families.end()){
+        _mt::names.push_back(name);
+        _mt::families[name].help = help;
+        _mt::families[name].type = type;
+    }
+    return _mt::families[name];
+}
+
+/* format the labels (e.g. {{"display", "0"}} into display="0") */
+const std::string metrics::labels(const std::vector<std::pair<std::string, std::string>>& pairs){
+    std::string label_str;
+    for(const std::pair<std::string, std::string>& pair : pairs){
+        label_str += (label_str.empty() ? "" : ",") + pair.first + "=\"" + pair.second + "\"";
+    }
+    return label_str;
+}
+
+/* register a histogram (the registered one is returned for the same name and labels) */
+hist_ptr_t metrics::addHistogram(const std::string& name, const std::string& help, const std::string& labels){
+    std::lock_guard<std::mutex> registry_lock(_mt::lock);
+    hist_ptr_t& hist = _mt::getFamily(name, help, "histogram").hists[labels];
+    if(!hist){
+        hist = std::make_shared<LatencyHistogram>();
+    }
+    return hist;
+}
+
+/* register a latency histogram of a stage (the stage is put in the labels) */
+hist_ptr_t metrics::addStageHistogram(const std::string& stage,
+                                      const std::vector<std::pair<std::string, std::string>>& pairs){
+    std::vector<std::pair<std::string, std::string>> stage_pairs = {{"stage", stage}};
+    stage_pairs.insert(stage_pairs.end(), pairs.begin(), pairs.end());
+    return _mt::addHistogram(STAGE_METRIC_NAME, STAGE_METRIC_HELP, _mt::labels(stage_pairs));
+}
+
+/* register a counter (the registered one is returned for the same name and labels) */
+counter_ptr_t metrics::addCounter(const std::string& name, const std::string& help, const std::string& labels){
+    std::lock_guard<std::mutex> registry_lock(_mt::lock);
+    counter_ptr_t& counter = _mt::getFamily(name, help, "counter").counters[labels];
+    if(!counter){
+        counter = std::make_shared<MetricCounter>();
+    }
+    return counter;
+}
+
+/* register a gauge (the function is called on each scrape) */
+void metrics::addGauge(const std::string& name, const std::string& help, const std::string& labels,
+                       const gauge_func_t& func){
+    std::lock_guard<std::mutex> registry_lock(_mt::lock);
+    _mt::getFamily(name, help, "gauge").gauges[labels] = func;
+}
+
+/* format all the metrics in Prometheus text format */
+const std::string metrics::format(){
+    std::lock_guard<std::mutex> registry_lock(_mt::lock);
+    std::ostringstream text;
+    text << std::setprecision(9);
+    for(const std::string& name : _mt::names){
+        MetricFamily& family = _mt::families[name];
+        text << "# HELP " << name << " " << family.help << "\n"
+             << "# TYPE " << name << " " << family.type << "\n";
+        for(const std::pair<const std::string, hist_ptr_t>& hist : family.hists){
+            hist.second->format(text, name, hist.first);
+        }
+        for(const std::pair<const std::string, counter_ptr_t>& counter : family.counters){
+            text << name << (counter.first.empty() ? "" : "{"+counter.first+"}") << " " << counter.second->get() << "\n";
+        }
+        for(const std::pair<const std::string, gauge_func_t>& gauge : family.gauges){
+            text << name << (gauge.first.empty() ? "" : "{"+gauge.first+"}") << " " << gauge.second() << "\n";
+        }
+    }
+    return text.str();
+}
@@ -0,0 +1,93 @@
+/**************************************************
+*               metrics_server.cpp                *
+*  (HTTP endpoint of the metrics for Prometheus)  *
+**************************************************/
+
+#include "metrics_server.hpp"
+
+/* constructor (bind the endpoint and launch the thread) */
+MetricsServer::MetricsServer(const metrics_params_t& params):
+    acc(ios)
+{
+    std::string ip_addr;
+    int port;
+    std::tie(ip_addr, port) = params;
+    const _ip::tcp::endpoint endpoint(_ip::address::from_string(ip_addr), port);
+    err_t err;
+    this->acc.open(endpoint.protocol(), err);
+    this->acc.set_option(_ip::tcp::acceptor::reuse_address(true), err);
+    this->acc.bind(endpoint, err);
+    this->acc.listen(_asio::socket_base::max_connections, err);
+    if(err){
+        _ml::caution("Failed to open metrics endpoint at " + ip_addr + ":" + std::to_string(port), err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    this->accept();
+    this->serve_thre = std::thread(std::bind(&MetricsServer::runService, this));
+    _ml::notice("Serving metrics at http://" + ip_addr + ":" + std::to_string(port) + "/metrics");
+}
+
+/* destructor (stop the thread) */
+MetricsServer::~MetricsServer(){
+    this->ios.stop();
+    if(this->serve_thre.joinable()){
+        this->serve_thre.join();
+    }
+}
+
+/* run the event loop */
+void MetricsServer::runService(){
+    this->ios.run();
+}
+
+/* start waiting for a scrape */
+void MetricsServer::accept(){
+    const sock_ptr_t sock = std::make_shared<_ip::tcp::socket>(this->ios);
+    this->acc.async_accept(*sock,
+                           boost::bind(&MetricsServer::onAccept, this, _ph::error, sock)
+    );
+}
+
+/* the callback when connected by a scraper */
+void MetricsServer::onAccept(const err_t& err, const sock_ptr_t sock){
+    if(err){
+        _ml::warn("Failed to accept metrics scrape", err.message());
+    }else{
+        const streambuf_ptr_t stream_buf = std::make_shared<_asio::streambuf>();
+        _asio::async_read_until(*sock,
+                                *stream_buf,
+                                HTTP_HEADER_END,
+                                boost::bind(&MetricsServer::onRecvRequest, this, _ph::error, _ph::bytes_transferred,
+                                            sock, stream_buf)
+        );
+    }
+    this->accept();
+}
+
+/* the callback when receiving a request (any path is answered with the metrics) */
+void MetricsServer::onRecvRequest(const err_t& err, size_t t_bytes, const sock_ptr_t sock,
+                                  const streambuf_ptr_t stream_buf){
+    if(err){
+        return;
+    }
+    const std::string body = _mt::format();
+    const std::shared_ptr<std::string> response = std::make_shared<std::string>(
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " + std::to_string(body.length()) + "\r\n"
+        "Connection: close\r\n\r\n" + body
+    );
+    _asio::async_write(*sock,
+                       _asio::buffer(*response),
+                       boost::bind(&MetricsServer::onSendResponse, this, _ph::error, _ph::bytes_transferred,
+                                   sock, response)
+    );
+}
+
+/* the callback when sending the metrics (the connection is closed) */
+void MetricsServer::onSendResponse(const err_t& err, size_t t_bytes, const sock_ptr_t sock,
+                                   const std::shared_ptr<std::string> response){
+    err_t close_err;
+    sock->shutdown(_ip::tcp::socket::shutdown_both, close_err);
+    sock->close(close_err);
+}
@@ -0,0 +1,53 @@
+/******************************************************
+*                 overlay_message.cpp                 *
+*  (overlay commands appended to the sync messages)   *
+******************************************************/
+
+#include "overlay_message.hpp"
+
+using base64_enc_t = _bai::base64_from_binary<_bai::transform_width<const unsigned char*, 6, 8>>;
+using base64_dec_t = _bai::transform_width<_bai::binary_from_base64<std::string::const_iterator>, 8, 6>;
+
+/* encode binary data in Base64 (padded with '=') */
+const std::string encodeBase64(const unsigned char *data, const size_t size){
+    std::string str(base64_enc_t(data), base64_enc_t(data+size));
+    str.append((3-size%3)%3, '=');
+    return str;
+}
+
+/* decode Base64 into binary data (false if the string is not Base64) */
+const bool decodeBase64(const std::string& str, std::vector<unsigned char>& data){
+    if(str.length()%4 != 0){
+        return false;
+    }
+    
+    // the padding is decoded as zeros and removed
+    std::string body(str);
+    size_t pad_len = 0;
+    while(pad_len < 2 && !body.empty() && body[body.length()-1-pad_len] == '='){
+        body[body.length()-1-pad_len] = 'A';
+        ++pad_len;
+    }
+    try{
+        data.assign(base64_dec_t(body.cbegin()), base64_dec_t(body.cend()));
+    }catch(...){
+        return false;
+    }
+    data.resize(data.size()-pad_len);
+    return true;
+}
+
+/* split a sync message into the commands (the first one is the sync message itself) */
+const std::vector<std::string> splitOverlayCmds(const std::string& sync_msg){
+    std::vector<std::string> cmds;
+    size_t head = 0;
+    while(true){
+        const size_t tail = sync_msg.find(OVERLAY_DELIMITER, head);
+        if(tail == std::string::npos){
+            cmds.push_back(sync_msg.substr(head));
+            return cmds;
+        }
+        cmds.push_back(sync_msg.substr(head, tail-head));
+        head = tail + 1;
+    }
+}
@@ -0,0 +1,80 @@
+/************************************
+*         socket_utils.cpp          *
+*  (utilities to use a TCP socket)  *
+************************************/
+
+#include "socket_utils.hpp"
+
+/* set the options of a TCP socket (TCP_NODELAY, SO_SNDBUF, SO_RCVBUF) */
+void setSocketOptions(_ip::tcp::socket& sock, const sockopt_params_t& params){
+    bool tcp_nodelay, tcp_cork;
+    int sndbuf_size, rcvbuf_size;
+    std::tie(tcp_nodelay, tcp_cork, sndbuf_size, rcvbuf_size) = params;
+    
+    err_t err;
+    sock.set_option(_ip::tcp::no_delay(tcp_nodelay), err);
+    if(err){
+        _ml::warn("Could not set TCP_NODELAY", err.message());
+    }
+    if(sndbuf_size != SOCKBUF_SIZE_DEFAULT){
+        sock.set_option(_asio::socket_base::send_buffer_size(sndbuf_size), err);
+        if(err){
+            _ml::warn("Could not set SO_SNDBUF", err.message());
+        }
+    }
+    if(rcvbuf_size != SOCKBUF_SIZE_DEFAULT){
+        sock.set_option(_asio::socket_base::receive_buffer_size(rcvbuf_size), err);
+        if(err){
+            _ml::warn("Could not set SO_RCVBUF", err.message());
+        }
+    }
+}
+
+/* cork or uncork a TCP socket (a corked socket sends only full segments) */
+void setCork(_ip::tcp::socket& sock, const bool cork){
+    err_t err;
+    sock.set_option(tcp_cork_t(cork), err);
+    if(err){
+        _ml::warn("Could not set TCP_CORK", err.message());
+    }
+}
+
+/* find the connection of an IP address or a node ID (a display node or a relay node) */
+const int findConnection(const conn_list_t& conns, const std::string& ip_addr){
+    for(int i=0; i<int(conns.size()); ++i){
+        if(std::get<0>(conns[i]) == ip_addr){
+            return i;
+        }
+    }
+    return CONN_NOT_FOUND;
+}
+
+/* make the hello message sent first on each connection (an empty node ID lets the node be found by its IP address) */
+const std::string makeHelloMsg(const std::string& node_id){
+    return HELLO_HEAD + node_id + MSG_DELIMITER;
+}
+
+/* get the key of a connection from its hello message without the delimiter (empty if the message is invalid) */
+const std::string parseHelloMsg(const std::string& msg, const std::string& ip_addr){
+    if(msg.compare(0, HELLO_HEAD.length(), HELLO_HEAD) != 0){
+        return "";
+    }
+    const std::string node_id = msg.substr(HELLO_HEAD.length());
+    return node_id.empty() ? ip_addr : node_id;
+}
+
+/* bind the source address of a TCP socket (to run several nodes on one host with loopback addresses) */
+void bindSourceAddress(_ip::tcp::socket& sock, const std::string& ip_addr){
+    if(ip_addr.empty()){
+        return;
+    }
+    err_t err;
+    if(!sock.is_open()){
+        sock.open(_ip::tcp::v4());
+    }
+    sock.bind(_ip::tcp::endpoint(_ip::address::from_string(ip_addr), 0), err);
+    if(err){
+        _ml::caution("Could not bind source address " + ip_addr, err.message());
+        std::exit(EXIT_FAILURE);
+    }
+}
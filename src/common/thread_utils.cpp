@@ -0,0 +1,136 @@
+/*************************************
+*          thread_utils.cpp          *
+*  (utilities to place the threads)  *
+*************************************/
+
+#include "thread_utils.hpp"
+
+static std::mutex placement_lock;   // the mutex lock of the placement
+static thread_params_t placements;  // the placement of the roles
+
+static const std::string formatCores(const cpu_set_t& cpu_set);  // format the cores in a CPU set
+
+/* get the number of the online cores */
+const int getCoreNum(){
+    const int core_num = std::thread::hardware_concurrency();
+    return core_num>0 ? core_num : 1;
+}
+
+/* format the cores in a CPU set (e.g. "0,2,3") */
+static const std::string formatCores(const cpu_set_t& cpu_set){
+    std::string cores;
+    for(int i=0; i<CPU_SETSIZE; ++i){
+        if(CPU_ISSET(i, &cpu_set)){
+            cores += (cores.empty() ? "" : ",") + std::to_string(i);
+        }
+    }
+    return cores;
+}
+
+/* set the placement of the roles (the I/O roles are kept off the cores of the compute role) */
+void initThreadPlacement(const thread_params_t& params, const std::vector<std::string>& io_roles,
+                         const std::string& compute_role){
+    thread_params_t checked = params;
+    const int core_num = getCoreNum();
+    for(const auto& param : checked){
+        for(const int core : param.second.cores){
+            if(core < 0 || core >= core_num){
+                _ml::caution("Core of " + param.first + " threads is invalid", std::to_string(core));
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        if(param.second.rt_priority < 0 || param.second.rt_priority > RT_PRIORITY_MAX){
+            _ml::caution("Real-time priority of " + param.first + " threads is invalid", std::to_string(param.second.rt_priority));
+            std::exit(EXIT_FAILURE);
+        }
+        if(param.second.nice < NICE_MIN || param.second.nice > NICE_MAX){
+            _ml::caution("Nice value of " + param.first + " threads is invalid", std::to_string(param.second.nice));
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    
+    // keep the I/O threads off the cores of the compute threads
+    const std::vector<int> compute_cores = checked[compute_role].cores;
+    if(!compute_cores.empty()){
+        for(const std::string& io_role : io_roles){
+            std::vector<int>& io_cores = checked[io_role].cores;
+            const bool given = !io_cores.empty();
+            if(!given){
+                for(int i=0; i<core_num; ++i){
+                    io_cores.push_back(i);
+                }
+            }
+            std::vector<int> free_cores;
+            for(const int core : io_cores){
+                if(std::find(compute_cores.begin(), compute_cores.end(), core) == compute_cores.end()){
+                    free_cores.push_back(core);
+                }
+            }
+            if(free_cores.empty()){
+                _ml::warn("No core is left for " + io_role + " threads", "They share the cores of " + compute_role + " threads");
+                io_cores = given ? io_cores : std::vector<int>();
+            }else{
+                if(given && free_cores.size() < io_cores.size()){
+                    _ml::warn("Cores of " + io_role + " threads overlap " + compute_role + " threads", "The shared cores are not used");
+                }
+                io_cores = free_cores;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(placement_lock);
+    placements = checked;
+}
+
+/* place the calling thread (the i-th thread of a role is pinned to the i-th core of the role in turn) */
+const bool placeThread(const std::string& role, const int index, const int default_core){
+    ThreadPlacement placement;
+    {
+        std::lock_guard<std::mutex> lock(placement_lock);
+        const auto found = placements.find(role);
+        if(found != placements.end()){
+            placement = found->second;
+        }
+    }
+    bool placed = true;
+    
+    // pin the thread
+    const int core = placement.cores.empty() ? default_core : placement.cores[index%placement.cores.size()];
+    if(core != CORE_NOT_PINNED){
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(core%getCoreNum(), &cpu_set);
+        const int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+        if(result != 0){
+            _ml::warn("Could not pin " + role + " thread to core " + std::to_string(core), std::strerror(result));
+            placed = false;
+        }
+    }
+    
+    // set the scheduling policy (SCHED_FIFO and a negative nice value need CAP_SYS_NICE)
+    if(placement.rt_priority > 0){
+        sched_param param;
+        param.sched_priority = placement.rt_priority;
+        const int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if(result != 0){
+            _ml::warn("Could not set SCHED_FIFO to " + role + " thread", std::strerror(result));
+            placed = false;
+        }
+    }else if(placement.nice != 0){
+        if(setpriority(PRIO_PROCESS, syscall(SYS_gettid), placement.nice) != 0){
+            _ml::warn("Could not set nice value to " + role + " thread", std::strerror(errno));
+            placed = false;
+        }
+    }
+    
+    // log the resulting placement
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+    int policy;
+    sched_param param;
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    const std::string sched = policy==SCHED_FIFO ? "SCHED_FIFO " + std::to_string(param.sched_priority)
+                                                 : "nice " + std::to_string(getpriority(PRIO_PROCESS, syscall(SYS_gettid)));
+    _ml::notice("Thread " + role + "#" + std::to_string(index) + " runs on cores " + formatCores(cpu_set) + " (" + sched + ")");
+    return placed;
+}
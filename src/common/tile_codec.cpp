@@ -0,0 +1,165 @@
+/*****************************************************
+*                  tile_codec.cpp                    *
+*  (lossless codec for the tiles of screen content)  *
+*****************************************************/
+
+#include "tile_codec.hpp"
+
+static const int hashColor(const unsigned char *color);           // get the index of a color
+static void writeInt(std::string& tile, const uint32_t value);  // write a 32-bit integer in little endian
+static const uint32_t readInt(const unsigned char *ptr);        // read a 32-bit integer in little endian
+
+/* get the index of a color */
+static const int hashColor(const unsigned char *color){
+    return (color[0]*3 + color[1]*5 + color[2]*7) % LOSSLESS_INDEX_NUM;
+}
+
+/* write a 32-bit integer in little endian */
+static void writeInt(std::string& tile, const uint32_t value){
+    for(int i=0; i<4; ++i){
+        tile.push_back((char)((value>>(i*8)) & 0xff));
+    }
+}
+
+/* read a 32-bit integer in little endian */
+static const uint32_t readInt(const unsigned char *ptr){
+    return (uint32_t)ptr[0] | (uint32_t)ptr[1]<<8 | (uint32_t)ptr[2]<<16 | (uint32_t)ptr[3]<<24;
+}
+
+/* check if a tile looks like screen content (most of the pixels in the sampled rows equal the left ones) */
+const bool isFlatTile(const unsigned char *pixels, const int width, const int height, const int pitch){
+    int flat_num = 0;
+    int pixel_num = 0;
+    for(int y=0; y<height; y+=FLAT_SAMPLE_STEP){
+        const unsigned char *row = pixels + (size_t)pitch*y;
+        for(int x=3; x<width*3; x+=3){
+            flat_num += std::memcmp(row+x, row+x-3, 3) == 0;
+        }
+        pixel_num += width - 1;
+    }
+    return pixel_num > 0 && flat_num >= pixel_num*FLAT_RATIO_MIN;
+}
+
+/* encode an RGB tile without loss (false if it exceeds LOSSLESS_RATIO_MAX of the raw tile) */
+const bool encodeLosslessTile(const unsigned char *pixels, const int width, const int height, const int pitch,
+                              std::string& tile){
+    const size_t size_max = (size_t)(width*height*3*LOSSLESS_RATIO_MAX);
+    tile.clear();
+    tile.reserve(size_max + LOSSLESS_HEADER_SIZE);
+    tile += LOSSLESS_MAGIC;
+    writeInt(tile, width);
+    writeInt(tile, height);
+    
+    // the ops follow the pixels in raster order (the runs continue across the rows)
+    unsigned char index[LOSSLESS_INDEX_NUM][3] = {};
+    unsigned char prev[3] = {0, 0, 0};
+    int run = 0;
+    for(int y=0; y<height; ++y){
+        const unsigned char *row = pixels + (size_t)pitch*y;
+        for(int x=0; x<width; ++x){
+            const unsigned char *px = row + x*3;
+            if(std::memcmp(px, prev, 3) == 0){
+                if(++run == LOSSLESS_RUN_MAX){
+                    tile.push_back((char)(LOSSLESS_OP_RUN | (run-1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if(run > 0){
+                tile.push_back((char)(LOSSLESS_OP_RUN | (run-1)));
+                run = 0;
+            }
+            
+            // an indexed color, a small difference or a literal color
+            const int hash = hashColor(px);
+            if(std::memcmp(index[hash], px, 3) == 0){
+                tile.push_back((char)(LOSSLESS_OP_INDEX | hash));
+            }else{
+                std::memcpy(index[hash], px, 3);
+                const int dr = (signed char)(px[0]-prev[0]);
+                const int dg = (signed char)(px[1]-prev[1]);
+                const int db = (signed char)(px[2]-prev[2]);
+                const int dr_dg = dr - dg;
+                const int db_dg = db - dg;
+                if(dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1){
+                    tile.push_back((char)(LOSSLESS_OP_DIFF | (dr+2)<<4 | (dg+2)<<2 | (db+2)));
+                }else if(dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7){
+                    tile.push_back((char)(LOSSLESS_OP_LUMA | (dg+32)));
+                    tile.push_back((char)((dr_dg+8)<<4 | (db_dg+8)));
+                }else{
+                    tile.push_back((char)LOSSLESS_OP_RGB);
+                    tile.append((const char*)px, 3);
+                }
+            }
+            std::memcpy(prev, px, 3);
+        }
+        if(tile.size() > size_max){
+            return false;
+        }
+    }
+    if(run > 0){
+        tile.push_back((char)(LOSSLESS_OP_RUN | (run-1)));
+    }
+    return tile.size() <= size_max;
+}
+
+/* check if a tile is lossless (by the magic number at the head of the tile) */
+const bool isLosslessTile(const unsigned char *tile, const size_t size){
+    return size >= (size_t)LOSSLESS_HEADER_SIZE && std::memcmp(tile, LOSSLESS_MAGIC.c_str(), LOSSLESS_MAGIC.length()) == 0;
+}
+
+/* decode a lossless tile into RGB pixels (false if the tile is truncated or does not fit in the page) */
+const bool decodeLosslessTile(const unsigned char *tile, const size_t size, unsigned char *pixels, const int pitch,
+                              const int page_height)
+{
+    const int width = readInt(tile+4);
+    const int height = readInt(tile+8);
+    if(width <= 0 || height <= 0 || width > pitch/3 || height > page_height){
+        return false;
+    }
+    const unsigned char *ptr = tile + LOSSLESS_HEADER_SIZE;
+    const unsigned char *end = tile + size;
+    unsigned char index[LOSSLESS_INDEX_NUM][3] = {};
+    unsigned char px[3] = {0, 0, 0};
+    int run = 0;
+    for(int y=0; y<height; ++y){
+        unsigned char *row = pixels + (size_t)pitch*y;
+        for(int x=0; x<width; ++x){
+            if(run > 0){
+                --run;
+            }else{
+                if(ptr >= end){
+                    return false;
+                }
+                const unsigned char op = *ptr++;
+                if(op == LOSSLESS_OP_RGB){
+                    if(end-ptr < 3){
+                        return false;
+                    }
+                    std::memcpy(px, ptr, 3);
+                    ptr += 3;
+                }else if((op & LOSSLESS_OP_MASK) == LOSSLESS_OP_INDEX){
+                    std::memcpy(px, index[op], 3);
+                }else if((op & LOSSLESS_OP_MASK) == LOSSLESS_OP_DIFF){
+                    px[0] += ((op>>4) & 0x03) - 2;
+                    px[1] += ((op>>2) & 0x03) - 2;
+                    px[2] += (op & 0x03) - 2;
+                }else if((op & LOSSLESS_OP_MASK) == LOSSLESS_OP_LUMA){
+                    if(ptr >= end){
+                        return false;
+                    }
+                    const int dg = (op & 0x3f) - 32;
+                    const unsigned char diffs = *ptr++;
+                    px[0] += dg + ((diffs>>4) & 0x0f) - 8;
+                    px[1] += dg;
+                    px[2] += dg + (diffs & 0x0f) - 8;
+                }else{
+                    run = op & 0x3f;
+                }
+                std::memcpy(index[hashColor(px)], px, 3);
+            }
+            std::memcpy(row+x*3, px, 3);
+        }
+    }
+    return true;
+}
@@ -7,25 +7,38 @@
 
 /* constructor (allocate the buffer) */
 TransceiveFramebuffer::TransceiveFramebuffer(const int jpegbuf_num):
-    jpeg_buf(jpegbuf_num)
+    TransceiveFramebuffer(jpegbuf_num, jpegbuf_num)
+{}
+
+/* constructor (allocate the buffer of the maximum capacity to be resized without reallocation) */
+TransceiveFramebuffer::TransceiveFramebuffer(const int jpegbuf_num, const int max_num):
+    jpeg_buf(max_num),
+    capacity(jpegbuf_num)
 {}
 
 /* push a JPEG frame in the buffer */
 void TransceiveFramebuffer::push(const std::string& jpeg_frame){
-    while(this->jpeg_buf.full()){
+    while(int(this->jpeg_buf.size()) >= this->capacity.load(std::memory_order_acquire)){
         std::this_thread::sleep_for(std::chrono::nanoseconds(TRANBUF_SPINLOCK_INTERVAL));
     }
     this->jpeg_buf.push_back(jpeg_frame);
 }
 
 /* pop a JPEG frame from the buffer */
-const std::string TransceiveFramebuffer::pop(){
+std::string TransceiveFramebuffer::pop(){
+    int seq;
+    return this->pop(seq);
+}
+
+/* pop a JPEG frame from the buffer with its sequence number (the order of popping) */
+std::string TransceiveFramebuffer::pop(int& seq){
     std::lock_guard<std::mutex> pop_lock(this->lock);
     while(this->jpeg_buf.empty()){
         std::this_thread::sleep_for(std::chrono::nanoseconds(TRANBUF_SPINLOCK_INTERVAL));
     }
-    const std::string jpeg_frame = this->jpeg_buf[BUF_FRONT_INDEX];
+    std::string jpeg_frame = std::move(this->jpeg_buf[BUF_FRONT_INDEX]);
     this->jpeg_buf.pop_front();
+    seq = this->pop_num++;
     return jpeg_frame;
 }
 
@@ -34,3 +47,11 @@ const int TransceiveFramebuffer::getStoredNum(){
     return this->jpeg_buf.size();
 }
 
+/* change the number of the JPEG frames stored (the stored frames are kept, and false if it exceeds the allocation) */
+const bool TransceiveFramebuffer::setCapacity(const int jpegbuf_num){
+    if(jpegbuf_num < 1 || jpegbuf_num > int(this->jpeg_buf.capacity())){
+        return false;
+    }
+    this->capacity.store(jpegbuf_num, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,292 @@
+/******************************************
+*           color_corrector.cpp           *
+*  (corrector of the colors of a panel)   *
+******************************************/
+
+#include "color_corrector.hpp"
+
+static inline const double applyCurve(const double value, const double gain,  // map a value in [0, 1] through a curve
+                                      const double gamma, const double offset);
+static inline const double sampleTable(const std::vector<double>& values,     // interpolate a channel of a 1D LUT
+                                       const int size, const int channel, const double value);
+#if defined(__aarch64__)
+static inline uint8x16_t lookupLanes(const uint8x16_t levels,                 // look up 16 levels in a curve
+                                     const uint8x16x4_t *table);
+#endif
+
+/* map a value in [0, 1] through a curve (gain * value^gamma + offset) */
+static inline const double applyCurve(const double value, const double gain, const double gamma, const double offset){
+    const double clamped = std::min(std::max(value, 0.0), 1.0);
+    return std::min(std::max(gain*std::pow(clamped, gamma) + offset, 0.0), 1.0);
+}
+
+/* interpolate a channel of a 1D LUT of RGB values linearly */
+static inline const double sampleTable(const std::vector<double>& values, const int size, const int channel,
+                                       const double value)
+{
+    const double pos = std::min(std::max(value, 0.0), 1.0) * (size-1);
+    const int index = std::min((int)pos, size-2);
+    const double frac = pos - index;
+    return values[index*3+channel]*(1.0-frac) + values[(index+1)*3+channel]*frac;
+}
+
+#if defined(__aarch64__)
+/* look up 16 levels in a curve (the 256 entries are split into 4 tables of 64 entries) */
+static inline uint8x16_t lookupLanes(const uint8x16_t levels, const uint8x16x4_t *table){
+    const uint8x16_t quarter = vdupq_n_u8(COLOR_LEVEL_NUM/4);
+    uint8x16_t indices = levels;
+    uint8x16_t mapped = vqtbl4q_u8(table[0], indices);
+    indices = vsubq_u8(indices, quarter);
+    mapped = vqtbx4q_u8(mapped, table[1], indices);
+    indices = vsubq_u8(indices, quarter);
+    mapped = vqtbx4q_u8(mapped, table[2], indices);
+    indices = vsubq_u8(indices, quarter);
+    return vqtbx4q_u8(mapped, table[3], indices);
+}
+#endif
+
+/* constructor */
+ColorCorrector::ColorCorrector(){
+    for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+        for(int i=0; i<COLOR_LEVEL_NUM; ++i){
+            this->curves[c][i] = i;
+        }
+    }
+}
+
+/* read a .cube file (a 1D LUT has the RGB curves, and a 3D LUT has the RGB values with red varying fastest) */
+const bool ColorCorrector::loadCube(const std::string& lut_file, int& size, bool& is_3d, std::vector<double>& values){
+    std::ifstream cube(lut_file);
+    if(!cube){
+        _ml::caution("Failed to open LUT file", lut_file);
+        return false;
+    }
+    size = 0;
+    is_3d = false;
+    values.clear();
+    std::string line;
+    while(std::getline(cube, line)){
+        std::istringstream tokens(line);
+        std::string keyword;
+        if(!(tokens >> keyword) || keyword[0] == '#'){
+            continue;
+        }
+        if(keyword == CUBE_1D_SIZE || keyword == CUBE_3D_SIZE){
+            tokens >> size;
+            is_3d = keyword == CUBE_3D_SIZE;
+            continue;
+        }
+        if(keyword == CUBE_DOMAIN_MIN || keyword == CUBE_DOMAIN_MAX){
+            double bound;
+            const double expected = keyword == CUBE_DOMAIN_MIN ? 0.0 : 1.0;
+            while(tokens >> bound){
+                if(bound != expected){
+                    _ml::caution("Domain of LUT is not supported", lut_file + " (" + line + ")");
+                    return false;
+                }
+            }
+            continue;
+        }
+        if(!std::isdigit(keyword[0]) && keyword[0] != '-' && keyword[0] != '.'){
+            continue;
+        }
+        
+        // read a row of RGB values
+        std::istringstream row(line);
+        double red, green, blue;
+        if(!(row >> red >> green >> blue)){
+            _ml::caution("LUT file is invalid", lut_file + " (" + line + ")");
+            return false;
+        }
+        values.push_back(red);
+        values.push_back(green);
+        values.push_back(blue);
+    }
+    
+    const int size_max = is_3d ? LUT_3D_SIZE_MAX : LUT_1D_SIZE_MAX;
+    if(size < LUT_SIZE_MIN || size > size_max){
+        _ml::caution("Size of LUT is invalid", lut_file + " (" + std::to_string(size) + ")");
+        return false;
+    }
+    const size_t entry_num = is_3d ? (size_t)size*size*size : size;
+    if(values.size() != entry_num*3){
+        _ml::caution("Number of LUT entries is invalid", lut_file + " (" + std::to_string(values.size()/3) + ")");
+        return false;
+    }
+    return true;
+}
+
+/* build the correction of the parameters (the curves follow the LUT, and are baked into a 3D LUT) */
+const bool ColorCorrector::load(const color_params_t& params){
+    std::string lut_file;
+    std::vector<double> gain, gamma, offset;
+    std::tie(lut_file, gain, gamma, offset) = params;
+    if(lut_file.empty()){
+        this->setCurves(gain, gamma, offset);
+        return true;
+    }
+    
+    int size;
+    bool is_3d;
+    std::vector<double> values;
+    if(!this->loadCube(lut_file, size, is_3d, values)){
+        return false;
+    }
+    if(is_3d){
+        for(size_t i=0; i<values.size(); ++i){
+            values[i] = applyCurve(values[i], gain[i%3], gamma[i%3], offset[i%3]);
+        }
+        this->setLattice(size, values);
+    }else{
+        for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+            const int rgb = COLOR_CHANNEL_NUM-1 - c;
+            for(int i=0; i<COLOR_LEVEL_NUM; ++i){
+                const double value = sampleTable(values, size, rgb, (double)i/(COLOR_LEVEL_NUM-1));
+                this->curves[c][i] = std::lround(applyCurve(value, gain[rgb], gamma[rgb], offset[rgb])
+                                                 * (COLOR_LEVEL_NUM-1));
+            }
+        }
+        this->curves_enabled = true;
+    }
+    _ml::notice("Correcting colors with " + lut_file);
+    return true;
+}
+
+/* set the curves of each RGB channel (disabled if they do not change any level) */
+void ColorCorrector::setCurves(const std::vector<double>& gain, const std::vector<double>& gamma,
+                               const std::vector<double>& offset)
+{
+    this->curves_enabled = false;
+    for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+        const int rgb = COLOR_CHANNEL_NUM-1 - c;
+        for(int i=0; i<COLOR_LEVEL_NUM; ++i){
+            const double value = applyCurve((double)i/(COLOR_LEVEL_NUM-1), gain[rgb], gamma[rgb], offset[rgb]);
+            this->curves[c][i] = std::lround(value*(COLOR_LEVEL_NUM-1));
+            this->curves_enabled |= this->curves[c][i] != i;
+        }
+    }
+}
+
+/* set a 3D LUT of RGB values in [0, 1] (red varies fastest) */
+void ColorCorrector::setLattice(const int size, const std::vector<double>& values){
+    // store the values in BGR order with the fractional bits
+    const size_t point_num = (size_t)size*size*size;
+    this->lattice.assign(point_num*LATTICE_ENTRY_SIZE, 0);
+    for(size_t i=0; i<point_num; ++i){
+        for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+            const double value = std::min(std::max(values[i*3+COLOR_CHANNEL_NUM-1-c], 0.0), 1.0);
+            this->lattice[i*LATTICE_ENTRY_SIZE+c] = std::lround(value*(COLOR_LEVEL_NUM-1) * (1<<LATTICE_VALUE_SHIFT));
+        }
+    }
+    
+    // find the lower lattice point and the distance from it for each level in advance
+    this->lattice_steps[0] = size*size*LATTICE_ENTRY_SIZE;
+    this->lattice_steps[1] = size*LATTICE_ENTRY_SIZE;
+    this->lattice_steps[2] = LATTICE_ENTRY_SIZE;
+    for(int i=0; i<COLOR_LEVEL_NUM; ++i){
+        const double pos = (double)i*(size-1) / (COLOR_LEVEL_NUM-1);
+        const int index = std::min((int)pos, size-2);
+        const int weight = std::lround((pos-index) * LATTICE_WEIGHT_ONE);
+        for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+            this->lattice_offsets[c][i] = index * this->lattice_steps[c];
+            this->lattice_weights[c][i] = weight;
+        }
+    }
+    this->lattice_enabled = true;
+    this->curves_enabled = false;
+}
+
+/* check if any correction is applied */
+const bool ColorCorrector::isEnabled(){
+    return this->curves_enabled || this->lattice_enabled;
+}
+
+/* map a row through the curves (16 pixels at once with the table lookups of AArch64) */
+void ColorCorrector::mapCurvesRow(unsigned char *dst, const unsigned char *src, const int pixel_num){
+    int i = 0;
+#if defined(__aarch64__)
+    uint8x16x4_t tables[COLOR_CHANNEL_NUM][4];
+    for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+        for(int t=0; t<4; ++t){
+            for(int l=0; l<4; ++l){
+                tables[c][t].val[l] = vld1q_u8(this->curves[c] + t*COLOR_LEVEL_NUM/4 + l*COLOR_CURVE_LANES);
+            }
+        }
+    }
+    for(; i+COLOR_CURVE_LANES<=pixel_num; i+=COLOR_CURVE_LANES){
+        uint8x16x3_t pixels = vld3q_u8(src+i*COLOR_CHANNEL_NUM);
+        pixels.val[0] = lookupLanes(pixels.val[0], tables[0]);
+        pixels.val[1] = lookupLanes(pixels.val[1], tables[1]);
+        pixels.val[2] = lookupLanes(pixels.val[2], tables[2]);
+        vst3q_u8(dst+i*COLOR_CHANNEL_NUM, pixels);
+    }
+#endif
+    for(; i<pixel_num; ++i){
+        const unsigned char *src_pixel = src + i*COLOR_CHANNEL_NUM;
+        unsigned char *dst_pixel = dst + i*COLOR_CHANNEL_NUM;
+        dst_pixel[0] = this->curves[0][src_pixel[0]];
+        dst_pixel[1] = this->curves[1][src_pixel[1]];
+        dst_pixel[2] = this->curves[2][src_pixel[2]];
+    }
+}
+
+/* map a row through the 3D LUT (interpolated in the tetrahedron of the lattice cell which contains each pixel) */
+void ColorCorrector::mapLatticeRow(unsigned char *dst, const unsigned char *src, const int pixel_num){
+    const uint16_t *lattice = this->lattice.data();
+    const int diagonal = this->lattice_steps[0] + this->lattice_steps[1] + this->lattice_steps[2];
+    for(int i=0; i<pixel_num; ++i){
+        const unsigned char *src_pixel = src + i*COLOR_CHANNEL_NUM;
+        unsigned char *dst_pixel = dst + i*COLOR_CHANNEL_NUM;
+        const int base = this->lattice_offsets[0][src_pixel[0]] + this->lattice_offsets[1][src_pixel[1]]
+                         + this->lattice_offsets[2][src_pixel[2]];
+        const int weights[COLOR_CHANNEL_NUM] = {this->lattice_weights[0][src_pixel[0]],
+                                                this->lattice_weights[1][src_pixel[1]],
+                                                this->lattice_weights[2][src_pixel[2]]};
+        
+        // order the axes by the distance to walk from the lower point to the upper point of the cell
+        int first = 0, second = 1, third = 2;
+        if(weights[first] < weights[second]){
+            std::swap(first, second);
+        }
+        if(weights[second] < weights[third]){
+            std::swap(second, third);
+        }
+        if(weights[first] < weights[second]){
+            std::swap(first, second);
+        }
+        const uint16_t *point0 = lattice + base;
+        const uint16_t *point1 = point0 + this->lattice_steps[first];
+        const uint16_t *point2 = point1 + this->lattice_steps[second];
+        const uint16_t *point3 = point0 + diagonal;
+        const int weight0 = LATTICE_WEIGHT_ONE - weights[first];
+        const int weight1 = weights[first] - weights[second];
+        const int weight2 = weights[second] - weights[third];
+        const int weight3 = weights[third];
+#if defined(__ARM_NEON)
+        uint32x4_t sum = vmull_n_u16(vld1_u16(point0), weight0);
+        sum = vmlal_n_u16(sum, vld1_u16(point1), weight1);
+        sum = vmlal_n_u16(sum, vld1_u16(point2), weight2);
+        sum = vmlal_n_u16(sum, vld1_u16(point3), weight3);
+        const uint16x4_t mapped = vrshrn_n_u32(sum, LATTICE_OUTPUT_SHIFT);
+        dst_pixel[0] = vget_lane_u16(mapped, 0);
+        dst_pixel[1] = vget_lane_u16(mapped, 1);
+        dst_pixel[2] = vget_lane_u16(mapped, 2);
+#else
+        for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+            const int sum = weight0*point0[c] + weight1*point1[c] + weight2*point2[c] + weight3*point3[c];
+            dst_pixel[c] = (sum + (1<<(LATTICE_OUTPUT_SHIFT-1))) >> LATTICE_OUTPUT_SHIFT;
+        }
+#endif
+    }
+}
+
+/* copy a row of BGR pixels with the correction (the rows must not overlap) */
+void ColorCorrector::correctRow(unsigned char *dst, const unsigned char *src, const int pixel_num){
+    if(this->lattice_enabled){
+        this->mapLatticeRow(dst, src, pixel_num);
+    }else if(this->curves_enabled){
+        this->mapCurvesRow(dst, src, pixel_num);
+    }else{
+        std::memcpy(dst, src, (size_t)pixel_num*COLOR_CHANNEL_NUM);
+    }
+}
@@ -20,10 +20,50 @@ const bool ConfigParser::readParams(const _pt::ptree& conf){
         this->ip = this->getStrParam("head_node.ip");
         this->port = this->getIntParam("head_node.port");
         this->fb_dev = this->getStrParam("device.framebuffer");
+        this->node_ip = this->getStrParam("node.ip", "");
+        this->node_id = this->getStrParam("node.id", "");
+        this->stats_file = this->getStrParam("benchmark.stats_file", "");
+        this->scaled_decode = this->getBoolParam("decoder.scaled_decode", true);
     }catch(...){
         _ml::caution("Could not get parameter", "Config file is invalid");
         return false;
     }
+    return this->readColor(conf);
+}
+
+/* read the correction of the colors (the curves of each RGB channel are gain * value^gamma + offset) */
+const bool ConfigParser::readColor(const _pt::ptree& conf){
+    std::string lut_file;
+    std::vector<double> curve_params[3] = {{1.0, 1.0, 1.0}, {1.0, 1.0, 1.0}, {0.0, 0.0, 0.0}};
+    const std::string curve_keys[3] = {"gain", "gamma", "offset"};
+    try{
+        lut_file = this->getStrParam("color.lut_file", "");
+        for(int i=0; i<3; ++i){
+            const auto channels = conf.get_child_optional("color." + curve_keys[i]);
+            if(!channels){
+                continue;
+            }
+            curve_params[i].clear();
+            for(const auto& channel : *channels){
+                curve_params[i].push_back(channel.second.get_value<double>());
+            }
+            if(curve_params[i].size() != COLOR_CHANNEL_NUM){
+                _ml::caution("Color " + curve_keys[i] + " is invalid", std::to_string(curve_params[i].size()) + " values");
+                return false;
+            }
+        }
+    }catch(...){
+        _ml::caution("Could not get parameter", "Color correction is invalid");
+        return false;
+    }
+    
+    for(const double gamma : curve_params[1]){
+        if(gamma <= 0){
+            _ml::caution("Color gamma is invalid", std::to_string(gamma));
+            return false;
+        }
+    }
+    this->color = std::forward_as_tuple(lut_file, curve_params[0], curve_params[1], curve_params[2]);
     return true;
 }
 
@@ -32,6 +72,16 @@ const dc_params_t ConfigParser::getDisplayClientParams(){
     const std::string ip = this->ip;
     const int port = this->port;
     const std::string fb_dev = this->fb_dev;
-    return std::forward_as_tuple(ip, port, fb_dev);
+    const std::string node_ip = this->node_ip;
+    const std::string stats_file = this->stats_file;
+    const std::string node_id = this->node_id;
+    const bool scaled_decode = this->scaled_decode;
+    return std::forward_as_tuple(ip, port, fb_dev, node_ip, stats_file, node_id, scaled_decode);
 }
 
+
+/* get the correction of the colors */
+const color_params_t ConfigParser::getColorParams(){
+    const color_params_t color = this->color;
+    return color;
+}
@@ -12,9 +12,18 @@ DisplayClient::DisplayClient(_asio::io_service& ios, ConfigParser& parser):
 {
     // set the parameters
     int fs_port;
-    std::tie(this->ip_addr, fs_port, this->fb_dev) = parser.getDisplayClientParams();
+    std::tie(
+        this->ip_addr, fs_port, this->fb_dev, this->node_ip, this->stats_file, this->node_id, this->scaled_decode
+    ) = parser.getDisplayClientParams();
+    this->sock_params = parser.getSocketParams();
+    
+    // build the color correction before connecting (an invalid LUT fails at once)
+    if(!this->color_corrector.load(parser.getColorParams())){
+        std::exit(EXIT_FAILURE);
+    }
     
     // connect to the head node
+    bindSourceAddress(this->sock, this->node_ip);
     this->sock.async_connect(_ip::tcp::endpoint(_ip::address::from_string(this->ip_addr), fs_port),
                              boost::bind(&DisplayClient::onConnect, this, _ph::error)
     );
@@ -31,11 +40,13 @@ const init_params_t DisplayClient::parseInitMsg(const std::string& msg){
     const double fps_jitter = init_params.getDoubleParam("fps_jitter");
     const int recvbuf_num = init_params.getIntParam("recvbuf_num");
     const int dec_thre_num = init_params.getIntParam("dec_thre_num");
+    const int viewbuf_num = init_params.getIntParam("viewbuf_num");
     const int tuning_term = init_params.getIntParam("tuning_term");
     const int sampling_type = init_params.getIntParam("ycbcr_format");
     const int quality = init_params.getIntParam("quality");
     return std::forward_as_tuple(
-        width, height, stream_port, recvbuf_num, dec_thre_num, target_fps, fps_jitter, tuning_term, sampling_type, quality
+        width, height, stream_port, recvbuf_num, dec_thre_num, viewbuf_num, target_fps, fps_jitter, tuning_term,
+        sampling_type, quality
     );
 }
 
@@ -46,7 +57,14 @@ void DisplayClient::onConnect(const err_t& err){
         std::exit(EXIT_FAILURE);
     }
     _ml::notice("Connected to head node");
+    setSocketOptions(this->sock, this->sock_params);
     
+    // identify this node, and receive the initial message
+    this->hello_msg = makeHelloMsg(this->node_id);
+    _asio::async_write(this->sock,
+                       _asio::buffer(this->hello_msg),
+                       boost::bind(&DisplayClient::onSendHello, this, _ph::error, _ph::bytes_transferred)
+    );
     _asio::async_read_until(this->sock,
                             this->stream_buf,
                             MSG_DELIMITER,
@@ -54,6 +72,14 @@ void DisplayClient::onConnect(const err_t& err){
     );
 }
 
+/* the callback when sending the hello message */
+void DisplayClient::onSendHello(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Failed to send hello message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+}
+
 /* the callback when receiving the initial message */
 void DisplayClient::onRecvInitMsg(const err_t& err, size_t t_bytes){
     if(err){
@@ -64,11 +90,13 @@ void DisplayClient::onRecvInitMsg(const err_t& err, size_t t_bytes){
     
     // parse the initial message
     const auto data = this->stream_buf.data();
-    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(end));
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
     recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
-    int width, height, stream_port, recvbuf_num, dec_thre_num, target_fps, fps_jitter, tuning_term, ycbcr_format, quality;
+    int width, height, stream_port, recvbuf_num, dec_thre_num, viewbuf_num, target_fps, tuning_term, ycbcr_format, quality;
+    double fps_jitter;
     std::tie(
-        width, height, stream_port, recvbuf_num, dec_thre_num, target_fps, fps_jitter, tuning_term, ycbcr_format, quality
+        width, height, stream_port, recvbuf_num, dec_thre_num, viewbuf_num, target_fps, fps_jitter, tuning_term,
+        ycbcr_format, quality
     ) = this->parseInitMsg(recv_msg);
     
     // launch the receiver thread
@@ -79,14 +107,16 @@ void DisplayClient::onRecvInitMsg(const err_t& err, size_t t_bytes){
                                             recv_buf)
     );
     
-    // launch the decoder threads
-    const viewbuf_ptr_t view_buf = std::make_shared<ViewFramebuffer>(width, height, dec_thre_num+VIEWBUF_EXTRA_NUM);
+    // launch the decoder threads (the view framebuffer has as many pages as on every other node, whatever its decoders)
+    const viewbuf_ptr_t view_buf = std::make_shared<ViewFramebuffer>(width, height, viewbuf_num);
     for(int i=0; i<dec_thre_num; ++i){
         this->dec_thres.push_back(
             std::thread(std::bind(&DisplayClient::runFrameDecoder,
                                   this,
                                   recv_buf,
-                                  view_buf))
+                                  view_buf,
+                                  target_fps,
+                                  i))
         );
     }
     
@@ -98,19 +128,27 @@ void DisplayClient::onRecvInitMsg(const err_t& err, size_t t_bytes){
                        this->fb_dev,
                        width,
                        height,
-                       generator
+                       generator,
+                       this->color_corrector,
+                       this->stats_file
     );
 }
 
 /* launch the frame receiver */
 void DisplayClient::runFrameReceiver(const int stream_port, const tranbuf_ptr_t recv_buf){
+    _ft::setThreadName("receiver");
+    placeThread(THREAD_ROLE_RECEIVER, 0, CORE_NOT_PINNED);
     _asio::io_service ios;
-    FrameReceiver receiver(ios, this->ip_addr, stream_port, recv_buf);
+    FrameReceiver receiver(ios, this->ip_addr, stream_port, recv_buf, this->sock_params, this->node_ip, this->node_id);
 }
 
 /* launch the frame decoder */
-void DisplayClient::runFrameDecoder(const tranbuf_ptr_t recv_buf, const viewbuf_ptr_t view_buf){
-    FrameDecoder decoder(recv_buf, view_buf);
+void DisplayClient::runFrameDecoder(const tranbuf_ptr_t recv_buf, const viewbuf_ptr_t view_buf,
+                                    const int target_fps, const int index)
+{
+    _ft::setThreadName("decoder");
+    placeThread(THREAD_ROLE_DECODER, index, CORE_NOT_PINNED);
+    FrameDecoder decoder(recv_buf, view_buf, target_fps, this->scaled_decode);
     decoder.run();
 }
 
@@ -0,0 +1,94 @@
+/*************************************************
+*                edge_blender.cpp                *
+*  (blender of the overlapping projector edges)  *
+*************************************************/
+
+#include "edge_blender.hpp"
+#include "overlay_compositor.hpp"
+
+/* constructor */
+EdgeBlender::EdgeBlender(const int width, const int height):
+    width(width),
+    height(height)
+{}
+
+/* make the gain of each pixel across a strip (the gain rises from the outer edge, and the ramps of the neighbors sum to one in light) */
+const std::vector<double> EdgeBlender::makeRamp(const int size, const bool rising, const double gamma){
+    std::vector<double> gains(size);
+    for(int i=0; i<size; ++i){
+        const double pos = ((rising ? i : size-1-i) + 0.5) / size;
+        const double light = pos < 0.5 ? 0.5*std::pow(2.0*pos, EDGE_BLEND_POWER)
+                                       : 1.0 - 0.5*std::pow(2.0*(1.0-pos), EDGE_BLEND_POWER);
+        gains[i] = std::pow(light, 1.0/gamma);
+    }
+    return gains;
+}
+
+/* set the strips and make their masks (the attenuation is the alpha to blend black with) */
+void EdgeBlender::setEdges(const int left, const int right, const int top, const int bottom, const double gamma){
+    this->left = std::min(std::max(left, 0), this->width);
+    this->right = std::min(std::max(right, 0), this->width-this->left);
+    this->top = std::min(std::max(top, 0), this->height);
+    this->bottom = std::min(std::max(bottom, 0), this->height-this->top);
+    
+    // the gain of each column (one out of the left and right strips)
+    const std::vector<double> left_gains = this->makeRamp(this->left, true, gamma);
+    const std::vector<double> right_gains = this->makeRamp(this->right, false, gamma);
+    std::vector<double> column_gains(this->width, 1.0);
+    std::copy(left_gains.begin(), left_gains.end(), column_gains.begin());
+    std::copy(right_gains.begin(), right_gains.end(), column_gains.end()-this->right);
+    this->left_mask.resize(this->left);
+    for(int i=0; i<this->left; ++i){
+        this->left_mask[i] = 255 - std::lround(left_gains[i]*255);
+    }
+    this->right_mask.resize(this->right);
+    for(int i=0; i<this->right; ++i){
+        this->right_mask[i] = 255 - std::lround(right_gains[i]*255);
+    }
+    
+    // the corners are faded by both of the ramps
+    const std::vector<double> top_gains = this->makeRamp(this->top, true, gamma);
+    const std::vector<double> bottom_gains = this->makeRamp(this->bottom, false, gamma);
+    this->top_mask.resize((size_t)this->top*this->width);
+    for(int j=0; j<this->top; ++j){
+        for(int i=0; i<this->width; ++i){
+            this->top_mask[(size_t)this->width*j+i] = 255 - std::lround(top_gains[j]*column_gains[i]*255);
+        }
+    }
+    this->bottom_mask.resize((size_t)this->bottom*this->width);
+    for(int j=0; j<this->bottom; ++j){
+        for(int i=0; i<this->width; ++i){
+            this->bottom_mask[(size_t)this->width*j+i] = 255 - std::lround(bottom_gains[j]*column_gains[i]*255);
+        }
+    }
+}
+
+/* remove the strips */
+void EdgeBlender::clear(){
+    this->setEdges(0, 0, 0, 0, 1.0);
+}
+
+/* check if no strip is set */
+const bool EdgeBlender::isEmpty(){
+    return this->left == 0 && this->right == 0 && this->top == 0 && this->bottom == 0;
+}
+
+/* fade the strips of a page (the pixels are attenuated in the same way as the overlays are blended, so the page must be a copy presented once) */
+void EdgeBlender::blend(unsigned char *page, const int pitch){
+    const int middle_end = this->height - this->bottom;
+    for(int j=0; j<this->top; ++j){
+        blendMaskRow(page+(size_t)pitch*j, this->top_mask.data()+(size_t)this->width*j, this->width, EDGE_BLEND_BLACK);
+    }
+    if(this->left > 0 || this->right > 0){
+        for(int j=this->top; j<middle_end; ++j){
+            unsigned char *row = page + (size_t)pitch*j;
+            blendMaskRow(row, this->left_mask.data(), this->left, EDGE_BLEND_BLACK);
+            blendMaskRow(row+(this->width-this->right)*COLOR_CHANNEL_NUM, this->right_mask.data(), this->right,
+                         EDGE_BLEND_BLACK);
+        }
+    }
+    for(int j=middle_end; j<this->height; ++j){
+        blendMaskRow(page+(size_t)pitch*j, this->bottom_mask.data()+(size_t)this->width*(j-middle_end), this->width,
+                     EDGE_BLEND_BLACK);
+    }
+}
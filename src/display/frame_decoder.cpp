@@ -5,11 +5,65 @@
 
 #include "frame_decoder.hpp"
 
+static void upscaleRow(unsigned char *dst, const int dst_num,       // upscale a row twice with the midpoints
+                       const unsigned char *src, const int src_num);
+static void averageRows(unsigned char *dst, const unsigned char *upper,  // average two rows into another row
+                        const unsigned char *lower, const int byte_num);
+
+/* upscale a row of BGR pixels twice (the odd pixels are the rounded averages of their neighbors, 16 at once with NEON) */
+static void upscaleRow(unsigned char *dst, const int dst_num, const unsigned char *src, const int src_num){
+    int i = 0;
+#if defined(__ARM_NEON)
+    for(; i+UPSCALE_LANES<src_num && (i+UPSCALE_LANES)*2<=dst_num; i+=UPSCALE_LANES){
+        const uint8x16x3_t pixels = vld3q_u8(src+i*COLOR_CHANNEL_NUM);
+        const uint8x16x3_t nexts = vld3q_u8(src+(i+1)*COLOR_CHANNEL_NUM);
+        uint8x16x3_t lows, highs;
+        for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+            const uint8x16x2_t zipped = vzipq_u8(pixels.val[c], vrhaddq_u8(pixels.val[c], nexts.val[c]));
+            lows.val[c] = zipped.val[0];
+            highs.val[c] = zipped.val[1];
+        }
+        vst3q_u8(dst+i*2*COLOR_CHANNEL_NUM, lows);
+        vst3q_u8(dst+(i*2+UPSCALE_LANES)*COLOR_CHANNEL_NUM, highs);
+    }
+#endif
+    for(int j=i*2; j<dst_num; ++j){
+        const unsigned char *pixel = src + (j/2)*COLOR_CHANNEL_NUM;
+        const unsigned char *next = src + std::min(j/2+j%2, src_num-1)*COLOR_CHANNEL_NUM;
+        unsigned char *dst_pixel = dst + j*COLOR_CHANNEL_NUM;
+        for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+            dst_pixel[c] = (pixel[c]+next[c]+1) >> 1;
+        }
+    }
+}
+
+/* average two rows into another row (rounded, 16 bytes at once with NEON) */
+static void averageRows(unsigned char *dst, const unsigned char *upper, const unsigned char *lower, const int byte_num){
+    int i = 0;
+#if defined(__ARM_NEON)
+    for(; i+UPSCALE_LANES<=byte_num; i+=UPSCALE_LANES){
+        vst1q_u8(dst+i, vrhaddq_u8(vld1q_u8(upper+i), vld1q_u8(lower+i)));
+    }
+#endif
+    for(; i<byte_num; ++i){
+        dst[i] = (upper[i]+lower[i]+1) >> 1;
+    }
+}
+
 /* constructor */
-FrameDecoder::FrameDecoder(const tranbuf_ptr_t recv_buf, const viewbuf_ptr_t view_buf):
+FrameDecoder::FrameDecoder(const tranbuf_ptr_t recv_buf, const viewbuf_ptr_t view_buf,
+                           const int target_fps, const bool scaled_decode):
     handle(tjInitDecompress()),
     recv_buf(recv_buf),
-    view_buf(view_buf)
+    view_buf(view_buf),
+    frame_interval(1000000000/target_fps),
+    scaled_decode(scaled_decode),
+    decode_hist(_mt::addStageHistogram(TRACE_STAGE_NAMES[TRACE_DECODE])),
+    decode_failures(_mt::addCounter("tdw_decode_failures_total", "Number of the failed JPEG decodes", "")),
+    half_decodes(_mt::addCounter("tdw_scaled_decodes_total", "Number of the late frames decoded at a reduced scale",
+                                 _mt::labels({{"scale", "1/2"}}))),
+    quarter_decodes(_mt::addCounter("tdw_scaled_decodes_total", "Number of the late frames decoded at a reduced scale",
+                                    _mt::labels({{"scale", "1/4"}})))
 {
     // launch the TruboJPEG decoder
     if(this->handle == NULL){
@@ -24,8 +78,32 @@ FrameDecoder::~FrameDecoder(){
     tjDestroy(this->handle);
 }
 
-/* decode a JPEG frame */
-void FrameDecoder::decode(unsigned char *jpeg_frame, const unsigned long jpeg_size, const int id){
+/* choose the scale to decode a frame (reduced when the frames queue up and the frame would miss its released page) */
+const int FrameDecoder::chooseScale(const int id){
+    if(!this->scaled_decode || this->recv_buf->getStoredNum() == 0){
+        return DECODE_SCALE_FULL;
+    }
+    
+    // the viewer shows the pages before this frame in one interval each at least
+    const int lead_num = this->view_buf->getLeadNum(id);
+    if(this->decode_cost <= lead_num*this->frame_interval){
+        return DECODE_SCALE_FULL;
+    }
+    return lead_num == 0 ? DECODE_SCALE_QUARTER : DECODE_SCALE_HALF;
+}
+
+/* decode a JPEG frame (or a lossless tile of screen content) at 1/scale, and upscale it into the page */
+void FrameDecoder::decode(unsigned char *jpeg_frame, const unsigned long jpeg_size, const int id, const int scale){
+    // the codec is told by the head of the tile
+    if(isLosslessTile(jpeg_frame, jpeg_size)){
+        if(!decodeLosslessTile(jpeg_frame, jpeg_size, this->view_buf->getDrawPage(id), this->view_buf->getPitch(),
+                               this->view_buf->getHeight())){
+            _ml::warn("Could not get new video frame", "Lossless tile is broken");
+            this->decode_failures->add(1);
+        }
+        return;
+    }
+    
     // read the header of the frame
     int frame_w, frame_h, sampling_type;
     const int tj_stat1 = tjDecompressHeader2(this->handle,
@@ -38,38 +116,107 @@ void FrameDecoder::decode(unsigned char *jpeg_frame, const unsigned long jpeg_si
     if(tj_stat1 == JPEG_FAILED){
         const std::string err_msg(tjGetErrorStr());
         _ml::warn("Could not get new video frame", err_msg);
+        this->decode_failures->add(1);
         return;
     }
     
-    // decode the frame
+    if(frame_w > this->view_buf->getPitch()/COLOR_CHANNEL_NUM || frame_h > this->view_buf->getHeight()){
+        _ml::warn("Could not get new video frame", "Frame is larger than page");
+        this->decode_failures->add(1);
+        return;
+    }
+    
+    // decode the frame (the IDCT of a reduced scale outputs fewer pixels of each block)
+    const tjscalingfactor factor = {1, scale};
+    const int scaled_w = TJSCALED(frame_w, factor);
+    const int scaled_h = TJSCALED(frame_h, factor);
+    unsigned char *draw_page = this->view_buf->getDrawPage(id);
+    if(scale != DECODE_SCALE_FULL){
+        this->scaled_frame.resize((size_t)scaled_w*scaled_h*COLOR_CHANNEL_NUM);
+    }
     const int tj_stat2 = tjDecompress2(this->handle,
                                        jpeg_frame,
                                        jpeg_size,
-                                       this->view_buf->getDrawPage(id),
-                                       frame_w,
-                                       frame_w*COLOR_CHANNEL_NUM,
-                                       frame_h,
+                                       scale == DECODE_SCALE_FULL ? draw_page : this->scaled_frame.data(),
+                                       scaled_w,
+                                       scale == DECODE_SCALE_FULL ? this->view_buf->getPitch() : scaled_w*COLOR_CHANNEL_NUM,
+                                       scaled_h,
                                        TJPF_RGB,
                                        TJFLAG_FASTDCT|TJFLAG_FASTUPSAMPLE
     );
     if(tj_stat2 == JPEG_FAILED){
         const std::string err_msg(tjGetErrorStr());
         _ml::warn("Could not get new video frame", err_msg);
+        this->decode_failures->add(1);
         return;
     }
+    
+    // upscale the frame into the page (a frame at 1/4 scale is upscaled twice)
+    if(scale == DECODE_SCALE_HALF){
+        this->upscale(draw_page, this->view_buf->getPitch(), frame_w, frame_h,
+                      this->scaled_frame.data(), scaled_w, scaled_h);
+        this->half_decodes->add(1);
+    }else if(scale == DECODE_SCALE_QUARTER){
+        const int half_w = (frame_w+1) / 2;
+        const int half_h = (frame_h+1) / 2;
+        this->half_frame.resize((size_t)half_w*half_h*COLOR_CHANNEL_NUM);
+        this->upscale(this->half_frame.data(), half_w*COLOR_CHANNEL_NUM, half_w, half_h,
+                      this->scaled_frame.data(), scaled_w, scaled_h);
+        this->upscale(draw_page, this->view_buf->getPitch(), frame_w, frame_h,
+                      this->half_frame.data(), half_w, half_h);
+        this->quarter_decodes->add(1);
+    }
+}
+
+/* upscale a frame twice in each dimension (the odd rows are the averages of their neighbors) */
+void FrameDecoder::upscale(unsigned char *dst, const int dst_pitch, const int dst_w, const int dst_h,
+                           const unsigned char *src, const int src_w, const int src_h)
+{
+    const int src_pitch = src_w * COLOR_CHANNEL_NUM;
+    for(int y=0; y<dst_h; y+=2){
+        upscaleRow(dst+y*dst_pitch, dst_w, src+(y/2)*src_pitch, src_w);
+        if(y > 0){
+            averageRows(dst+(y-1)*dst_pitch, dst+(y-2)*dst_pitch, dst+y*dst_pitch, dst_w*COLOR_CHANNEL_NUM);
+        }
+    }
+    
+    // the last odd row has no row below it
+    if(dst_h%2 == 0){
+        std::copy(dst+(dst_h-2)*dst_pitch, dst+(dst_h-2)*dst_pitch+dst_w*COLOR_CHANNEL_NUM, dst+(dst_h-1)*dst_pitch);
+    }
+}
+
+/* decode a received JPEG frame into the view framebuffer (at the scale chosen by its deadline by default) */
+void FrameDecoder::decodeFrame(std::string jpeg_str, const int seq, const int scale){
+    const int id = std::stoi(jpeg_str.substr(FRAME_ID_INDEX, FRAME_ID_LEN));
+    jpeg_str.erase(FRAME_ID_INDEX, FRAME_ID_LEN);
+    
+    const unsigned long jpeg_size = (unsigned long)jpeg_str.length();
+    std::vector<unsigned char> jpeg_frame(jpeg_str.c_str(), jpeg_str.c_str()+jpeg_size);
+    
+    // the page of the previous lap is released before the deadline of the frame is judged
+    this->view_buf->getDrawPage(id);
+    const int decode_scale = scale == DECODE_SCALE_AUTO ? this->chooseScale(id) : scale;
+    const int64_t decode_t = _ft::now();
+    this->decode(jpeg_frame.data(), jpeg_size, id, decode_scale);
+    _ft::record(TRACE_DECODE, seq, TRACE_NO_TILE, decode_t);
+    const int64_t elapsed_t = _ft::now() - decode_t;
+    this->decode_hist->observe(elapsed_t);
+    
+    // only the full decodes are the cost to be saved
+    if(decode_scale == DECODE_SCALE_FULL){
+        this->decode_cost += DECODE_COST_WEIGHT * (elapsed_t-this->decode_cost);
+    }
+    this->view_buf->activatePage(id);
+    _ft::mark(TRACE_PAGE_READY, seq, TRACE_NO_TILE);
 }
 
 /* start decoding JPEG frames */
 void FrameDecoder::run(){
     while(true){
-        std::string jpeg_str = this->recv_buf->pop();
-        const int id = std::stoi(jpeg_str.substr(FRAME_ID_INDEX, FRAME_ID_LEN));
-        jpeg_str.erase(FRAME_ID_INDEX, FRAME_ID_LEN);
-        
-        const unsigned long jpeg_size = (unsigned long)jpeg_str.length();
-        std::vector<unsigned char> jpeg_frame(jpeg_str.c_str(), jpeg_str.c_str()+jpeg_size);
-        this->decode(jpeg_frame.data(), jpeg_size, id);
-        this->view_buf->activatePage(id);
+        int seq;
+        std::string jpeg_str = this->recv_buf->pop(seq);
+        this->decodeFrame(std::move(jpeg_str), seq);
     }
 }
 
@@ -7,17 +7,30 @@
 
 /* constructor */
 FrameReceiver::FrameReceiver(_asio::io_service& ios, const std::string& ip_addr, const int stream_port,
-                             const tranbuf_ptr_t recv_buf):
+                             const tranbuf_ptr_t recv_buf, const sockopt_params_t& sock_params,
+                             const std::string& node_ip, const std::string& node_id):
     ios(ios),
     sock(ios),
-    recv_buf(recv_buf)
+    recv_buf(recv_buf),
+    recv_hist(_mt::addStageHistogram(TRACE_STAGE_NAMES[TRACE_RECEIVE])),
+    recv_bytes(_mt::addCounter("tdw_received_bytes_total", "Bytes received from the head node", "")),
+    hello_msg(makeHelloMsg(node_id))
 {
+    _mt::addGauge("tdw_recv_queue_depth", "JPEG frames stored in the receive framebuffer", "",
+                  std::bind(&TransceiveFramebuffer::getStoredNum, this->recv_buf));
     _ml::notice("Receiving video frames from " + ip_addr + ":" + std::to_string(stream_port));
-    this->run(ip_addr, stream_port);
+    this->run(ip_addr, stream_port, sock_params, node_ip);
 }
 
 /* start receiving JPEG frames */
-void FrameReceiver::run(const std::string& ip_addr, const int stream_port){
+void FrameReceiver::run(const std::string& ip_addr, const int stream_port, const sockopt_params_t& sock_params,
+                        const std::string& node_ip)
+{
+    // set the socket options before connecting (to apply SO_RCVBUF to the TCP window)
+    this->sock.open(_ip::tcp::v4());
+    setSocketOptions(this->sock, sock_params);
+    bindSourceAddress(this->sock, node_ip);
+    
     this->sock.async_connect(_ip::tcp::endpoint(_ip::address::from_string(ip_addr), stream_port),
                              boost::bind(&FrameReceiver::onConnect, this, _ph::error)
     );
@@ -31,6 +44,11 @@ void FrameReceiver::onConnect(const err_t& err){
         return;
     }
     
+    // identify this node, and start receiving the frames
+    _asio::async_write(this->sock,
+                       _asio::buffer(this->hello_msg),
+                       boost::bind(&FrameReceiver::onSendHello, this, _ph::error, _ph::bytes_transferred)
+    );
     _asio::async_read_until(this->sock,
                             this->stream_buf,
                             MSG_DELIMITER,
@@ -38,16 +56,27 @@ void FrameReceiver::onConnect(const err_t& err){
     );
 }
 
+/* the callback when sending the hello message */
+void FrameReceiver::onSendHello(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Failed to send hello message", err.message());
+    }
+}
+
 /* the callback when receiving a JPEG frame */
 void FrameReceiver::onRecvFrame(const err_t& err, size_t t_bytes){
     if(err){
         _ml::caution("Could not receive frame", err.message());
     }else{
+        const int64_t recv_t = _ft::now();
         const auto data = this->stream_buf.data();
         std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
         recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
         this->recv_buf->push(recv_msg);
         this->stream_buf.consume(t_bytes);
+        _ft::record(TRACE_RECEIVE, this->frame_seq++, TRACE_NO_TILE, recv_t);
+        this->recv_hist->observe(_ft::now()-recv_t);
+        this->recv_bytes->add(t_bytes);
     }
     
     _asio::async_read_until(this->sock,
@@ -8,22 +8,44 @@
 /* constructor */
 FrameViewer::FrameViewer(_asio::io_service& ios, _ip::tcp::socket& sock, 
                          const viewbuf_ptr_t view_buf, const std::string& fb_dev, const int width,
-                         const int height, SyncMessageGenerator& generator):
+                         const int height, SyncMessageGenerator& generator, ColorCorrector& color_corrector,
+                         const std::string& stats_file):
     ios(ios),
     sock(sock),
     view_buf(view_buf),
-    generator(generator)
+    generator(generator),
+    overlay(width, height),
+    color_corrector(color_corrector),
+    wait_hist(_mt::addStageHistogram("wait")),
+    sync_hist(_mt::addStageHistogram("sync")),
+    view_hist(_mt::addStageHistogram(TRACE_STAGE_NAMES[TRACE_PRESENT]))
 {
     // open the framebuffer of fbdev
     if(!this->openFramebuffer(fb_dev, width, height)){
         std::exit(EXIT_FAILURE);
     }
+    this->frame_pitch = this->view_buf->getPitch();
+    this->row_size = std::min(width*COLOR_CHANNEL_NUM, this->fb_pitch);
+    this->row_num = std::min(height, this->fb_size/this->fb_pitch);
+    
+    // open the file to record the elapsed time of each frame (for benchmarking)
+    if(!stats_file.empty()){
+        this->stats.open(stats_file, std::ios::out|std::ios::trunc);
+        if(!this->stats){
+            _ml::caution("Failed to open stats file", stats_file);
+            std::exit(EXIT_FAILURE);
+        }
+        this->stats << "wait_us,sync_us,view_us" << std::endl;
+    }
     
     // get the initial frame
+    _ft::setThreadName("viewer");
+    placeThread(THREAD_ROLE_VIEWER, 0, CORE_NOT_PINNED);
     this->pre_t = _chrono::high_resolution_clock::now();
     this->next_frame = this->view_buf->getDisplayPage();
     this->post_t = _chrono::high_resolution_clock::now();
     this->generator.wait_t_sum += _chrono::duration_cast<_chrono::milliseconds>(this->post_t-this->pre_t).count();
+    this->generator.last_wait_t = _chrono::duration_cast<_chrono::microseconds>(this->post_t-this->pre_t).count();
     
     // send a sync message
     this->pre_t = _chrono::high_resolution_clock::now();
@@ -37,8 +59,13 @@ FrameViewer::~FrameViewer(){
     close(this->fb);
 }
 
-/* open the framebuffer of fbdev */
+/* open the framebuffer of fbdev (a path other than a device file is emulated) */
 const bool FrameViewer::openFramebuffer(const std::string& fb_dev, const int width, const int height){
+    struct stat fb_stat;
+    if(stat(fb_dev.c_str(), &fb_stat) != 0 || !S_ISCHR(fb_stat.st_mode)){
+        return this->emulateFramebuffer(fb_dev, width, height);
+    }
+    
     // load the device file of fbdev
     this->fb = open(fb_dev.c_str(), O_RDWR);
     if(this->fb == DEVICE_OPEN_FAILED){
@@ -69,6 +96,7 @@ const bool FrameViewer::openFramebuffer(const std::string& fb_dev, const int wid
         return false;
     }
     this->fb_size = vinfo.yres * finfo.line_length;
+    this->fb_pitch = finfo.line_length;
     
     // map the framebuffer onto the memory
     this->fb_ptr = (unsigned char*)mmap(NULL,
@@ -85,18 +113,80 @@ const bool FrameViewer::openFramebuffer(const std::string& fb_dev, const int wid
     return true;
 }
 
-/* display a frame */
+/* map a regular file as the framebuffer (put it on tmpfs to emulate the framebuffer in the memory) */
+const bool FrameViewer::emulateFramebuffer(const std::string& fb_file, const int width, const int height){
+    this->fb = open(fb_file.c_str(), O_RDWR|O_CREAT, 0644);
+    if(this->fb == DEVICE_OPEN_FAILED){
+        _ml::caution("Failed to open framebuffer", fb_file);
+        return false;
+    }
+    this->fb_size = width * height * BITS_PER_PIXEL / 8;
+    this->fb_pitch = width * BITS_PER_PIXEL / 8;
+    if(ftruncate(this->fb, this->fb_size)){
+        _ml::caution("Could not set framebuffer size", "ftruncate failed");
+        return false;
+    }
+    this->fb_ptr = (unsigned char*)mmap(NULL,
+                                        this->fb_size,
+                                        PROT_READ|PROT_WRITE,
+                                        MAP_SHARED,
+                                        this->fb,
+                                        0
+    );
+    if(fb_ptr == MAP_FAILED){
+        _ml::caution("Failed to open framebuffer", "mmap falied");
+        return false;
+    }
+    _ml::notice("Emulating framebuffer with " + fb_file);
+    return true;
+}
+
+/* record the elapsed time of a frame (flushed in each frame to be read while running) */
+void FrameViewer::recordStats(const _chrono::nanoseconds& wait_t, const _chrono::nanoseconds& sync_t,
+                              const _chrono::nanoseconds& view_t)
+{
+    if(!this->stats.is_open()){
+        return;
+    }
+    this->stats << _chrono::duration_cast<_chrono::microseconds>(wait_t).count() << ","
+                << _chrono::duration_cast<_chrono::microseconds>(sync_t).count() << ","
+                << _chrono::duration_cast<_chrono::microseconds>(view_t).count() << std::endl;
+}
+
+/* display a frame (row by row if the rows of the decoded frames are padded differently from the framebuffer) */
 void FrameViewer::displayFrame(){
-    std::memcpy(this->fb_ptr, this->next_frame, this->fb_size);
+    // draw the overlays onto a copy of the decoded frame (a page presented again after a failed decode stays clean)
+    const unsigned char *frame = this->next_frame;
+    if(!this->overlay.isEmpty()){
+        this->overlay_frame.resize((size_t)this->frame_pitch*this->view_buf->getHeight());
+        std::memcpy(this->overlay_frame.data(), this->next_frame, this->overlay_frame.size());
+        this->overlay.blend(this->overlay_frame.data(), this->frame_pitch);
+        frame = this->overlay_frame.data();
+    }
+    
+    // correct the colors while copying the rows (without another pass over the frame)
+    if(this->color_corrector.isEnabled()){
+        const int pixel_num = this->row_size / COLOR_CHANNEL_NUM;
+        for(int i=0; i<this->row_num; ++i){
+            this->color_corrector.correctRow(this->fb_ptr+(size_t)this->fb_pitch*i,
+                                             frame+(size_t)this->frame_pitch*i, pixel_num);
+        }
+    }else if(this->frame_pitch == this->fb_pitch){
+        std::memcpy(this->fb_ptr, frame, (size_t)this->row_num*this->fb_pitch);
+    }else{
+        for(int i=0; i<this->row_num; ++i){
+            std::memcpy(this->fb_ptr+(size_t)this->fb_pitch*i, frame+(size_t)this->frame_pitch*i, this->row_size);
+        }
+    }
     msync(this->fb_ptr, this->fb_size, MS_SYNC|MS_INVALIDATE);
     std::this_thread::sleep_for(std::chrono::milliseconds(DISPLAY_INTERVAL));
 }
 
 /* send a sync message */
 void FrameViewer::sendSync(){
-    const std::string send_msg = this->generator.generate() + MSG_DELIMITER;
+    this->send_msg = this->generator.generate() + MSG_DELIMITER;
     _asio::async_write(this->sock,
-                       _asio::buffer(send_msg),
+                       _asio::buffer(this->send_msg),
                        boost::bind(&FrameViewer::onSendSync, this, _ph::error, _ph::bytes_transferred)
     );
 }
@@ -122,20 +212,40 @@ void FrameViewer::onRecvSync(const err_t& err, size_t t_bytes){
         std::exit(EXIT_FAILURE);
     }
     this->post_t = _chrono::high_resolution_clock::now();
-    this->generator.sync_t_sum += _chrono::duration_cast<_chrono::milliseconds>(this->post_t-this->pre_t).count();
+    
+    // apply the overlay commands following the sync message
+    const auto data = this->stream_buf.data();
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
+    this->stream_buf.consume(t_bytes);
+    const std::vector<std::string> cmds = splitOverlayCmds(recv_msg);
+    for(size_t i=1; i<cmds.size(); ++i){
+        this->overlay.apply(cmds[i]);
+    }
+    const _chrono::nanoseconds sync_t = this->post_t - this->pre_t;
+    this->generator.sync_t_sum += _chrono::duration_cast<_chrono::milliseconds>(sync_t).count();
+    this->sync_hist->observe(sync_t.count());
     
     // display a frame
     this->pre_t = _chrono::high_resolution_clock::now();
+    const int64_t present_t = _ft::now();
     this->displayFrame();
     this->view_buf->deactivatePage();
+    _ft::record(TRACE_PRESENT, this->frame_seq++, TRACE_NO_TILE, present_t);
     this->post_t = _chrono::high_resolution_clock::now();
-    this->generator.view_t_sum += _chrono::duration_cast<_chrono::milliseconds>(this->post_t-this->pre_t).count();
+    const _chrono::nanoseconds view_t = this->post_t - this->pre_t;
+    this->generator.view_t_sum += _chrono::duration_cast<_chrono::milliseconds>(view_t).count();
+    this->view_hist->observe(view_t.count());
     
     // get a next frame
     this->pre_t = _chrono::high_resolution_clock::now();
     this->next_frame = this->view_buf->getDisplayPage();
     this->post_t = _chrono::high_resolution_clock::now();
-    this->generator.wait_t_sum += _chrono::duration_cast<_chrono::milliseconds>(this->post_t-this->pre_t).count();
+    const _chrono::nanoseconds wait_t = this->post_t - this->pre_t;
+    this->generator.wait_t_sum += _chrono::duration_cast<_chrono::milliseconds>(wait_t).count();
+    this->generator.last_wait_t = _chrono::duration_cast<_chrono::microseconds>(wait_t).count();
+    this->wait_hist->observe(wait_t.count());
+    this->recordStats(wait_t, sync_t, view_t);
     
     // send a sync message
     this->pre_t = _chrono::high_resolution_clock::now();
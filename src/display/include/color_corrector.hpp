@@ -0,0 +1,70 @@
+/******************************************
+*           color_corrector.hpp           *
+*  (corrector of the colors of a panel)   *
+******************************************/
+
+#ifndef COLOR_CORRECTOR_HPP
+#define COLOR_CORRECTOR_HPP
+
+#include "async_logger.hpp"
+#include "view_framebuffer.hpp"
+#include <string>
+#include <vector>
+#include <tuple>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using color_params_t = std::tuple<std::string, std::vector<double>, std::vector<double>, std::vector<double>>;
+
+const int COLOR_LEVEL_NUM = 256;                   // the number of the levels of a channel
+const int COLOR_CURVE_LANES = 16;                  // the number of the pixels mapped through the curves at once with NEON
+const int LUT_SIZE_MIN = 2;                        // the minimum number of the entries of a LUT in each dimension
+const int LUT_3D_SIZE_MAX = 65;                    // the maximum number of the lattice points of a 3D LUT in each dimension
+const int LUT_1D_SIZE_MAX = 65536;                 // the maximum number of the entries of a 1D LUT
+const int LATTICE_VALUE_SHIFT = 4;                 // the fractional bits of the values on the lattice
+const int LATTICE_WEIGHT_ONE = 256;                // the weight of a lattice point at a distance of zero
+const int LATTICE_ENTRY_SIZE = 4;                  // the number of the values of a lattice point (BGR and a padding)
+const int LATTICE_OUTPUT_SHIFT = 12;               // the bits to shift the interpolated values by (the weights and values)
+const std::string CUBE_1D_SIZE = "LUT_1D_SIZE";    // the keyword of the size of a 1D LUT in a .cube file
+const std::string CUBE_3D_SIZE = "LUT_3D_SIZE";    // the keyword of the size of a 3D LUT in a .cube file
+const std::string CUBE_DOMAIN_MIN = "DOMAIN_MIN";  // the keyword of the lower bounds of the inputs in a .cube file
+const std::string CUBE_DOMAIN_MAX = "DOMAIN_MAX";  // the keyword of the upper bounds of the inputs in a .cube file
+
+/* corrector of the colors of a panel (applied while the pages are copied into the framebuffer) */
+class ColorCorrector{
+    private:
+        bool curves_enabled = false;                               // the flag to map the channels through the curves
+        bool lattice_enabled = false;                              // the flag to map the pixels through the 3D LUT
+        unsigned char curves[COLOR_CHANNEL_NUM][COLOR_LEVEL_NUM];  // the curve of each BGR channel
+        std::vector<uint16_t> lattice;                             // the BGR values on the lattice (red varies fastest)
+        int lattice_offsets[COLOR_CHANNEL_NUM][COLOR_LEVEL_NUM];   // the offset of the lower lattice point of each BGR level
+        int lattice_weights[COLOR_CHANNEL_NUM][COLOR_LEVEL_NUM];   // the distance from the lower lattice point of each BGR level
+        int lattice_steps[COLOR_CHANNEL_NUM];                      // the offset to the next lattice point along each BGR axis
+        
+        const bool loadCube(const std::string& lut_file,                  // read a .cube file (the values are in RGB)
+                            int& size, bool& is_3d, std::vector<double>& values);
+        void mapCurvesRow(unsigned char *dst, const unsigned char *src,   // map a row through the curves
+                          const int pixel_num);
+        void mapLatticeRow(unsigned char *dst, const unsigned char *src,  // map a row through the 3D LUT
+                           const int pixel_num);
+    
+    public:
+        ColorCorrector();                                                    // constructor (no correction)
+        const bool load(const color_params_t& params);                       // build the correction of the parameters
+        void setCurves(const std::vector<double>& gain,                      // set the curves of each RGB channel
+                       const std::vector<double>& gamma, const std::vector<double>& offset);
+        void setLattice(const int size, const std::vector<double>& values);  // set a 3D LUT of RGB values in [0, 1]
+        const bool isEnabled();                                              // check if any correction is applied
+        void correctRow(unsigned char *dst, const unsigned char *src,        // copy a row of BGR pixels with the correction
+                        const int pixel_num);
+};
+
+#endif  /* COLOR_CORRECTOR_HPP */
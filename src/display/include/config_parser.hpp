@@ -7,21 +7,29 @@
 #define CONFIG_PARSER_HPP
 
 #include "base_config_parser.hpp"
+#include "color_corrector.hpp"
 
-using dc_params_t = std::tuple<std::string, int, std::string>;
+using dc_params_t = std::tuple<std::string, int, std::string, std::string, std::string, std::string, bool>;
 
 /* parser of display_conf.json */
 class ConfigParser : public BaseConfigParser{
     private:
-        std::string ip;      // the IP address of the head node
-        int port;            // the port number of the head node
-        std::string fb_dev;  // the device file of fbdev
+        std::string ip;          // the IP address of the head node
+        int port;                // the port number of the head node
+        std::string fb_dev;      // the device file of fbdev
+        std::string node_ip;     // the source IP address of this node
+        std::string node_id;     // the node ID sent to the head node (empty to be found by the IP address)
+        std::string stats_file;  // the file to record the elapsed time of each frame
+        bool scaled_decode;      // the flag to decode the late frames at a reduced scale
+        color_params_t color;    // the correction of the colors of the panel
         
         const bool readParams(const _pt::ptree& conf) override;  // read the parameters
+        const bool readColor(const _pt::ptree& conf);            // read the correction of the colors
         
     public:
         ConfigParser(const std::string& conf_file);  // constructor
         const dc_params_t getDisplayClientParams();  // pass the parameters to the display client
+        const color_params_t getColorParams();       // get the correction of the colors
 };
 
 #endif  /* CONFIG_PARSER_HPP */
@@ -11,7 +11,7 @@
 #include "frame_decoder.hpp"
 #include "frame_viewer.hpp"
 
-using init_params_t = std::tuple<int, int, int, int, int, double, int, int, int, int>;
+using init_params_t = std::tuple<int, int, int, int, int, int, int, double, int, int, int>;
 
 /* class for the display client */
 class DisplayClient{
@@ -21,16 +21,24 @@ class DisplayClient{
         _asio::streambuf stream_buf;         // the streambuffer
         std::string ip_addr;                 // the IP address of the head node
         std::string fb_dev;                  // the device file of fbdev
+        std::string node_ip;                 // the source IP address of this node
+        std::string node_id;                 // the node ID sent to the head node
+        std::string hello_msg;               // the hello message identifying this node
+        std::string stats_file;              // the file to record the elapsed time of each frame
+        bool scaled_decode;                  // the flag to decode the late frames at a reduced scale
+        sockopt_params_t sock_params;        // the options of the TCP sockets
+        ColorCorrector color_corrector;      // the corrector of the colors of the panel
         std::thread recv_thre;               // the receiver thread
         std::vector<std::thread> dec_thres;  // the decoder threads
         
         const init_params_t parseInitMsg(const std::string& msg);  // parse the initial message
         void onConnect(const err_t& err);                          // the callback when connecting to the head node
+        void onSendHello(const err_t& err, size_t t_bytes);        // the callback when sending the hello message
         void onRecvInitMsg(const err_t& err, size_t t_bytes);      // the callback when receving the initial message
         void runFrameReceiver(const int stream_port,               // launch the frame receiver
                               const tranbuf_ptr_t recv_buf);
         void runFrameDecoder(const tranbuf_ptr_t recv_buf,         // launch the frame decoder
-                             const viewbuf_ptr_t view_buf);
+                             const viewbuf_ptr_t view_buf, const int target_fps, const int index);
     
     public:
         DisplayClient(_asio::io_service& ios, ConfigParser& parser);  // constructor
@@ -0,0 +1,42 @@
+/*************************************************
+*                edge_blender.hpp                *
+*  (blender of the overlapping projector edges)  *
+*************************************************/
+
+#ifndef EDGE_BLENDER_HPP
+#define EDGE_BLENDER_HPP
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+const double EDGE_BLEND_POWER = 2.0;                  // the power of the ramp (the light of the two projectors sums to one)
+const unsigned char EDGE_BLEND_BLACK[3] = {0, 0, 0};  // the color the strips are faded into
+
+/* blender of the strips overlapping the neighboring projectors (the rest of the page is not touched) */
+class EdgeBlender{
+    private:
+        const int width;                         // the width of the pages
+        const int height;                        // the height of the pages
+        int left = 0;                            // the width of the strip overlapping the left neighbor
+        int right = 0;                           // the width of the strip overlapping the right neighbor
+        int top = 0;                             // the height of the strip overlapping the upper neighbor
+        int bottom = 0;                          // the height of the strip overlapping the lower neighbor
+        std::vector<unsigned char> left_mask;    // the attenuation of each column in the left strip
+        std::vector<unsigned char> right_mask;   // the attenuation of each column in the right strip
+        std::vector<unsigned char> top_mask;     // the attenuation of each pixel in the top strip (with the corners)
+        std::vector<unsigned char> bottom_mask;  // the attenuation of each pixel in the bottom strip (with the corners)
+        
+        const std::vector<double> makeRamp(const int size, const bool rising,  // make the gain of each pixel across a strip
+                                           const double gamma);
+    
+    public:
+        EdgeBlender(const int width, const int height);                  // constructor
+        void setEdges(const int left, const int right, const int top,    // set the strips and make their masks
+                      const int bottom, const double gamma);
+        void clear();                                                    // remove the strips
+        const bool isEmpty();                                            // check if no strip is set
+        void blend(unsigned char *page, const int pitch);                // fade the strips of a page
+};
+
+#endif  /* EDGE_BLENDER_HPP */
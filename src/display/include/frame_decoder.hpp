@@ -6,34 +6,63 @@
 #ifndef FRAME_DECODER_HPP
 #define FRAME_DECODER_HPP
 
-#include "mutex_logger.hpp"
+#include "async_logger.hpp"
+#include "socket_utils.hpp"
 #include "transceive_framebuffer.hpp"
 #include "view_framebuffer.hpp"
+#include "frame_tracer.hpp"
+#include "metrics.hpp"
+#include "tile_codec.hpp"
+#include <vector>
+#include <algorithm>
 extern "C"{
     #include <turbojpeg.h>
 }
 #ifdef DEBUG
 #include "sync_utils.hpp"
 #endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
-const int JPEG_FAILED = -1;    // the return value in failing decoding JPEG
-const int FRAME_ID_INDEX = 0;  // the initial frame index
-const int FRAME_ID_LEN = 1;    // the length of the frame index
+const int JPEG_FAILED = -1;              // the return value in failing decoding JPEG
+const int DECODE_SCALE_AUTO = 0;         // the scale chosen by the deadline of each frame
+const int DECODE_SCALE_FULL = 1;         // the denominator to decode a frame at full scale
+const int DECODE_SCALE_HALF = 2;         // the denominator to decode a frame at 1/2 scale
+const int DECODE_SCALE_QUARTER = 4;      // the denominator to decode a frame at 1/4 scale
+const int UPSCALE_LANES = 16;            // the number of the pixels upscaled at once with NEON
+const double DECODE_COST_WEIGHT = 0.25;  // the weight of the latest full decode in the estimated cost
 
 /* JPEG decoder for video frames */
 class FrameDecoder{
     private:
-        const tjhandle handle;         // the TruboJPEG decoder
-        const tranbuf_ptr_t recv_buf;  // the receive framebuffer
-        const viewbuf_ptr_t view_buf;  // the view framebuffer
+        const tjhandle handle;           // the TruboJPEG decoder
+        const tranbuf_ptr_t recv_buf;    // the receive framebuffer
+        const viewbuf_ptr_t view_buf;             // the view framebuffer
+        const int64_t frame_interval;             // the interval of the frames at the target frame rate [ns]
+        const bool scaled_decode;                 // the flag to decode the late frames at a reduced scale
+        double decode_cost = 0;                   // the estimated time to decode a frame at full scale [ns]
+        std::vector<unsigned char> scaled_frame;  // the frame decoded at a reduced scale
+        std::vector<unsigned char> half_frame;    // the frame decoded at 1/4 scale and upscaled once
+        const hist_ptr_t decode_hist;             // the latency histogram of decoding a frame
+        const counter_ptr_t decode_failures;      // the number of the failed decodes
+        const counter_ptr_t half_decodes;         // the number of the frames decoded at 1/2 scale
+        const counter_ptr_t quarter_decodes;      // the number of the frames decoded at 1/4 scale
         
+        const int chooseScale(const int id);                                   // choose the scale to decode a frame
         void decode(unsigned char *jpeg_frame, const unsigned long jpeg_size,  // decode a frame
-                    const int id);
+                    const int id, const int scale);
+        void upscale(unsigned char *dst, const int dst_pitch,                  // upscale a frame twice in each dimension
+                     const int dst_w, const int dst_h,
+                     const unsigned char *src, const int src_w, const int src_h);
     
     public:
-        FrameDecoder(const tranbuf_ptr_t recv_buf, const viewbuf_ptr_t view_buf);  // constructor
-        ~FrameDecoder();  // destructor
-        void run();       // start decoding JPEG frames
+        FrameDecoder(const tranbuf_ptr_t recv_buf, const viewbuf_ptr_t view_buf,  // constructor
+                     const int target_fps, const bool scaled_decode);
+        ~FrameDecoder();                                                          // destructor
+        void decodeFrame(std::string jpeg_str, const int seq,                     // decode a received JPEG frame into the view framebuffer
+                         const int scale=DECODE_SCALE_AUTO);
+        void run();                                                               // start decoding JPEG frames
 };
 
 #endif  /* FRAME_DECODER_HPP */
@@ -6,25 +6,35 @@
 #ifndef FRAME_RECEIVER_HPP
 #define FRAME_RECEIVER_HPP
 
-#include "mutex_logger.hpp"
+#include "async_logger.hpp"
 #include "socket_utils.hpp"
 #include "transceive_framebuffer.hpp"
+#include "frame_tracer.hpp"
+#include "metrics.hpp"
 
 /* receiver of JPEG frames */
 class FrameReceiver{
     private:
-        _asio::io_service& ios;        // the I/O event loop
-        _ip::tcp::socket sock;         // the TCP socket
-        _asio::streambuf stream_buf;   // the streambuffer
-        const tranbuf_ptr_t recv_buf;  // the receive framebuffer
+        _asio::io_service& ios;          // the I/O event loop
+        _ip::tcp::socket sock;           // the TCP socket
+        _asio::streambuf stream_buf;     // the streambuffer
+        const tranbuf_ptr_t recv_buf;    // the receive framebuffer
+        int frame_seq = 0;               // the sequence number of the next frame
+        const hist_ptr_t recv_hist;      // the latency histogram of taking a received frame
+        const counter_ptr_t recv_bytes;  // the received bytes
+        const std::string hello_msg;     // the hello message identifying this node
         
-        void run(const std::string& ip_addr, const int port);  // start receiving frames
+        void run(const std::string& ip_addr, const int port,   // start receiving frames
+                 const sockopt_params_t& sock_params, const std::string& node_ip);
         void onConnect(const err_t& err);                      // the callback when connected by the head node
+        void onSendHello(const err_t& err, size_t t_bytes);    // the callback when sending the hello message
         void onRecvFrame(const err_t& err, size_t t_bytes);    // the callback when receiving a frame
     
     public:
         FrameReceiver(_asio::io_service& ios, const std::string& ip_addr,  // constructor
-                      const int stream_port, const tranbuf_ptr_t recv_buf);
+                      const int stream_port, const tranbuf_ptr_t recv_buf,
+                      const sockopt_params_t& sock_params, const std::string& node_ip,
+                      const std::string& node_id);
 };
 
 #endif  /* FRAME_RECEIVER_HPP */
@@ -6,14 +6,22 @@
 #ifndef FRAME_VIEWER_HPP
 #define FRAME_VIEWER_HPP
 
-#include "mutex_logger.hpp"
+#include "async_logger.hpp"
 #include "socket_utils.hpp"
 #include "sync_message_generator.hpp"
 #include "view_framebuffer.hpp"
+#include "frame_tracer.hpp"
+#include "metrics.hpp"
+#include "thread_utils.hpp"
+#include "overlay_compositor.hpp"
+#include "color_corrector.hpp"
 #include <cstring>
+#include <fstream>
 extern "C"{
     #include <fcntl.h>
+    #include <unistd.h>
     #include <sys/types.h>
+    #include <sys/stat.h>
     #include <sys/mman.h>
     #include <linux/fb.h>
     #include <linux/kd.h>
@@ -27,29 +35,47 @@ constexpr int DISPLAY_INTERVAL = (int)(1000.0 / MAX_FPS);  // the interval after
 /* viewer of video frames */
 class FrameViewer{
     private:
-        _asio::io_service& ios;           // the I/O event loop
-        _ip::tcp::socket& sock;           // the TCP socket
-        _asio::streambuf stream_buf;      // the streambuffer
-        const viewbuf_ptr_t view_buf;     // the view framebuffer
-        int fb;                           // the device file of fbdev
-        int fb_size;                      // the size of the framebuffer of fbdev
-        unsigned char *fb_ptr;            // the address of the framebuffer of fbdev
-        SyncMessageGenerator& generator;  // the sync message generator
-        const unsigned char *next_frame;  // a next frame
-        hr_clock_t pre_t;                 // the starting time of a tuning term
-        hr_clock_t post_t;                // the end time of a tuning term
+        _asio::io_service& ios;                    // the I/O event loop
+        _ip::tcp::socket& sock;                    // the TCP socket
+        _asio::streambuf stream_buf;               // the streambuffer
+        const viewbuf_ptr_t view_buf;              // the view framebuffer
+        int fb;                                    // the device file of fbdev
+        int fb_size;                               // the size of the framebuffer of fbdev
+        int fb_pitch;                              // the bytes per line of the framebuffer of fbdev
+        int frame_pitch;                           // the bytes per row of the decoded frames
+        int row_size;                              // the bytes copied in each row
+        int row_num;                               // the number of the rows copied in each frame
+        unsigned char *fb_ptr;                     // the address of the framebuffer of fbdev
+        SyncMessageGenerator& generator;           // the sync message generator
+        unsigned char *next_frame;                 // a next frame
+        std::vector<unsigned char> overlay_frame;  // the copy of the next frame the overlays are drawn onto
+        OverlayCompositor overlay;                 // the compositor of the overlays
+        ColorCorrector& color_corrector;           // the corrector of the colors of the panel
+        hr_clock_t pre_t;                          // the starting time of a tuning term
+        hr_clock_t post_t;                         // the end time of a tuning term
+        std::ofstream stats;                       // the file to record the elapsed time of each frame
+        std::string send_msg;                      // the sync message being sent
+        int frame_seq = 0;                         // the sequence number of the frame being displayed
+        const hist_ptr_t wait_hist;                // the latency histogram of waiting for a decoded frame
+        const hist_ptr_t sync_hist;                // the latency histogram of the synchronization process
+        const hist_ptr_t view_hist;                // the latency histogram of displaying a frame
         
-        const bool openFramebuffer(const std::string& fb_dev,  // open the framebuffer of fbdev
+        const bool openFramebuffer(const std::string& fb_dev,      // open the framebuffer of fbdev
                                    const int width, const int height);
-        void displayFrame();                                   // display a frame
-        void sendSync();                                       // send a sync message
-        void onSendSync(const err_t& err, size_t t_bytes);     // the callback when sending a sync message
-        void onRecvSync(const err_t& err, size_t t_bytes);     // the callback when receving a sync message
+        const bool emulateFramebuffer(const std::string& fb_file,  // map a regular file as the framebuffer
+                                      const int width, const int height);
+        void recordStats(const _chrono::nanoseconds& wait_t,       // record the elapsed time of a frame
+                         const _chrono::nanoseconds& sync_t, const _chrono::nanoseconds& view_t);
+        void displayFrame();                                       // display a frame
+        void sendSync();                                           // send a sync message
+        void onSendSync(const err_t& err, size_t t_bytes);         // the callback when sending a sync message
+        void onRecvSync(const err_t& err, size_t t_bytes);         // the callback when receving a sync message
     
     public:
         FrameViewer(_asio::io_service& ios, _ip::tcp::socket& sock,  // constructor
                     const viewbuf_ptr_t view_buf, const std::string& fb_dev,
-                    const int width, const int height, SyncMessageGenerator& generator);
+                    const int width, const int height, SyncMessageGenerator& generator,
+                    ColorCorrector& color_corrector, const std::string& stats_file);
         ~FrameViewer();  // destructor
 };
 
@@ -7,6 +7,8 @@
 #define MAIN_HPP
 
 #include "display_client.hpp"
+#include "metrics_server.hpp"
+#include <memory>
 
 const int ARGUMENT_NUM = 2;    // the number of the command line arguments
 const int ARGUMENT_INDEX = 1;  // the index of the command line arguments
@@ -0,0 +1,82 @@
+/***********************************************
+*           overlay_compositor.hpp            *
+*  (compositor of the overlays on the pages)  *
+***********************************************/
+
+#ifndef OVERLAY_COMPOSITOR_HPP
+#define OVERLAY_COMPOSITOR_HPP
+
+#include "async_logger.hpp"
+#include "json_handler.hpp"
+#include "overlay_message.hpp"
+#include "view_framebuffer.hpp"
+#include "edge_blender.hpp"
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+const int OVERLAY_BLEND_LANES = 8;  // the number of the pixels blended at once with NEON
+
+/* glyph atlas (the alpha of the printable ASCII in cells of a fixed size) */
+struct OverlayAtlas{
+    int cell_w;                        // the width of each glyph
+    int cell_h;                        // the height of each glyph
+    std::vector<unsigned char> alpha;  // the alpha of the glyphs side by side
+};
+
+/* sprite of BGRA pixels */
+struct OverlaySprite{
+    int width;                          // the width
+    int height;                         // the height
+    std::vector<unsigned char> pixels;  // the BGRA pixels
+};
+
+/* overlay placed on the page */
+struct OverlayLayer{
+    bool text;               // the flag to draw a text (a sprite if false)
+    int resource;            // the ID of the glyph atlas or the sprite
+    int x;                   // the left of the overlay in the page
+    int y;                   // the top of the overlay in the page
+    std::string str;         // the text
+    unsigned char color[3];  // the BGR color of the text
+    int clip_w;              // the width the text is scrolled in (0 not to scroll)
+    int speed;               // the pixels the text is scrolled by in each frame
+    int offset;              // the pixels the text has been scrolled by
+};
+
+/* compositor of the overlays on the pages (the commands come with the sync messages) */
+class OverlayCompositor{
+    private:
+        const int width;                       // the width of the pages
+        const int height;                      // the height of the pages
+        std::map<int, OverlayAtlas> atlases;   // the glyph atlases keyed by their IDs
+        std::map<int, OverlaySprite> sprites;  // the sprites keyed by their IDs
+        std::map<int, OverlayLayer> layers;    // the overlays in order of drawing
+        EdgeBlender edges;                     // the blender of the strips overlapping the neighboring projectors
+        
+        void storeAtlas(JsonHandler& cmd);                                          // store a glyph atlas
+        void storeSprite(JsonHandler& cmd);                                         // store a sprite
+        void placeText(JsonHandler& cmd);                                           // place a text
+        void placeImage(JsonHandler& cmd);                                          // place a sprite
+        void setEdges(JsonHandler& cmd);                                            // set the strips to blend
+        void blendText(OverlayLayer& layer, unsigned char *page, const int pitch);  // draw a text onto a page
+        void blendImage(const OverlayLayer& layer, unsigned char *page,             // draw a sprite onto a page
+                        const int pitch);
+    
+    public:
+        OverlayCompositor(const int width, const int height);  // constructor
+        void apply(const std::string& cmd_str);                // apply an overlay command
+        void blend(unsigned char *page, const int pitch);      // draw the overlays onto a page and blend its edges
+        const bool isEmpty();                                  // check if no overlay is placed and no strip is set
+};
+
+void blendMaskRow(unsigned char *dst, const unsigned char *alpha,  // blend a color through an alpha row
+                  const int pixel_num, const unsigned char *color);
+void blendSpriteRow(unsigned char *dst, const unsigned char *src,  // blend a row of BGRA pixels
+                    const int pixel_num);
+
+#endif  /* OVERLAY_COMPOSITOR_HPP */
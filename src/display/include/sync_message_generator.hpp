@@ -33,6 +33,7 @@ class SyncMessageGenerator{
         double wait_t_sum = 0.0;         // the elapsed time in decoding a frame
         double sync_t_sum = 0.0;         // the elapsed time in the synchronization process
         double view_t_sum = 0.0;         // the elapsed time in displaying a frame
+        int last_wait_t = 0;             // the elapsed time in waiting for the last frame [us]
         
         SyncMessageGenerator(const int target_fps, const double fps_jitter,  // constructor
                              const int tuning_term, const tranbuf_ptr_t recv_buf,
@@ -7,6 +7,7 @@
 #define VIEW_FRAMEBUFFER_HPP
 
 #include "sync_utils.hpp"
+#include "frame_memory.hpp"
 #include <memory>
 #include <thread>
 
@@ -17,17 +18,22 @@ const int VIEWBUF_SPINLOCK_INTERVAL = 1;  // the interval in the spinlock
 class ViewFramebuffer{
     private:
         const int page_num;                         // the number of domains in the buffer
+        const int pitch;                            // the bytes per row of each domain (padded to the alignment)
+        const int height;                           // the number of the rows of each domain
+        framemem_ptr_t memory;                      // the memory of all the domains
         std::vector<unsigned char*> page_ptrs;      // the pointers of domains in the buffer
         std::vector<std::atomic_bool> page_states;  // the flags to switch the state of each domain
-        int cur_page = 0;                           // the domain on which the next frame is put
+        std::atomic_int cur_page{0};                // the domain on which the next frame is put
     
     public:
         ViewFramebuffer(const int width, const int height,  // constructor
                         const int page_num);
-        ~ViewFramebuffer();                                 // destructor
         unsigned char *getDrawPage(const int id);           // get a domain to put a new frame
-        const unsigned char *getDisplayPage();              // get a domain to display the next frame
+        const int getPitch();                               // get the bytes per row of each domain
+        const int getHeight();                              // get the number of the rows of each domain
+        unsigned char *getDisplayPage();                    // get a domain to display the next frame
         const int getCurrentPage();                         // get the value of cur_page
+        const int getLeadNum(const int id);                 // get the number of the domains displayed before a domain
         void activatePage(const int id);                    // make a domain displayable
         void deactivatePage();                              // make a domain undisplayable
 };
@@ -13,6 +13,20 @@ int main(int argc, char *argv[]){
         std::exit(EXIT_FAILURE);
     }
     ConfigParser parser(argv[ARGUMENT_INDEX]);
+    _ml::init(parser.getLogParams());
+    std::string node_name = std::get<5>(parser.getDisplayClientParams());
+    if(node_name.empty()){
+        node_name = std::get<3>(parser.getDisplayClientParams());
+    }
+    _ft::init(parser.getTraceParams(), node_name.empty() ? "display" : "display " + node_name);
+    initThreadPlacement(parser.getThreadParams(), {THREAD_ROLE_RECEIVER}, THREAD_ROLE_DECODER);
+    
+    // serve the metrics (disabled with port 0)
+    std::unique_ptr<MetricsServer> metrics_server;
+    const metrics_params_t metrics_params = parser.getMetricsParams();
+    if(std::get<1>(metrics_params) != METRICS_PORT_DISABLED){
+        metrics_server.reset(new MetricsServer(metrics_params));
+    }
     
     // launch the display client
     _asio::io_service ios;
@@ -0,0 +1,270 @@
+/***********************************************
+*           overlay_compositor.cpp            *
+*  (compositor of the overlays on the pages)  *
+***********************************************/
+
+#include "overlay_compositor.hpp"
+
+static inline const unsigned char blendPixel(const int dst, const int src, const int alpha);  // blend a channel of a pixel
+#if defined(__ARM_NEON)
+static inline uint8x8_t blendLanes(const uint8x8_t dst, const uint8x8_t src,                  // blend a channel of 8 pixels
+                                   const uint8x8_t alpha);
+#endif
+
+/* blend a channel of a pixel (divided by 255 exactly without a division) */
+static inline const unsigned char blendPixel(const int dst, const int src, const int alpha){
+    const int sum = dst*(255-alpha) + src*alpha + 128;
+    return (unsigned char)((sum + (sum>>8)) >> 8);
+}
+
+#if defined(__ARM_NEON)
+/* blend a channel of 8 pixels (in the same way as blendPixel()) */
+static inline uint8x8_t blendLanes(const uint8x8_t dst, const uint8x8_t src, const uint8x8_t alpha){
+    uint16x8_t sum = vmull_u8(dst, vmvn_u8(alpha));
+    sum = vmlal_u8(sum, src, alpha);
+    sum = vaddq_u16(sum, vdupq_n_u16(128));
+    return vaddhn_u16(sum, vshrq_n_u16(sum, 8));
+}
+#endif
+
+/* blend a color through a row of alpha (e.g. a row of a glyph) */
+void blendMaskRow(unsigned char *dst, const unsigned char *alpha, const int pixel_num, const unsigned char *color){
+    int i = 0;
+#if defined(__ARM_NEON)
+    const uint8x8_t blue = vdup_n_u8(color[0]);
+    const uint8x8_t green = vdup_n_u8(color[1]);
+    const uint8x8_t red = vdup_n_u8(color[2]);
+    for(; i+OVERLAY_BLEND_LANES<=pixel_num; i+=OVERLAY_BLEND_LANES){
+        const uint8x8_t lane_alpha = vld1_u8(alpha+i);
+        uint8x8x3_t pixels = vld3_u8(dst+i*COLOR_CHANNEL_NUM);
+        pixels.val[0] = blendLanes(pixels.val[0], blue, lane_alpha);
+        pixels.val[1] = blendLanes(pixels.val[1], green, lane_alpha);
+        pixels.val[2] = blendLanes(pixels.val[2], red, lane_alpha);
+        vst3_u8(dst+i*COLOR_CHANNEL_NUM, pixels);
+    }
+#endif
+    for(; i<pixel_num; ++i){
+        if(alpha[i] == 0){
+            continue;
+        }
+        unsigned char *pixel = dst + i*COLOR_CHANNEL_NUM;
+        for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+            pixel[c] = blendPixel(pixel[c], color[c], alpha[i]);
+        }
+    }
+}
+
+/* blend a row of BGRA pixels (e.g. a row of a sprite) */
+void blendSpriteRow(unsigned char *dst, const unsigned char *src, const int pixel_num){
+    int i = 0;
+#if defined(__ARM_NEON)
+    for(; i+OVERLAY_BLEND_LANES<=pixel_num; i+=OVERLAY_BLEND_LANES){
+        const uint8x8x4_t sprite = vld4_u8(src+i*OVERLAY_SPRITE_CHANNEL_NUM);
+        uint8x8x3_t pixels = vld3_u8(dst+i*COLOR_CHANNEL_NUM);
+        pixels.val[0] = blendLanes(pixels.val[0], sprite.val[0], sprite.val[3]);
+        pixels.val[1] = blendLanes(pixels.val[1], sprite.val[1], sprite.val[3]);
+        pixels.val[2] = blendLanes(pixels.val[2], sprite.val[2], sprite.val[3]);
+        vst3_u8(dst+i*COLOR_CHANNEL_NUM, pixels);
+    }
+#endif
+    for(; i<pixel_num; ++i){
+        const unsigned char *sprite = src + i*OVERLAY_SPRITE_CHANNEL_NUM;
+        if(sprite[3] == 0){
+            continue;
+        }
+        unsigned char *pixel = dst + i*COLOR_CHANNEL_NUM;
+        for(int c=0; c<COLOR_CHANNEL_NUM; ++c){
+            pixel[c] = blendPixel(pixel[c], sprite[c], sprite[3]);
+        }
+    }
+}
+
+/* constructor */
+OverlayCompositor::OverlayCompositor(const int width, const int height):
+    width(width),
+    height(height),
+    edges(width, height)
+{}
+
+/* apply an overlay command (an invalid command is ignored with a warning) */
+void OverlayCompositor::apply(const std::string& cmd_str){
+    JsonHandler cmd;
+    std::string type;
+    try{
+        cmd.deserialize(cmd_str);
+        if(!cmd.hasParam("cmd")){
+            throw std::invalid_argument("no command");
+        }
+        type = cmd.getStringParam("cmd");
+        if(type == OVERLAY_RESET){
+            this->atlases.clear();
+            this->sprites.clear();
+            this->layers.clear();
+            this->edges.clear();
+        }else if(type == OVERLAY_ATLAS){
+            this->storeAtlas(cmd);
+        }else if(type == OVERLAY_SPRITE){
+            this->storeSprite(cmd);
+        }else if(type == OVERLAY_TEXT){
+            this->placeText(cmd);
+        }else if(type == OVERLAY_IMAGE){
+            this->placeImage(cmd);
+        }else if(type == OVERLAY_BLEND){
+            this->setEdges(cmd);
+        }else if(type == OVERLAY_CLEAR){
+            this->layers.erase(cmd.getIntParam("layer"));
+        }else{
+            _ml::warn("Overlay command is unknown", type);
+        }
+    }catch(...){
+        _ml::warn("Overlay command is invalid", type);
+    }
+}
+
+/* store a glyph atlas */
+void OverlayCompositor::storeAtlas(JsonHandler& cmd){
+    OverlayAtlas atlas;
+    atlas.cell_w = cmd.getIntParam("cell_width");
+    atlas.cell_h = cmd.getIntParam("cell_height");
+    if(!decodeBase64(cmd.getStringParam("data"), atlas.alpha)
+       || atlas.alpha.size() != (size_t)atlas.cell_w*atlas.cell_h*OVERLAY_GLYPH_NUM){
+        _ml::warn("Glyph atlas is broken", std::to_string(atlas.alpha.size()) + " bytes");
+        return;
+    }
+    this->atlases[cmd.getIntParam("id")] = std::move(atlas);
+}
+
+/* store a sprite */
+void OverlayCompositor::storeSprite(JsonHandler& cmd){
+    OverlaySprite sprite;
+    sprite.width = cmd.getIntParam("width");
+    sprite.height = cmd.getIntParam("height");
+    if(!decodeBase64(cmd.getStringParam("data"), sprite.pixels)
+       || sprite.pixels.size() != (size_t)sprite.width*sprite.height*OVERLAY_SPRITE_CHANNEL_NUM){
+        _ml::warn("Sprite is broken", std::to_string(sprite.pixels.size()) + " bytes");
+        return;
+    }
+    this->sprites[cmd.getIntParam("id")] = std::move(sprite);
+}
+
+/* place a text (replacing the overlay of the same ID) */
+void OverlayCompositor::placeText(JsonHandler& cmd){
+    OverlayLayer layer;
+    layer.text = true;
+    layer.resource = cmd.getIntParam("atlas");
+    layer.x = cmd.getIntParam("x");
+    layer.y = cmd.getIntParam("y");
+    layer.str = cmd.getStringParam("text");
+    layer.color[0] = (unsigned char)cmd.getIntParam("b");
+    layer.color[1] = (unsigned char)cmd.getIntParam("g");
+    layer.color[2] = (unsigned char)cmd.getIntParam("r");
+    layer.clip_w = cmd.getIntParam("clip_width");
+    layer.speed = cmd.getIntParam("speed");
+    layer.offset = cmd.getIntParam("offset");
+    this->layers[cmd.getIntParam("layer")] = layer;
+}
+
+/* place a sprite (replacing the overlay of the same ID) */
+void OverlayCompositor::placeImage(JsonHandler& cmd){
+    OverlayLayer layer;
+    layer.text = false;
+    layer.resource = cmd.getIntParam("sprite");
+    layer.x = cmd.getIntParam("x");
+    layer.y = cmd.getIntParam("y");
+    this->layers[cmd.getIntParam("layer")] = layer;
+}
+
+/* set the strips to blend (in the pixels of this display) */
+void OverlayCompositor::setEdges(JsonHandler& cmd){
+    const double gamma = cmd.getDoubleParam("gamma");
+    if(gamma <= 0){
+        _ml::warn("Blend gamma is invalid", std::to_string(gamma));
+        return;
+    }
+    this->edges.setEdges(cmd.getIntParam("left"), cmd.getIntParam("right"),
+                         cmd.getIntParam("top"), cmd.getIntParam("bottom"), gamma);
+}
+
+/* draw a text onto a page (only the cells of the glyphs are blended, and a scrolled text advances) */
+void OverlayCompositor::blendText(OverlayLayer& layer, unsigned char *page, const int pitch){
+    const auto atlas_it = this->atlases.find(layer.resource);
+    if(atlas_it == this->atlases.end()){
+        return;
+    }
+    const OverlayAtlas& atlas = atlas_it->second;
+    const int atlas_w = atlas.cell_w * OVERLAY_GLYPH_NUM;
+    const int text_w = atlas.cell_w * (int)layer.str.length();
+    
+    // a scrolled text enters from the right of its area and wraps after leaving from the left
+    int clip_l = 0;
+    int clip_r = this->width;
+    int pen_x = layer.x;
+    if(layer.clip_w > 0){
+        clip_l = std::max(layer.x, 0);
+        clip_r = std::min(layer.x+layer.clip_w, this->width);
+        pen_x = layer.x + layer.clip_w - layer.offset;
+        layer.offset = (layer.offset+layer.speed) % (layer.clip_w+text_w);
+    }
+    const int top = std::max(layer.y, 0);
+    const int bottom = std::min(layer.y+atlas.cell_h, this->height);
+    
+    for(int k=0; k<(int)layer.str.length(); ++k){
+        // the spaces and the characters out of the atlas are not drawn
+        const int glyph = (unsigned char)layer.str[k] - OVERLAY_GLYPH_FIRST;
+        if(glyph <= 0 || glyph >= OVERLAY_GLYPH_NUM){
+            continue;
+        }
+        const int glyph_x = pen_x + atlas.cell_w*k;
+        const int left = std::max(glyph_x, clip_l);
+        const int right = std::min(glyph_x+atlas.cell_w, clip_r);
+        if(left >= right){
+            continue;
+        }
+        for(int j=top; j<bottom; ++j){
+            blendMaskRow(page + (size_t)pitch*j + left*COLOR_CHANNEL_NUM,
+                         atlas.alpha.data() + (size_t)atlas_w*(j-layer.y) + atlas.cell_w*glyph + (left-glyph_x),
+                         right-left,
+                         layer.color
+            );
+        }
+    }
+}
+
+/* draw a sprite onto a page (clipped to the page) */
+void OverlayCompositor::blendImage(const OverlayLayer& layer, unsigned char *page, const int pitch){
+    const auto sprite_it = this->sprites.find(layer.resource);
+    if(sprite_it == this->sprites.end()){
+        return;
+    }
+    const OverlaySprite& sprite = sprite_it->second;
+    const int left = std::max(layer.x, 0);
+    const int right = std::min(layer.x+sprite.width, this->width);
+    const int top = std::max(layer.y, 0);
+    const int bottom = std::min(layer.y+sprite.height, this->height);
+    if(left >= right){
+        return;
+    }
+    for(int j=top; j<bottom; ++j){
+        blendSpriteRow(page + (size_t)pitch*j + left*COLOR_CHANNEL_NUM,
+                       sprite.pixels.data() + ((size_t)sprite.width*(j-layer.y) + (left-layer.x))*OVERLAY_SPRITE_CHANNEL_NUM,
+                       right-left
+        );
+    }
+}
+
+/* draw the overlays onto a page (in order of their IDs) and blend its edges (so the overlays are faded with the page) */
+void OverlayCompositor::blend(unsigned char *page, const int pitch){
+    for(auto& layer : this->layers){
+        if(layer.second.text){
+            this->blendText(layer.second, page, pitch);
+        }else{
+            this->blendImage(layer.second, page, pitch);
+        }
+    }
+    this->edges.blend(page, pitch);
+}
+
+/* check if no overlay is placed and no strip is set (nothing is drawn onto a page) */
+const bool OverlayCompositor::isEmpty(){
+    return this->layers.empty() && this->edges.isEmpty();
+}
@@ -110,6 +110,10 @@ const std::string SyncMessageGenerator::generate(){
     // serialize the sync message
     this->sync_params.setIntParam("param", param_flag);
     this->sync_params.setIntParam("change", change_flag);
+    
+    // pack the statistics exported by the head
+    this->sync_params.setIntParam("wait_us", this->last_wait_t);
+    this->sync_params.setIntParam("recv_depth", this->recv_buf->getStoredNum());
     return this->sync_params.serialize();
 }
 
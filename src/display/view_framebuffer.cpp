@@ -5,34 +5,40 @@
 
 #include "view_framebuffer.hpp"
 
-/* constructor (allocate the buffer) */
+/* constructor (allocate the buffer in a block of frame memory, so the first frames do not fault in the pages) */
 ViewFramebuffer::ViewFramebuffer(const int width, const int height, const int page_num):
     page_num(page_num),
+    pitch(alignRow(width*COLOR_CHANNEL_NUM)),
+    height(height),
     page_ptrs(page_num),
     page_states(page_num)
 {
-    const int frame_size = width * height * COLOR_CHANNEL_NUM;
+    const size_t frame_size = (size_t)this->pitch * height;
+    this->memory = std::make_shared<FrameMemory>(frame_size*page_num);
     for(int i=0; i<this->page_num; ++i){
-        this->page_ptrs[i] = new unsigned char[frame_size];
+        this->page_ptrs[i] = this->memory->getData() + frame_size*i;
         this->page_states[i].store(false, std::memory_order_release);
     }
 }
 
-/* destructor (release the buffer) */
-ViewFramebuffer::~ViewFramebuffer(){
-    for(int i=0; i<this->page_num; ++i){
-        delete[] this->page_ptrs[i];
-    }
-}
-
 /* get a domain to put a new frame */
 unsigned char *ViewFramebuffer::getDrawPage(const int id){
     while(this->page_states[id].load(std::memory_order_acquire));
     return this->page_ptrs[id];
 }
 
-/* get a domain on which the next frame is put */
-const unsigned char *ViewFramebuffer::getDisplayPage(){
+/* get the bytes per row of each domain */
+const int ViewFramebuffer::getPitch(){
+    return this->pitch;
+}
+
+/* get the number of the rows of each domain */
+const int ViewFramebuffer::getHeight(){
+    return this->height;
+}
+
+/* get a domain on which the next frame is put (the viewer may draw the overlays on it) */
+unsigned char *ViewFramebuffer::getDisplayPage(){
     while(!this->page_states[this->cur_page].load(std::memory_order_acquire)){
         std::this_thread::sleep_for(_chrono::nanoseconds(VIEWBUF_SPINLOCK_INTERVAL));
     }
@@ -44,6 +50,15 @@ const int ViewFramebuffer::getCurrentPage(){
     return this->cur_page;
 }
 
+/* get the number of the domains displayed before a domain (zero if the viewer is waiting for it, and all of them if it is still displayable from the previous lap) */
+const int ViewFramebuffer::getLeadNum(const int id){
+    if(this->page_states[id].load(std::memory_order_acquire)){
+        return this->page_num;
+    }
+    const int cur_page = this->cur_page.load(std::memory_order_acquire);
+    return (id-cur_page+this->page_num) % this->page_num;
+}
+
 /* make a domain displayable to the frame viewer */
 void ViewFramebuffer::activatePage(const int id){
     this->page_states[id].store(true, std::memory_order_release);
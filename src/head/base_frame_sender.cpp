@@ -0,0 +1,178 @@
+/****************************************
+*         base_frame_sender.cpp         *
+*  (super class of JPEG frame senders)  *
+****************************************/
+
+#include "base_frame_sender.hpp"
+
+/* constructor */
+BaseFrameSender::BaseFrameSender(const int display_num, const conn_list_t& conns,
+                                 std::vector<tranbuf_ptr_t>& send_bufs, const int viewbuf_num,
+                                 const container_ptr_t container, const sockopt_params_t& sock_params,
+                                 ConnectionTable& table):
+    display_num(display_num),
+    conns(conns),
+    conn_num(conns.size()),
+    viewbuf_num(viewbuf_num),
+    send_msgs(display_num),
+    jpeg_bufs(display_num),
+    tile_sizes(display_num),
+    send_seqs(conns.size()),
+    send_bufs(send_bufs),
+    container(container),
+    sock_params(sock_params),
+    tcp_cork(std::get<1>(sock_params)),
+    table(table),
+    live_gens(conns.size(), CONN_NO_GEN),
+    pending_gens(conns.size(), CONN_NO_GEN)
+{
+    // register the metrics of the connections
+    for(const conn_params_t& conn : conns){
+        const std::string& ip_addr = std::get<0>(conn);
+        this->send_hists.push_back(_mt::addStageHistogram(TRACE_STAGE_NAMES[TRACE_SEND], {{"conn", ip_addr}}));
+        this->sent_bytes.push_back(
+            _mt::addCounter("tdw_sent_bytes_total", "Bytes sent to each connection", _mt::labels({{"conn", ip_addr}}))
+        );
+    }
+    this->sent_frames = _mt::addCounter("tdw_frames_sent_total", "Number of the frames sent to all the connections", "");
+    this->table.addDropCallback(std::bind(&BaseFrameSender::onDrop, this, std::placeholders::_1));
+}
+
+/* register an accepted stream connection (call with the lock, and false if the node has not joined) */
+const bool BaseFrameSender::addStream(const int id){
+    const int gen = this->table.getGeneration(id);
+    if(this->table.getState(id, gen) != CONN_JOINING){
+        return false;
+    }
+    if(this->pending_gens[id] != CONN_NO_GEN){
+        this->releaseSocket(id, true);
+    }
+    this->pending_gens[id] = gen;
+    return true;
+}
+
+/* release the dropped connections and admit the new ones (call with the lock at a frame boundary) */
+void BaseFrameSender::updateStreams(){
+    bool live = false;
+    for(int i=0; i<this->conn_num; ++i){
+        if(this->live_gens[i] == CONN_NO_GEN){
+            continue;
+        }
+        if(this->table.getState(i, this->live_gens[i]) != CONN_LIVE){
+            this->releaseSocket(i, false);
+            this->live_gens[i] = CONN_NO_GEN;
+        }else{
+            live = true;
+        }
+    }
+    
+    // admit the new connections at the start of the view framebuffer (restarted if no connection is live)
+    if(!live){
+        this->fb_id = 0;
+    }
+    if(this->fb_id == 0){
+        for(int i=0; i<this->conn_num; ++i){
+            if(this->pending_gens[i] == CONN_NO_GEN){
+                continue;
+            }
+            if(this->table.admit(i, this->pending_gens[i], this->frame_seq+1)){
+                if(this->live_gens[i] != CONN_NO_GEN){
+                    this->releaseSocket(i, false);
+                }
+                this->admitSocket(i);
+                this->live_gens[i] = this->pending_gens[i];
+                _ml::notice("Connection with " + std::get<0>(this->conns[i]) + " joined at frame " + std::to_string(this->frame_seq+1));
+            }else{
+                this->releaseSocket(i, true);
+            }
+            this->pending_gens[i] = CONN_NO_GEN;
+        }
+    }
+    
+    this->frame_conns.clear();
+    for(int i=0; i<this->conn_num; ++i){
+        if(this->live_gens[i] != CONN_NO_GEN){
+            this->frame_conns.push_back(i);
+        }
+    }
+    this->idle = this->frame_conns.empty();
+}
+
+/* drop a live connection failing to send a frame */
+void BaseFrameSender::dropStream(const int id, const std::string& reason){
+    this->table.drop(id, this->live_gens[id], reason);
+}
+
+/* the callback when a connection is dropped (a pending write on the socket is aborted) */
+void BaseFrameSender::onDrop(const int id){
+    std::lock_guard<std::mutex> lock(this->conn_lock);
+    if(this->live_gens[id] != CONN_NO_GEN && this->table.getState(id, this->live_gens[id]) == CONN_DOWN){
+        this->shutdownSocket(id, false);
+    }
+    if(this->pending_gens[id] != CONN_NO_GEN && this->table.getState(id, this->pending_gens[id]) == CONN_DOWN){
+        this->shutdownSocket(id, true);
+    }
+}
+
+/* prepare the JPEG frames to be sent next (false if no connection is live) */
+const bool BaseFrameSender::prepareFrame(){
+    {
+        std::lock_guard<std::mutex> lock(this->conn_lock);
+        this->updateStreams();
+        if(this->idle){
+            return false;
+        }
+    }
+    
+    // refer to the JPEG frames without copying
+    ++this->frame_seq;
+    this->send_head = std::to_string(this->fb_id);
+    if(this->container){
+        // refer to the JPEG tiles mapped from the tile container
+        for(int i=0; i<this->display_num; ++i){
+            size_t tile_size;
+            const unsigned char *tile = this->container->getTile(this->container_frame, i, tile_size);
+            this->jpeg_bufs[i] = _asio::buffer(tile, tile_size);
+        }
+        this->container_frame = (this->container_frame+1) % this->container->getFrameNum();
+    }else{
+        // refer to the JPEG frames moved out of the send framebuffer
+        for(int i=0; i<this->display_num; ++i){
+            this->send_msgs[i] = this->send_bufs[i]->pop();
+            this->jpeg_bufs[i] = _asio::buffer(this->send_msgs[i]);
+        }
+    }
+    
+    // gather the send message of each connection (the JPEG frames for a relay node are bundled)
+    for(const int i : this->frame_conns){
+        std::vector<_asio::const_buffer>& send_seq = this->send_seqs[i];
+        const bool relay = std::get<2>(this->conns[i]);
+        send_seq.clear();
+        send_seq.push_back(_asio::buffer(this->send_head));
+        for(const int id : std::get<1>(this->conns[i])){
+            if(relay){
+                this->tile_sizes[id] = this->formatTileSize(_asio::buffer_size(this->jpeg_bufs[id]));
+                send_seq.push_back(_asio::buffer(this->tile_sizes[id]));
+            }
+            send_seq.push_back(this->jpeg_bufs[id]);
+        }
+        send_seq.push_back(_asio::buffer(MSG_DELIMITER));
+    }
+    this->send_t = _ft::now();
+    this->fb_id = (this->fb_id+1) % this->viewbuf_num;
+    return true;
+}
+
+/* record a completed send message */
+void BaseFrameSender::recordSent(const int id){
+    _ft::record(TRACE_SEND, this->frame_seq, id, this->send_t);
+    this->send_hists[id]->observe(_ft::now()-this->send_t);
+    this->sent_bytes[id]->add(_asio::buffer_size(this->send_seqs[id]));
+}
+
+/* format the size field of a JPEG frame (zero-padded to the fixed length) */
+const std::string BaseFrameSender::formatTileSize(const size_t size){
+    std::string size_field = std::to_string(size);
+    size_field.insert(0, TILE_SIZE_LEN-size_field.length(), '0');
+    return size_field;
+}
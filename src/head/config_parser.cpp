@@ -16,32 +16,166 @@ ConfigParser::ConfigParser(const std::string& conf_file):
 
 /* read the parameters in JSON */
 const bool ConfigParser::readParams(const _pt::ptree& conf){
-    std::string sampling_name;
+    std::string ycbcr_format_name;
     try{
         this->src = this->getStrParam("video.src");
+        this->src_type = this->getStrParam("video.source_type", SOURCE_VIDEO);
+        this->src_width = this->getIntParam("video.source_width", 0);
+        this->src_height = this->getIntParam("video.source_height", 0);
+        this->src_fps = this->getIntParam("video.source_fps", SOURCE_UNPACED);
+        this->media_clock = this->getBoolParam("video.media_clock", true);
         this->target_fps = this->getIntParam("video.framerate");
         this->fps_jitter = this->getDoubleParam("video.framerate_jitter");
         this->column = this->getIntParam("layout.column");
         this->row = this->getIntParam("layout.row");
         this->bezel_w = this->getIntParam("layout.bezel_width");
         this->bezel_h = this->getIntParam("layout.bezel_height");
+        this->blend_gamma = conf.get<double>("layout.blend_gamma", BLEND_GAMMA_DEFAULT);
         this->width = this->getIntParam("resolution.width");
         this->height = this->getIntParam("resolution.height");
         this->fs_port = this->getIntParam("port.frontend_server");
         this->stream_port = this->getIntParam("port.frame_streamer");
         this->sendbuf_num = this->getIntParam("buffer.sender_capacity");
         this->recvbuf_num = this->getIntParam("buffer.receiver_capacity");
-        this->ycbcr_format = this->getStrParam("compression.init_ycbcr_format");
+        ycbcr_format_name = this->getStrParam("compression.init_ycbcr_format");
         this->quality = this->getIntParam("compression.init_quality");
         this->dec_thre_num = this->getIntParam("compression.decoder_num");
         this->tuning_term = this->getIntParam("compression.tuning_term");
+        this->tile_codec = this->getStrParam("compression.tile_codec", TILE_CODEC_AUTO);
+        this->backend = this->getStrParam("transport.backend", TRANSPORT_ASIO);
+        this->io_thre_num = this->getIntParam("transport.io_threads", 1);
+        this->pin_io_thres = this->getBoolParam("transport.pin_io_threads", false);
+        this->sync_timeout = this->getIntParam("sync.timeout", SYNC_TIMEOUT_DEFAULT);
     }catch(...){
         _ml::caution("Could not get parameter", "Config file is invalid");
         return false;
     }
     
+    // check the type of the video source
+    if(this->src_type != SOURCE_VIDEO && this->src_type != SOURCE_TILE_CONTAINER && this->src_type != SOURCE_SYNTHETIC
+       && this->src_type != SOURCE_SHM && this->src_type != SOURCE_V4L2 && this->src_type != SOURCE_PLAYLIST){
+        _ml::caution("Source type is invalid", this->src_type);
+        return false;
+    }
+    
+    // check the transport backend
+    if(this->backend != TRANSPORT_ASIO && this->backend != TRANSPORT_IO_URING){
+        _ml::caution("Transport backend is invalid", this->backend);
+        return false;
+    }
+    
+    // check the codec of the tiles
+    if(this->tile_codec != TILE_CODEC_JPEG && this->tile_codec != TILE_CODEC_AUTO){
+        _ml::caution("Tile codec is invalid", this->tile_codec);
+        return false;
+    }
+    
+    // a negative bezel overlaps the neighbors (the strips on both sides of a display must not meet)
+    if(-this->bezel_w*4 > this->width || -this->bezel_h*4 > this->height){
+        _ml::caution("Overlap of displays is too wide",
+                     std::to_string(this->bezel_w) + "x" + std::to_string(this->bezel_h) + " bezels");
+        return false;
+    }
+    if(this->blend_gamma <= 0){
+        _ml::caution("Blend gamma is invalid", std::to_string(this->blend_gamma));
+        return false;
+    }
+    
+    if(this->sendbuf_num < 1 || this->sendbuf_num > SENDBUF_NUM_MAX){
+        _ml::caution("Capacity of send framebuffer is invalid", std::to_string(this->sendbuf_num));
+        return false;
+    }
+    
+    if(this->sync_timeout < 0){
+        _ml::caution("Sync timeout is invalid", std::to_string(this->sync_timeout));
+        return false;
+    }
+    
+    if(this->io_thre_num < 1){
+        _ml::caution("Number of I/O threads is invalid", std::to_string(this->io_thre_num));
+        return false;
+    }
+    
+    // set the initial YCbCr format
+    if(ycbcr_format_name == "4:4:4"){
+        this->ycbcr_format = TJSAMP_444;
+    }else if(ycbcr_format_name == "4:2:2"){
+        this->ycbcr_format = TJSAMP_422;
+    }else if(ycbcr_format_name == "4:2:0"){
+        this->ycbcr_format = TJSAMP_420;
+    }else{
+        _ml::caution("YCbCr format is invalid", "Check config file");
+        return false;
+    }
+    
+    return this->readDisplayNodes(conf) && this->readRelayNodes(conf) && this->readWindows(conf) && this->readOverlays(conf);
+}
+
+/* read the config file again (the current parameters are kept if the file is invalid) */
+const bool ConfigParser::reload(){
+    ConfigParser parser(*this);
+    parser.ip_addrs.clear();
+    parser.nodes.clear();
+    parser.conns.clear();
+    parser.windows.clear();
+    parser.overlays.clear();
+    if(!parser.readFile() || !parser.readParams(parser.conf)){
+        return false;
+    }
+    *this = parser;
+    return true;
+}
+
+/* read the display nodes (an IP address, or an object with the IP address or the node ID and the settings of its hardware) */
+const bool ConfigParser::readDisplayNodes(const _pt::ptree& conf){
     for(const auto& elem : conf.get_child("display_node")){
-        this->ip_addrs.push_back(elem.second.data());
+        if(elem.second.empty()){
+            this->ip_addrs.push_back(elem.second.data());
+            this->nodes.push_back(std::forward_as_tuple(
+                this->width, this->height, ROTATION_NONE, this->dec_thre_num, this->recvbuf_num, this->quality
+            ));
+            continue;
+        }
+        std::string ip_addr;
+        int width, height, rotation, dec_thre_num, recvbuf_num, quality;
+        try{
+            ip_addr = elem.second.get<std::string>("node_id", "");
+            if(ip_addr.empty()){
+                ip_addr = elem.second.get<std::string>("ip");
+            }
+            width = elem.second.get<int>("width", this->width);
+            height = elem.second.get<int>("height", this->height);
+            rotation = elem.second.get<int>("rotation", ROTATION_NONE);
+            dec_thre_num = elem.second.get<int>("decoder_num", this->dec_thre_num);
+            recvbuf_num = elem.second.get<int>("receiver_capacity", this->recvbuf_num);
+            quality = elem.second.get<int>("init_quality", this->quality);
+        }catch(...){
+            _ml::caution("Could not get parameter", "Display node is invalid");
+            return false;
+        }
+        if(width < 1 || height < 1){
+            _ml::caution("Resolution of display node is invalid", ip_addr);
+            return false;
+        }
+        if(rotation != ROTATION_NONE && rotation != ROTATION_90 && rotation != ROTATION_180 && rotation != ROTATION_270){
+            _ml::caution("Rotation of display node is invalid", std::to_string(rotation));
+            return false;
+        }
+        if(dec_thre_num < 1 || recvbuf_num < 1){
+            _ml::caution("Decoders or receive framebuffer of display node is invalid", ip_addr);
+            return false;
+        }
+        if(dec_thre_num+VIEWBUF_EXTRA_NUM > FRAME_ID_NUM){
+            _ml::caution("Too many decoders of display node", std::to_string(dec_thre_num) + " (at most "
+                         + std::to_string(FRAME_ID_NUM-VIEWBUF_EXTRA_NUM) + ")");
+            return false;
+        }
+        if(quality < JPEG_QUALITY_MIN || quality > JPEG_QUALITY_MAX){
+            _ml::caution("Quality of display node is invalid", std::to_string(quality));
+            return false;
+        }
+        this->ip_addrs.push_back(ip_addr);
+        this->nodes.push_back(std::forward_as_tuple(width, height, rotation, dec_thre_num, recvbuf_num, quality));
     }
     if(int(this->ip_addrs.size()) != this->row*this->column){
         _ml::caution("Number of display nodes is invalid", std::to_string(this->ip_addrs.size()));
@@ -50,11 +184,228 @@ const bool ConfigParser::readParams(const _pt::ptree& conf){
     return true;
 }
 
+/* read the relay nodes and make the connection list (the displays behind a relay node share one connection) */
+const bool ConfigParser::readRelayNodes(const _pt::ptree& conf){
+    const int display_num = this->ip_addrs.size();
+    std::vector<bool> relayed(display_num, false);
+    conn_list_t relay_conns;
+    const auto relay_nodes = conf.get_child_optional("relay_node");
+    if(relay_nodes){
+        for(const auto& elem : relay_nodes.get()){
+            std::string ip_addr;
+            std::vector<int> ids;
+            try{
+                ip_addr = elem.second.get<std::string>("node_id", "");
+                if(ip_addr.empty()){
+                    ip_addr = elem.second.get<std::string>("ip");
+                }
+                for(const auto& id_elem : elem.second.get_child("displays")){
+                    ids.push_back(id_elem.second.get_value<int>());
+                }
+            }catch(...){
+                _ml::caution("Could not get parameter", "Relay node is invalid");
+                return false;
+            }
+            for(const int id : ids){
+                if(id < 0 || id >= display_num || relayed[id]){
+                    _ml::caution("Display ID of relay node is invalid", std::to_string(id));
+                    return false;
+                }
+                relayed[id] = true;
+            }
+            if(ids.empty()){
+                _ml::caution("Relay node has no display", ip_addr);
+                return false;
+            }
+            relay_conns.push_back(std::forward_as_tuple(ip_addr, ids, true));
+        }
+    }
+    
+    // connect to the display nodes directly unless they are behind a relay node
+    for(int i=0; i<display_num; ++i){
+        if(!relayed[i]){
+            this->conns.push_back(std::forward_as_tuple(this->ip_addrs[i], std::vector<int>(1, i), false));
+        }
+    }
+    this->conns.insert(this->conns.end(), relay_conns.begin(), relay_conns.end());
+    return true;
+}
+
+/* read the windows (the sources are painted in order, so a later window is above the earlier ones) */
+const bool ConfigParser::readWindows(const _pt::ptree& conf){
+    const auto windows = conf.get_child_optional("windows");
+    if(!windows){
+        return true;
+    }
+    for(const auto& elem : windows.get()){
+        std::string src, src_type;
+        int src_width, src_height, src_fps;
+        bool media_clock;
+        cv::Rect rect;
+        try{
+            src = elem.second.get<std::string>("src");
+            src_type = elem.second.get<std::string>("source_type", SOURCE_VIDEO);
+            src_width = elem.second.get<int>("source_width", 0);
+            src_height = elem.second.get<int>("source_height", 0);
+            src_fps = elem.second.get<int>("source_fps", SOURCE_UNPACED);
+            media_clock = elem.second.get<bool>("media_clock", true);
+            rect = cv::Rect(elem.second.get<int>("x"), elem.second.get<int>("y"),
+                            elem.second.get<int>("width"), elem.second.get<int>("height"));
+        }catch(...){
+            _ml::caution("Could not get parameter", "Window is invalid");
+            return false;
+        }
+        
+        // the pre-encoded tiles can not be composited
+        if(src_type != SOURCE_VIDEO && src_type != SOURCE_SYNTHETIC && src_type != SOURCE_SHM
+           && src_type != SOURCE_V4L2 && src_type != SOURCE_PLAYLIST){
+            _ml::caution("Source type of window is invalid", src_type);
+            return false;
+        }
+        if(rect.width <= 0 || rect.height <= 0){
+            _ml::caution("Size of window is invalid", src);
+            return false;
+        }
+        const source_params_t source_params = std::forward_as_tuple(src_type, src, src_width, src_height, src_fps);
+        this->windows.push_back(std::forward_as_tuple(source_params, media_clock, rect));
+    }
+    return true;
+}
+
+/* read the overlays (drawn by the display nodes in order, so a later overlay is above the earlier ones) */
+const bool ConfigParser::readOverlays(const _pt::ptree& conf){
+    const auto overlays = conf.get_child_optional("overlays");
+    if(!overlays){
+        return true;
+    }
+    for(const auto& elem : overlays.get()){
+        OverlayParams params;
+        try{
+            params.type = elem.second.get<std::string>("type");
+            params.text = elem.second.get<std::string>("text", params.type==OVERLAY_TYPE_CLOCK ? OVERLAY_CLOCK_FORMAT : "");
+            params.x = elem.second.get<int>("x");
+            params.y = elem.second.get<int>("y");
+            params.width = elem.second.get<int>("width", 0);
+            params.height = elem.second.get<int>("height", 0);
+            params.scale = elem.second.get<double>("scale", 1.0);
+            params.speed = elem.second.get<int>("speed", 0);
+            params.per_display = elem.second.get<bool>("per_display", false);
+            std::fill(params.color, params.color+3, 255);
+            const auto color = elem.second.get_child_optional("color");
+            if(color){
+                int i = 0;
+                for(const auto& channel : *color){
+                    if(i < 3){
+                        params.color[i] = std::min(std::max(channel.second.get_value<int>(), 0), 255);
+                    }
+                    ++i;
+                }
+            }
+        }catch(...){
+            _ml::caution("Could not get parameter", "Overlay is invalid");
+            return false;
+        }
+        
+        if(params.type != OVERLAY_TYPE_TEXT && params.type != OVERLAY_TYPE_CLOCK
+           && params.type != OVERLAY_TYPE_TICKER && params.type != OVERLAY_TYPE_SPRITE){
+            _ml::caution("Overlay type is invalid", params.type);
+            return false;
+        }
+        if(params.scale <= 0){
+            _ml::caution("Scale of overlay is invalid", std::to_string(params.scale));
+            return false;
+        }
+        if((params.type == OVERLAY_TYPE_TICKER && (params.width <= 0 || params.speed < 0))
+           || (params.type == OVERLAY_TYPE_SPRITE && (params.width <= 0 || params.height <= 0))){
+            _ml::caution("Size of overlay is invalid", params.type);
+            return false;
+        }
+        this->overlays.push_back(params);
+    }
+    return true;
+}
+
 /* get the port number for the frontend server */
 const int ConfigParser::getFrontendServerPort(){
     return this->fs_port;
 }
 
+/* get the type of the video source */
+const std::string ConfigParser::getSourceType(){
+    return this->src_type;
+}
+
+/* get the parameters of the video source */
+const source_params_t ConfigParser::getSourceParams(){
+    const std::string src_type = this->src_type;
+    const std::string src = this->src;
+    const int src_width = this->src_width;
+    const int src_height = this->src_height;
+    const int src_fps = this->src_fps;
+    return std::forward_as_tuple(src_type, src, src_width, src_height, src_fps);
+}
+
+/* check if the frames are paced with the media clock */
+const bool ConfigParser::useMediaClock(){
+    return this->media_clock;
+}
+
+/* get the transport backend */
+const std::string ConfigParser::getTransportBackend(){
+    return this->backend;
+}
+
+/* get the connections to the display nodes and the relay nodes */
+const conn_list_t ConfigParser::getConnections(){
+    return this->conns;
+}
+
+/* get the parameters of the I/O threads */
+const io_params_t ConfigParser::getIoParams(){
+    const int io_thre_num = this->io_thre_num;
+    const bool pin_io_thres = this->pin_io_thres;
+    return std::forward_as_tuple(io_thre_num, pin_io_thres);
+}
+
+/* get the time to wait for the sync messages after the first one in a round (0 to wait forever) */
+const int ConfigParser::getSyncTimeout(){
+    return this->sync_timeout;
+}
+
+/* get the codec of the tiles (JPEG for all the tiles, or chosen for each tile) */
+const std::string ConfigParser::getTileCodec(){
+    return this->tile_codec;
+}
+
+/* get the windows of the sources (empty to show a single source on the whole wall) */
+const window_list_t ConfigParser::getWindows(){
+    return this->windows;
+}
+
+/* get the overlays on the display nodes (empty not to draw any overlay) */
+const overlay_list_t ConfigParser::getOverlays(){
+    return this->overlays;
+}
+
+/* get the gamma of the projectors to blend the overlapping edges (unused without a negative bezel) */
+const double ConfigParser::getBlendGamma(){
+    return this->blend_gamma;
+}
+
+/* get the settings of each display node (width, height, rotation, decoders, receive framebuffer and quality) */
+const node_list_t ConfigParser::getNodes(){
+    return this->nodes;
+}
+
+/* get the size of the framebuffer of each display node and the clockwise angle to rotate its tile */
+const tile_shape_list_t ConfigParser::getTileShapes(){
+    tile_shape_list_t tile_shapes;
+    for(const node_params_t& node : this->nodes){
+        tile_shapes.push_back(std::forward_as_tuple(std::get<0>(node), std::get<1>(node), std::get<2>(node)));
+    }
+    return tile_shapes;
+}
+
 /* pass the parameters to the frontend server */
 const fs_params_t ConfigParser::getFrontendServerParams(){
     const std::string src = this->src;
@@ -69,7 +420,7 @@ const fs_params_t ConfigParser::getFrontendServerParams(){
     const int stream_port = this->stream_port;
     const int sendbuf_num = this->sendbuf_num;
     const int recvbuf_num = this->recvbuf_num;
-    const std::string ycbcr_format = this->ycbcr_format;
+    const int ycbcr_format = this->ycbcr_format;
     const int quality = this->quality;
     const int dec_thre_num = this->dec_thre_num;
     const int tuning_term = this->tuning_term;
@@ -0,0 +1,106 @@
+/******************************************************
+*                connection_table.cpp                 *
+*  (states of the display nodes and the relay nodes)  *
+******************************************************/
+
+#include "connection_table.hpp"
+
+/* constructor */
+ConnectionTable::ConnectionTable(const conn_list_t& conns):
+    states(conns.size(), CONN_DOWN),
+    generations(conns.size(), CONN_NO_GEN),
+    join_seqs(conns.size(), 0)
+{
+    for(int i=0; i<int(conns.size()); ++i){
+        this->ip_addrs.push_back(std::get<0>(conns[i]));
+        const std::string labels = _mt::labels({{"conn", std::get<0>(conns[i])}});
+        _mt::addGauge("tdw_conn_state", "State of each connection (0: down, 1: joining, 2: live)", labels,
+                      std::bind(&ConnectionTable::getStateValue, this, i));
+        this->drop_counts.push_back(_mt::addCounter("tdw_conn_drops_total", "Number of the drops of each connection", labels));
+    }
+}
+
+/* add a callback when a connection is dropped (called without the lock, so it may call the table) */
+void ConnectionTable::addDropCallback(const drop_callback_t& callback){
+    std::lock_guard<std::mutex> lock(this->lock);
+    this->drop_callbacks.push_back(callback);
+}
+
+/* call the callbacks of a dropped connection */
+void ConnectionTable::notifyDrop(const int id){
+    std::vector<drop_callback_t> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(this->lock);
+        callbacks = this->drop_callbacks;
+    }
+    for(const drop_callback_t& callback : callbacks){
+        callback(id);
+    }
+}
+
+/* get the state of a connection for the metrics */
+const double ConnectionTable::getStateValue(const int id){
+    std::lock_guard<std::mutex> lock(this->lock);
+    return this->states[id];
+}
+
+/* register a new control connection (the old connection of the same node is dropped), and return its generation */
+const int ConnectionTable::join(const int id){
+    bool replaced;
+    int gen;
+    {
+        std::lock_guard<std::mutex> lock(this->lock);
+        replaced = this->states[id] != CONN_DOWN;
+        this->states[id] = CONN_JOINING;
+        gen = ++this->generations[id];
+    }
+    if(replaced){
+        _ml::warn("Connection with " + this->ip_addrs[id] + " was replaced", "The node reconnected before its drop was detected");
+        this->drop_counts[id]->add(1);
+        this->notifyDrop(id);
+    }
+    return gen;
+}
+
+/* make a joining connection live from a frame (false if the connection has been dropped) */
+const bool ConnectionTable::admit(const int id, const int gen, const int seq){
+    std::lock_guard<std::mutex> lock(this->lock);
+    if(this->generations[id] != gen || this->states[id] != CONN_JOINING){
+        return false;
+    }
+    this->states[id] = CONN_LIVE;
+    this->join_seqs[id] = seq;
+    return true;
+}
+
+/* drop a connection (ignored if the generation is old or it has already been dropped) */
+void ConnectionTable::drop(const int id, const int gen, const std::string& reason){
+    {
+        std::lock_guard<std::mutex> lock(this->lock);
+        if(this->generations[id] != gen || this->states[id] == CONN_DOWN){
+            return;
+        }
+        this->states[id] = CONN_DOWN;
+    }
+    _ml::warn("Connection with " + this->ip_addrs[id] + " was dropped", reason);
+    this->drop_counts[id]->add(1);
+    this->notifyDrop(id);
+}
+
+/* get the state of a connection (CONN_DOWN if the generation is old) */
+const int ConnectionTable::getState(const int id, const int gen){
+    std::lock_guard<std::mutex> lock(this->lock);
+    return this->generations[id]==gen ? this->states[id] : CONN_DOWN;
+}
+
+/* get the generation of the current connection of a node */
+const int ConnectionTable::getGeneration(const int id){
+    std::lock_guard<std::mutex> lock(this->lock);
+    return this->generations[id];
+}
+
+/* get the sequence number of the first frame sent to a connection */
+const int ConnectionTable::getJoinSeq(const int id){
+    std::lock_guard<std::mutex> lock(this->lock);
+    return this->join_seqs[id];
+}
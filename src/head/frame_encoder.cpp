@@ -6,12 +6,19 @@
 #include "frame_encoder.hpp"
 
 /* constructor */
-FrameEncoder::FrameEncoder(const std::string src, const int column, const int row,
+FrameEncoder::FrameEncoder(const source_ptr_t source, const bool media_clock, const int column, const int row,
                            const int bezel_w, const int bezel_h, const int width, const int height,
-                           jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list,
+                           const tile_shape_list_t& tile_shapes, jpeg_params_t& ycbcr_format_list,
+                           jpeg_params_t& quality_list,
                            std::vector<tranbuf_ptr_t>& send_bufs):
     handle(tjInitCompress()),
+    source(source),
+    clock(media_clock),
     display_num(column*row),
+    layout(column, row, bezel_w, bezel_h),
+    width(width),
+    height(height),
+    tile_shapes(tile_shapes),
     ycbcr_format_list(ycbcr_format_list),
     quality_list(quality_list),
     send_bufs(send_bufs)
@@ -23,19 +30,73 @@ FrameEncoder::FrameEncoder(const std::string src, const int column, const int ro
         std::exit(EXIT_FAILURE);
     }
     
-    // load the video
-    this->video = cv::VideoCapture(src.c_str());
-    if(!this->video.isOpened()){
-        _ml::caution("Failed to open video", src);
+    // set the parameters (the parameters for the next source of a playlist are prepared in the background)
+    this->plan = this->makeResizePlan(this->layout, this->source->getFrameSize());
+    this->initRawFrames();
+    this->source->setSizeCallback(std::bind(&FrameEncoder::prepareResizePlan, this, std::placeholders::_1));
+    this->initMetrics();
+}
+
+/* constructor (the windows of several sources are composited onto the wall) */
+FrameEncoder::FrameEncoder(const compositor_ptr_t compositor, const int column, const int row,
+                           const int bezel_w, const int bezel_h, const int width, const int height,
+                           const tile_shape_list_t& tile_shapes, jpeg_params_t& ycbcr_format_list,
+                           jpeg_params_t& quality_list,
+                           std::vector<tranbuf_ptr_t>& send_bufs):
+    handle(tjInitCompress()),
+    source(nullptr),
+    compositor(compositor),
+    clock(false),
+    display_num(column*row),
+    layout(column, row, bezel_w, bezel_h),
+    width(width),
+    height(height),
+    tile_shapes(tile_shapes),
+    ycbcr_format_list(ycbcr_format_list),
+    quality_list(quality_list),
+    send_bufs(send_bufs),
+    last_tiles(column*row)
+{
+    // initialize the TurboJPEG encoder
+    if(this->handle == NULL){
+        const std::string err_msg(tjGetErrorStr());
+        _ml::caution("Failed to init JPEG encoder", err_msg);
         std::exit(EXIT_FAILURE);
     }
     
-    // set the parameters
-    cv::Mat video_frame;
-    video >> video_frame;
-    this->setResizeParams(
-        column, row, bezel_w, bezel_h, width, height, video_frame.cols, video_frame.rows
-    );
+    // the windows are painted onto the wall without resizing it
+    this->plan = this->makeResizePlan(this->layout, this->getWallSize(this->layout));
+    this->initRawFrames();
+    this->initMetrics();
+}
+
+/* constructor (the frames are given to resize() directly, e.g. in the microbenchmarks) */
+FrameEncoder::FrameEncoder(const int frame_w, const int frame_h, const int column, const int row,
+                           const int bezel_w, const int bezel_h, const int width, const int height,
+                           const tile_shape_list_t& tile_shapes, jpeg_params_t& ycbcr_format_list,
+                           jpeg_params_t& quality_list,
+                           std::vector<tranbuf_ptr_t>& send_bufs):
+    handle(tjInitCompress()),
+    source(nullptr),
+    clock(false),
+    display_num(column*row),
+    layout(column, row, bezel_w, bezel_h),
+    width(width),
+    height(height),
+    tile_shapes(tile_shapes),
+    ycbcr_format_list(ycbcr_format_list),
+    quality_list(quality_list),
+    send_bufs(send_bufs)
+{
+    // initialize the TurboJPEG encoder
+    if(this->handle == NULL){
+        const std::string err_msg(tjGetErrorStr());
+        _ml::caution("Failed to init JPEG encoder", err_msg);
+        std::exit(EXIT_FAILURE);
+    }
+    this->plan = this->makeResizePlan(this->layout, cv::Size(frame_w, frame_h));
+    this->initRawFrames();
+    this->initMetrics();
 }
 
 /* destructor (destroy the TurboJPEG encoder)*/
@@ -43,64 +104,167 @@ FrameEncoder::~FrameEncoder(){
     tjDestroy(this->handle);
 }
 
-/* set the parameters for resizing a frame */
-void FrameEncoder::setResizeParams(const int column, const int row, const int bezel_w,
-                                   const int bezel_h, const int width, const int height,
-                                   const int frame_w, const int frame_h){
+/* register the metrics */
+void FrameEncoder::initMetrics(){
+    this->capture_hist = _mt::addStageHistogram(TRACE_STAGE_NAMES[TRACE_CAPTURE]);
+    this->resize_hist = _mt::addStageHistogram(TRACE_STAGE_NAMES[TRACE_RESIZE]);
+    for(int i=0; i<this->display_num; ++i){
+        const std::string id = std::to_string(i);
+        this->encode_hists.push_back(_mt::addStageHistogram(TRACE_STAGE_NAMES[TRACE_ENCODE], {{"display", id}}));
+        this->enqueue_hists.push_back(_mt::addStageHistogram(TRACE_STAGE_NAMES[TRACE_ENQUEUE], {{"display", id}}));
+    }
+    this->encode_failures = _mt::addCounter("tdw_encode_failures_total", "Number of the failed JPEG encodes", "");
+    this->late_drops = _mt::addCounter("tdw_late_drops_total", "Number of the frames dropped before encoding to keep up with the media clock", "");
+    this->lossless_tiles = _mt::addCounter("tdw_lossless_tiles_total", "Number of the tiles of screen content encoded without loss", "");
+}
+
+/* allocate the raw frames (in a block of frame memory with the rows padded to the alignment, each in the size of its node) */
+void FrameEncoder::initRawFrames(){
+    std::vector<size_t> offsets(this->display_num+1, 0);
+    for(int i=0; i<this->display_num; ++i){
+        int tile_w, tile_h;
+        std::tie(tile_w, tile_h, std::ignore) = this->tile_shapes[i];
+        offsets[i+1] = offsets[i] + alignRow(tile_w*COLOR_CHANNEL_NUM)*tile_h;
+    }
+    this->raw_memory = std::make_shared<FrameMemory>(offsets[this->display_num]);
+    for(int i=0; i<this->display_num; ++i){
+        int tile_w, tile_h;
+        std::tie(tile_w, tile_h, std::ignore) = this->tile_shapes[i];
+        this->raw_frames.push_back(cv::Mat(tile_h, tile_w, CV_8UC3, this->raw_memory->getData()+offsets[i],
+                                           alignRow(tile_w*COLOR_CHANNEL_NUM)));
+    }
+    this->scaled_tiles = std::vector<cv::Mat>(this->display_num);
+}
+
+/* cut out the tile of a display node from the wall (scaled and rotated into its raw frame in one pass if possible) */
+void FrameEncoder::extractTile(const int id){
+    const cv::Mat region = this->plan.resized_frame(this->plan.regions[id]);
+    cv::Mat& raw_frame = this->raw_frames[id];
+    const int rotation = std::get<2>(this->tile_shapes[id]);
+    
+    // a quarter turn swaps the sides, so the tile is scaled to the transposed size before it is rotated
+    const bool quarter_turn = rotation == ROTATION_90 || rotation == ROTATION_270;
+    const cv::Size upright_size = quarter_turn ? cv::Size(raw_frame.rows, raw_frame.cols) : raw_frame.size();
+    const int interpolation_type = upright_size.area()>region.size().area() ? cv::INTER_LINEAR : cv::INTER_AREA;
+    if(rotation == ROTATION_NONE){
+        if(region.size() == upright_size){
+            region.copyTo(raw_frame);
+        }else{
+            cv::resize(region, raw_frame, upright_size, 0, 0, interpolation_type);
+        }
+        return;
+    }
+    const int rotate_code = rotation==ROTATION_90 ? cv::ROTATE_90_CLOCKWISE
+                          : rotation==ROTATION_180 ? cv::ROTATE_180 : cv::ROTATE_90_COUNTERCLOCKWISE;
+    if(region.size() == upright_size){
+        cv::rotate(region, raw_frame, rotate_code);
+    }else{
+        cv::resize(region, this->scaled_tiles[id], upright_size, 0, 0, interpolation_type);
+        cv::rotate(this->scaled_tiles[id], raw_frame, rotate_code);
+    }
+}
+
+/* make the parameters for resizing a frame (thread safe, so it can run off the encoder thread) */
+const ResizePlan FrameEncoder::makeResizePlan(const layout_params_t& layout, const cv::Size& frame_size){
+    ResizePlan plan;
+    plan.layout = layout;
+    plan.frame_size = frame_size;
+    int column, row, bezel_w, bezel_h;
+    std::tie(column, row, bezel_w, bezel_h) = layout;
+    
     // initialize the background
-    const int bg_w = width * column + bezel_w * 2 * (column - 1);
-    const int bg_h = height * row + bezel_h * 2 * (row - 1);
-    this->resized_frame = cv::Mat::zeros(cv::Size(bg_w, bg_h), CV_8UC3);
+    const cv::Size wall_size = this->getWallSize(layout);
+    const int bg_w = wall_size.width;
+    const int bg_h = wall_size.height;
+    const size_t pitch = alignRow(bg_w*COLOR_CHANNEL_NUM);
+    plan.memory = std::make_shared<FrameMemory>(pitch*bg_h);
+    plan.resized_frame = cv::Mat(bg_h, bg_w, CV_8UC3, plan.memory->getData(), pitch);
     
     // set the ratio
-    const double x_ratio = (double)bg_w / (double)frame_w;
-    const double y_ratio = (double)bg_h / (double)frame_h;
-    this->ratio = x_ratio<y_ratio ? x_ratio : y_ratio;
-    this->interpolation_type = this->ratio>=1 ? cv::INTER_LINEAR : cv::INTER_AREA;
+    const double x_ratio = (double)bg_w / (double)frame_size.width;
+    const double y_ratio = (double)bg_h / (double)frame_size.height;
+    plan.ratio = x_ratio<y_ratio ? x_ratio : y_ratio;
+    plan.interpolation_type = plan.ratio>=1 ? cv::INTER_LINEAR : cv::INTER_AREA;
     
     // set the padding size
-    const int resize_w = (int)((double)frame_w * this->ratio);
-    const int resize_h = (int)((double)frame_h * this->ratio);
+    const int resize_w = (int)((double)frame_size.width * plan.ratio);
+    const int resize_h = (int)((double)frame_size.height * plan.ratio);
     const int paste_x = (int)((double)(bg_w - resize_w) / 2.0);
     const int paste_y = (int)((double)(bg_h - resize_h) / 2.0);
-    this->roi = cv::Rect(paste_x, paste_y, resize_w, resize_h);
+    plan.roi = cv::Rect(paste_x, paste_y, resize_w, resize_h);
     
-    // set the area displayed by each display node
-    this->regions = std::vector<cv::Rect>(this->display_num);
-    this->raw_frames = std::vector<cv::Mat>(this->display_num);
+    // set the area displayed by each display node (a negative bezel extends it into the neighbors for projectors)
+    plan.regions = std::vector<cv::Rect>(this->display_num);
     for(int j=0; j<row; ++j){
         for(int i=0; i<column; ++i){
-            this->regions[i+column*j] = cv::Rect((width+bezel_w*2)*i,
-                                                 (height+bezel_h*2)*j,
-                                                 width,
-                                                 height);
+            plan.regions[i+column*j] = cv::Rect((this->width+bezel_w*2)*i,
+                                                (this->height+bezel_h*2)*j,
+                                                this->width,
+                                                this->height);
         }
     }
+    return plan;
+}
+
+/* get the size of the wall including the bezels (smaller than the displays side by side if they overlap) */
+const cv::Size FrameEncoder::getWallSize(const layout_params_t& layout){
+    int column, row, bezel_w, bezel_h;
+    std::tie(column, row, bezel_w, bezel_h) = layout;
+    return cv::Size(this->width*column + bezel_w*2*(column-1), this->height*row + bezel_h*2*(row-1));
+}
+
+/* prepare the parameters for the next source (called by a playlist in its prefetch thread) */
+void FrameEncoder::prepareResizePlan(const cv::Size frame_size){
+    layout_params_t layout;
+    {
+        std::lock_guard<std::mutex> lock(this->reconf_lock);
+        layout = this->layout;
+    }
+    ResizePlan plan = this->makeResizePlan(layout, frame_size);
+    std::lock_guard<std::mutex> lock(this->reconf_lock);
+    this->next_plan = std::move(plan);
+    this->plan_ready = true;
 }
 
-/* resize a frame */
+/* switch to the parameters for a new frame size (made here only if they were not prepared) */
+void FrameEncoder::adoptResizePlan(const cv::Size& frame_size){
+    {
+        std::lock_guard<std::mutex> lock(this->reconf_lock);
+        if(this->plan_ready && this->next_plan.frame_size == frame_size && this->next_plan.layout == this->layout){
+            this->plan = std::move(this->next_plan);
+            this->plan_ready = false;
+            return;
+        }
+    }
+    _ml::notice("Frame size is changed to " + std::to_string(frame_size.width) + "x" + std::to_string(frame_size.height));
+    this->plan = this->makeResizePlan(this->layout, frame_size);
+}
+
+/* resize a frame (the frame is not modified, so it may refer to a source buffer) */
 void FrameEncoder::resize(cv::Mat& video_frame){
-    // resize a video frame
-    cv::resize(video_frame, video_frame, cv::Size(), this->ratio, this->ratio, this->interpolation_type);
-    
-    // put a resize frame on the background
-    cv::Mat paste_area = this->resized_frame(this->roi);
-    video_frame.copyTo(paste_area);
+    // resize a video frame onto the background directly
+    cv::Mat paste_area = this->plan.resized_frame(this->plan.roi);
+    cv::resize(video_frame, paste_area, this->plan.roi.size(), 0, 0, this->plan.interpolation_type);
     
     // divide a frame in accordance with the area list
     for(int i=0; i<this->display_num; ++i){
-        this->resized_frame(this->regions[i]).copyTo(this->raw_frames[i]);
+        this->extractTile(i);
     }
 }
 
 /* encode a frame */
 void FrameEncoder::encode(const int id){
+    // the tiles of screen content are sent without loss, and the others in JPEG
+    if(this->auto_codec.load(std::memory_order_acquire) && this->encodeLossless(id)){
+        return;
+    }
     unsigned char *jpeg_frame = NULL;
     unsigned long jpeg_size = 0;
+    const int64_t encode_t = _ft::now();
     const int tj_stat = tjCompress2(this->handle,
                                     this->raw_frames[id].data,
                                     this->raw_frames[id].cols,
-                                    this->raw_frames[id].cols*COLOR_CHANNEL_NUM,
+                                    (int)this->raw_frames[id].step,
                                     this->raw_frames[id].rows,
                                     TJPF_RGB,
                                     &jpeg_frame,
@@ -109,31 +273,174 @@ void FrameEncoder::encode(const int id){
                                     this->quality_list[id].load(std::memory_order_acquire),
                                     TJFLAG_FASTDCT
     );
+    _ft::record(TRACE_ENCODE, this->frame_seq, id, encode_t);
+    this->encode_hists[id]->observe(_ft::now()-encode_t);
     if(tj_stat == JPEG_FAILED){
         const std::string err_msg(tjGetErrorStr());
         _ml::warn("JPEG encode failed", err_msg);
+        this->encode_failures->add(1);
+        if(this->compositor){
+            this->last_tiles[id].clear();  // encoded again at the next frame
+        }
     }else{
-        const std::string jpeg_str(jpeg_frame, jpeg_frame+jpeg_size);
-        this->send_bufs[id]->push(jpeg_str);
+        this->enqueue(id, std::string(jpeg_frame, jpeg_frame+jpeg_size));
     }
 }
 
-/* start encoding frames */
-void FrameEncoder::run(){
-    cv::Mat video_frame;
-    while(true){
-        this->video >> video_frame;
-        
-        try{
-            this->resize(video_frame);
-        }catch(...){
-            _ml::caution("Could not get video frame", "JPEG encoder stopped");
-            break;
+/* encode a tile of screen content without loss (false if the tile looks like video or is too large) */
+const bool FrameEncoder::encodeLossless(const int id){
+    const cv::Mat& raw_frame = this->raw_frames[id];
+    if(!isFlatTile(raw_frame.data, raw_frame.cols, raw_frame.rows, raw_frame.step)){
+        return false;
+    }
+    const int64_t encode_t = _ft::now();
+    std::string tile;
+    if(!encodeLosslessTile(raw_frame.data, raw_frame.cols, raw_frame.rows, raw_frame.step, tile)){
+        return false;
+    }
+    _ft::record(TRACE_ENCODE, this->frame_seq, id, encode_t);
+    this->encode_hists[id]->observe(_ft::now()-encode_t);
+    this->lossless_tiles->add(1);
+    this->enqueue(id, tile);
+    return true;
+}
+
+/* push an encoded tile into the send framebuffer */
+void FrameEncoder::enqueue(const int id, const std::string& tile){
+    const int64_t enqueue_t = _ft::now();
+    this->send_bufs[id]->push(tile);
+    if(this->compositor){
+        this->last_tiles[id] = tile;
+    }
+    _ft::record(TRACE_ENQUEUE, this->frame_seq, id, enqueue_t);
+    this->enqueue_hists[id]->observe(_ft::now()-enqueue_t);
+}
+
+/* apply the requested changes between the frames (the frames in the send framebuffers are kept) */
+void FrameEncoder::applyChanges(){
+    source_ptr_t source;
+    {
+        std::lock_guard<std::mutex> lock(this->reconf_lock);
+        if(!this->next_source && !this->relayout){
+            return;
+        }
+        if(this->next_source){
+            source = this->next_source;
+            this->next_source.reset();
+            this->clock.reset(this->next_media_clock);
         }
-        
-        for(int i=0; i<this->display_num; ++i){
+        if(this->relayout){
+            this->layout = this->next_layout;
+            this->relayout = false;
+            _ml::notice("Layout is changed at frame " + std::to_string(this->frame_seq));
+        }
+    }
+    if(source){
+        this->source = source;
+        this->source->setSizeCallback(std::bind(&FrameEncoder::prepareResizePlan, this, std::placeholders::_1));
+        _ml::notice("Video source is switched at frame " + std::to_string(this->frame_seq));
+    }
+    
+    // resize the frames of the source onto the layout (or paint all the windows onto the new wall)
+    if(this->compositor){
+        this->plan = this->makeResizePlan(this->layout, this->getWallSize(this->layout));
+        this->repaint = true;
+    }else{
+        this->plan = this->makeResizePlan(this->layout, this->source->getFrameSize());
+    }
+}
+
+/* composite the windows and encode the changed tiles (the last tiles are sent again for the others) */
+const bool FrameEncoder::compositeFrame(){
+    std::vector<cv::Rect> dirty_rects;
+    const int64_t capture_t = _ft::now();
+    if(!this->compositor->composite(this->plan.resized_frame, this->repaint, dirty_rects)){
+        return false;
+    }
+    _ft::record(TRACE_CAPTURE, this->frame_seq, TRACE_NO_TILE, capture_t);
+    this->capture_hist->observe(_ft::now()-capture_t);
+    this->repaint = false;
+    
+    for(int i=0; i<this->display_num; ++i){
+        bool changed = this->last_tiles[i].empty();
+        for(const cv::Rect& dirty_rect : dirty_rects){
+            changed = changed || (dirty_rect & this->plan.regions[i]).area() > 0;
+        }
+        if(changed){
+            this->extractTile(i);
             this->encode(i);
+        }else{
+            this->enqueue(i, this->last_tiles[i]);
         }
     }
+    ++this->frame_seq;
+    return true;
+}
+
+/* set the codec of the tiles (applied from the next tile) */
+void FrameEncoder::setTileCodec(const std::string& codec){
+    this->auto_codec.store(codec == TILE_CODEC_AUTO, std::memory_order_release);
+}
+
+/* switch the source at the next frame (the source is opened by the caller, so no frame is missed) */
+void FrameEncoder::switchSource(const source_ptr_t source, const bool media_clock){
+    std::lock_guard<std::mutex> lock(this->reconf_lock);
+    this->next_source = source;
+    this->next_media_clock = media_clock;
+}
+
+/* change the layout at the next frame (the number of the displays is not changed) */
+void FrameEncoder::setLayout(const layout_params_t& layout){
+    std::lock_guard<std::mutex> lock(this->reconf_lock);
+    this->next_layout = layout;
+    this->relayout = true;
+}
+
+/* encode the next video frame */
+const bool FrameEncoder::encodeFrame(){
+    this->applyChanges();
+    if(this->compositor){
+        return this->compositeFrame();
+    }
+    cv::Mat video_frame;
+    int64_t pts;
+    const int64_t capture_t = _ft::now();
+    if(!this->source->read(video_frame, pts)){
+        return false;
+    }
+    _ft::record(TRACE_CAPTURE, this->frame_seq, TRACE_NO_TILE, capture_t);
+    this->capture_hist->observe(_ft::now()-capture_t);
+    
+    // drop a late frame before resizing and encoding it
+    if(!this->clock.schedule(pts)){
+        this->late_drops->add(1);
+        return true;
+    }
+    
+    // a playlist may change the frame size between its items
+    if(video_frame.size() != this->plan.frame_size){
+        this->adoptResizePlan(video_frame.size());
+    }
+    
+    const int64_t resize_t = _ft::now();
+    try{
+        this->resize(video_frame);
+        _ft::record(TRACE_RESIZE, this->frame_seq, TRACE_NO_TILE, resize_t);
+        this->resize_hist->observe(_ft::now()-resize_t);
+    }catch(...){
+        return false;
+    }
+    
+    for(int i=0; i<this->display_num; ++i){
+        this->encode(i);
+    }
+    this->clock.addCost(_ft::now()-resize_t);
+    ++this->frame_seq;
+    return true;
 }
 
+/* start encoding frames */
+void FrameEncoder::run(){
+    while(this->encodeFrame());
+    _ml::caution("Could not get video frame", "JPEG encoder stopped");
+}
@@ -6,22 +6,21 @@
 #include "frame_sender.hpp"
 
 /* constructor */
-FrameSender::FrameSender(_asio::io_service& ios, const int port, const int display_num,
-                         std::vector<tranbuf_ptr_t>& send_bufs, const int viewbuf_num):
+FrameSender::FrameSender(_asio::io_service& ios, const int port, const int display_num, const conn_list_t& conns,
+                         std::vector<tranbuf_ptr_t>& send_bufs, const int viewbuf_num,
+                         const container_ptr_t container, const sockopt_params_t& sock_params,
+                         const io_params_t& io_params, ConnectionTable& table):
+    BaseFrameSender(display_num, conns, send_bufs, viewbuf_num, container, sock_params, table),
     ios(ios),
     acc(ios, _ip::tcp::endpoint(_ip::tcp::v4(), port)),
-    display_num(display_num),
-    viewbuf_num(viewbuf_num),
+    socks(conns.size()),
+    pending_socks(conns.size()),
     send_count(0),
-    send_msgs(display_num),
-    send_bufs(send_bufs)
+    shards(io_params, THREAD_ROLE_SENDER)
 {
     // prepare for TCP sockets
-    this->sock = std::make_shared<_ip::tcp::socket>(ios);
-    
-    // start waiting for TCP connection
+    this->sock = std::make_shared<_ip::tcp::socket>(this->ios);
     _ml::notice("Streaming video frames at :" + std::to_string(port));
-    this->run();
 }
 
 /* start waiting for TCP connection from the display node */
@@ -29,60 +28,141 @@ void FrameSender::run(){
     this->acc.async_accept(*this->sock,
                            boost::bind(&FrameSender::onConnect, this, _ph::error)
     );
+    this->shards.run();
     this->ios.run();
+    this->shards.join();
 }
 
-/* send a JPEG frame */
+/* send a JPEG frame (the sender is idle until a connection is admitted if no connection is live) */
 void FrameSender::sendFrame(){
-    for(int i=0; i<this->display_num; ++i){
-        this->send_msgs[i] = std::to_string(this->fb_id) + this->send_bufs[i]->pop() + MSG_DELIMITER;
-        _asio::async_write(*this->socks[i],
-                           _asio::buffer(this->send_msgs[i]),
-                           boost::bind(&FrameSender::onSendFrame, this, _ph::error, _ph::bytes_transferred)
+    if(!this->prepareFrame()){
+        return;
+    }
+    
+    // write the send messages in the I/O threads of the connections
+    this->send_count.store(0, std::memory_order_release);
+    for(const int id : this->frame_conns){
+        _asio::post(this->socks[id]->get_executor(),
+                    boost::bind(&FrameSender::writeFrame, this, id)
         );
     }
-    this->fb_id = (this->fb_id+1) % this->viewbuf_num;
 }
 
-/* the callback when connected by the display node */
+/* write a send message (the header, the JPEG frames and the delimiter are gathered without copying) */
+void FrameSender::writeFrame(const int id){
+    if(this->tcp_cork){
+        setCork(*this->socks[id], true);
+    }
+    _asio::async_write(*this->socks[id],
+                       this->send_seqs[id],
+                       boost::bind(&FrameSender::onSendFrame, this, _ph::error, _ph::bytes_transferred, id)
+    );
+}
+
+/* the callback when connected by the display node or the relay node (the nodes can connect at any time) */
 void FrameSender::onConnect(const err_t& err){
-    const std::string ip_addr = this->sock->remote_endpoint().address().to_string();
+    const sock_ptr_t sock = this->sock;
+    this->sock = std::make_shared<_ip::tcp::socket>(this->ios);
+    this->acc.async_accept(*this->sock,
+                           boost::bind(&FrameSender::onConnect, this, _ph::error)
+    );
     if(err){
-        _ml::caution("Failed stream connection with " + ip_addr, err.message());
-        std::exit(EXIT_FAILURE);
-    }else{
-        this->send_count.fetch_add(1, std::memory_order_release);
+        _ml::warn("Failed stream connection", err.message());
+        return;
     }
     
-    // prepare for a new TCP socket
-    this->socks.push_back(this->sock);
-    this->sock = std::make_shared<_ip::tcp::socket>(this->ios);
+    // receive the hello message to identify the node (the other nodes are accepted meanwhile)
+    const streambuf_ptr_t hello_buf = std::make_shared<_asio::streambuf>(HELLO_SIZE_MAX);
+    _asio::async_read_until(*sock,
+                            *hello_buf,
+                            MSG_DELIMITER,
+                            boost::bind(&FrameSender::onRecvHello, this, _ph::error, _ph::bytes_transferred,
+                                        sock, hello_buf)
+    );
+}
+
+/* the callback when receiving the hello message of a stream connection */
+void FrameSender::onRecvHello(const err_t& err, size_t t_bytes, const sock_ptr_t sock,
+                              const streambuf_ptr_t hello_buf)
+{
+    err_t ep_err;
+    const std::string ip_addr = sock->remote_endpoint(ep_err).address().to_string();
+    if(err){
+        _ml::warn("Failed stream connection from " + ip_addr, err.message());
+        return;
+    }
     
-    if(this->send_count.load(std::memory_order_acquire) < this->display_num){
-        // restart waiting for TCP connection
-        this->acc.async_accept(*this->sock,
-                               boost::bind(&FrameSender::onConnect, this, _ph::error)
-        );
-    }else{
-        // start JPEG frame streaming
-        this->sock->close();
-        this->send_count.store(0, std::memory_order_release);
+    // check the ID of the connection
+    const auto data = hello_buf->data();
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
+    const std::string node_key = parseHelloMsg(recv_msg, ip_addr);
+    const int id = findConnection(this->conns, node_key);
+    if(ep_err || id == CONN_NOT_FOUND){
+        _ml::warn("Unexpected stream connection from " + node_key + " (" + ip_addr + ")", "Check config file");
+        return;
+    }
+    setSocketOptions(*sock, this->sock_params);
+    
+    // move the socket to the I/O thread of the connection and wait for the next frame boundary
+    const auto sock_fd = sock->release();
+    const sock_ptr_t shard_sock = std::make_shared<_ip::tcp::socket>(this->shards.getService(id), _ip::tcp::v4(), sock_fd);
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(this->conn_lock);
+        if(!this->addStream(id)){
+            _ml::warn("Unexpected stream connection from " + node_key, "No control connection");
+            return;
+        }
+        this->pending_socks[id] = shard_sock;
+        idle = this->idle;
+        this->idle = false;
+    }
+    
+    // restart JPEG frame streaming
+    if(idle){
         this->sendFrame();
     }
 }
 
-/* the callback when sending a JPEG frame */
-void FrameSender::onSendFrame(const err_t& err, size_t t_bytes){
+/* the callback when sending a JPEG frame (a failed connection is dropped without stopping the others) */
+void FrameSender::onSendFrame(const err_t& err, size_t t_bytes, const int id){
     if(err){
-        _ml::caution("Failed to send frame", err.message());
-        std::exit(EXIT_FAILURE);
+        this->dropStream(id, "Failed to send frame: " + err.message());
+    }else{
+        if(this->tcp_cork){
+            setCork(*this->socks[id], false);
+        }
+        this->recordSent(id);
     }
     
     // If all the current send processes are finished, start the next send processes
-    this->send_count.fetch_add(1, std::memory_order_release);
-    if(this->send_count.load(std::memory_order_acquire) == this->display_num){
-        this->send_count.store(0, std::memory_order_release);
+    if(this->send_count.fetch_add(1, std::memory_order_acq_rel)+1 == (int)this->frame_conns.size()){
+        this->sent_frames->add(1);
         this->sendFrame();
     }
 }
 
+/* make the pending socket of a connection live */
+void FrameSender::admitSocket(const int id){
+    this->socks[id] = this->pending_socks[id];
+    this->pending_socks[id].reset();
+}
+
+/* close the socket of a connection (no operation is pending on it) */
+void FrameSender::releaseSocket(const int id, const bool pending){
+    sock_ptr_t& sock = pending ? this->pending_socks[id] : this->socks[id];
+    if(sock){
+        err_t err;
+        sock->close(err);
+        sock.reset();
+    }
+}
+
+/* shut down the socket of a connection (the pending write fails in its I/O thread) */
+void FrameSender::shutdownSocket(const int id, const bool pending){
+    const sock_ptr_t& sock = pending ? this->pending_socks[id] : this->socks[id];
+    if(sock){
+        ::shutdown(sock->native_handle(), SHUT_RDWR);
+    }
+}
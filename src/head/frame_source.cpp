@@ -0,0 +1,522 @@
+/***************************************
+*          frame_source.cpp           *
+*  (sources of the raw video frames)  *
+***************************************/
+
+#include "frame_source.hpp"
+
+/* constructor */
+BaseFrameSource::BaseFrameSource(const int fps):
+    frame_interval(fps>SOURCE_UNPACED ? 1000000000/fps : 0)
+{}
+
+/* read the next frame and its presentation timestamp [ns] (the frame rate overrides the timestamps of the source) */
+const bool BaseFrameSource::read(cv::Mat& frame, int64_t& pts){
+    pts = MEDIA_TIME_NONE;
+    if(!this->opened || !this->readFrame(frame, pts)){
+        return false;
+    }
+    if(this->frame_interval > 0){
+        pts = this->frame_count * this->frame_interval;
+    }
+    ++this->frame_count;
+    return true;
+}
+
+/* constructor (open the video) */
+VideoFrameSource::VideoFrameSource(const std::string& src, const int fps):
+    BaseFrameSource(fps),
+    video(src.c_str())
+{
+    if(!this->video.isOpened()){
+        _ml::caution("Failed to open video", src);
+        this->opened = false;
+        return;
+    }
+}
+
+/* read the next frame (with the timestamp in the video) */
+const bool VideoFrameSource::readFrame(cv::Mat& frame, int64_t& pts){
+    if(!this->video.read(frame)){
+        return false;
+    }
+    pts = this->video.get(cv::CAP_PROP_POS_MSEC) * 1000000;
+    return true;
+}
+
+/* get the size of the frames */
+const cv::Size VideoFrameSource::getFrameSize(){
+    return cv::Size((int)this->video.get(cv::CAP_PROP_FRAME_WIDTH), (int)this->video.get(cv::CAP_PROP_FRAME_HEIGHT));
+}
+
+/* constructor (prepare the pattern) */
+SyntheticFrameSource::SyntheticFrameSource(const std::string& pattern, const int width, const int height,
+                                           const int fps):
+    BaseFrameSource(fps),
+    pattern(pattern)
+{
+    if(pattern != PATTERN_GRADIENT && pattern != PATTERN_NOISE && pattern != PATTERN_TEXT){
+        _ml::caution("Synthetic pattern is invalid", pattern);
+        this->opened = false;
+        return;
+    }
+    const int frame_w = width>0 ? width : SYNTHETIC_WIDTH_DEFAULT;
+    const int frame_h = height>0 ? height : SYNTHETIC_HEIGHT_DEFAULT;
+    this->frame = cv::Mat::zeros(cv::Size(frame_w, frame_h), CV_8UC3);
+    
+    // draw a horizontal gradient of twice the width (a window of it is scrolled in each frame)
+    if(pattern == PATTERN_GRADIENT){
+        this->gradient = cv::Mat(frame_h, frame_w*2, CV_8UC3);
+        for(int y=0; y<frame_h; ++y){
+            unsigned char *line = this->gradient.ptr(y);
+            for(int x=0; x<frame_w*2; ++x){
+                const int phase = x * 512 / frame_w;
+                line[x*BGR_CHANNEL_NUM] = phase<256 ? phase : 511-phase;
+                line[x*BGR_CHANNEL_NUM+1] = y * 255 / frame_h;
+                line[x*BGR_CHANNEL_NUM+2] = 255 - (phase<256 ? phase : 511-phase);
+            }
+        }
+    }
+    _ml::notice("Generating " + pattern + " frames at " + std::to_string(frame_w) + "x" + std::to_string(frame_h));
+}
+
+/* generate the next frame (the frame is reused, so it is valid until the next call) */
+const bool SyntheticFrameSource::readFrame(cv::Mat& frame, int64_t& pts){
+    const int frame_w = this->frame.cols;
+    const int frame_h = this->frame.rows;
+    if(this->pattern == PATTERN_GRADIENT){
+        const int offset = (this->frame_count * 8) % frame_w;
+        this->gradient(cv::Rect(offset, 0, frame_w, frame_h)).copyTo(this->frame);
+    }else if(this->pattern == PATTERN_NOISE){
+        cv::randu(this->frame, cv::Scalar(0, 0, 0), cv::Scalar(256, 256, 256));
+    }else{
+        const int box_size = frame_h / 8;
+        const int box_x = (this->frame_count * 8) % (frame_w-box_size);
+        this->frame.setTo(cv::Scalar(0, 0, 0));
+        cv::rectangle(this->frame, cv::Rect(box_x, frame_h-box_size*2, box_size, box_size), cv::Scalar(0, 160, 255), -1);
+        cv::putText(this->frame,
+                    "frame " + std::to_string(this->frame_count),
+                    cv::Point(frame_w/16, frame_h/3),
+                    cv::FONT_HERSHEY_SIMPLEX,
+                    frame_h / 200.0,
+                    cv::Scalar(255, 255, 255),
+                    frame_h / 100
+        );
+    }
+    ++this->frame_count;
+    frame = this->frame;
+    return true;
+}
+
+/* get the size of the frames */
+const cv::Size SyntheticFrameSource::getFrameSize(){
+    return this->frame.size();
+}
+
+/* constructor (map the shared memory ring created by the producer) */
+ShmFrameSource::ShmFrameSource(const std::string& name):
+    BaseFrameSource(SOURCE_UNPACED)
+{
+    this->fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(this->fd == -1){
+        _ml::caution("Failed to open shared memory", name);
+        this->opened = false;
+        return;
+    }
+    struct stat shm_stat;
+    if(fstat(this->fd, &shm_stat) == -1 || (size_t)shm_stat.st_size < SHM_RING_HEADER_SIZE){
+        _ml::caution("Shared memory ring is invalid", name);
+        this->opened = false;
+        return;
+    }
+    this->map_size = shm_stat.st_size;
+    void *map_ptr = mmap(NULL, this->map_size, PROT_READ, MAP_SHARED, this->fd, 0);
+    if(map_ptr == MAP_FAILED){
+        _ml::caution("Failed to map shared memory", std::strerror(errno));
+        this->opened = false;
+        return;
+    }
+    this->map_ptr = (const unsigned char*)map_ptr;
+    
+    // check the header
+    this->header = (const ShmRingHeader*)this->map_ptr;
+    if(this->header->magic != SHM_RING_MAGIC || this->header->version != SHM_RING_VERSION){
+        _ml::caution("Shared memory ring is invalid", name);
+        this->opened = false;
+        return;
+    }
+    const uint64_t frame_size = (uint64_t)this->header->width * this->header->height * BGR_CHANNEL_NUM;
+    if(this->header->slot_num == 0 || this->header->slot_size < frame_size
+       || SHM_RING_HEADER_SIZE+this->header->slot_size*this->header->slot_num > this->map_size){
+        _ml::caution("Shared memory ring is broken", name);
+        this->opened = false;
+        return;
+    }
+    this->read_seq = __atomic_load_n(&this->header->write_seq, __ATOMIC_ACQUIRE);
+    _ml::notice("Reading frames from shared memory " + name + " with " + std::to_string(this->header->slot_num) + " slots");
+}
+
+/* destructor (unmap the shared memory) */
+ShmFrameSource::~ShmFrameSource(){
+    if(this->map_ptr != nullptr){
+        munmap((void*)this->map_ptr, this->map_size);
+    }
+    if(this->fd != -1){
+        close(this->fd);
+    }
+}
+
+/* wait for and refer to the latest frame (older frames are skipped to keep the latency low) */
+const bool ShmFrameSource::readFrame(cv::Mat& frame, int64_t& pts){
+    uint64_t write_seq = __atomic_load_n(&this->header->write_seq, __ATOMIC_ACQUIRE);
+    
+    // check if the producer has lapped the previous frame while it was encoded
+    if(this->read_seq > 0 && write_seq >= this->read_seq+this->header->slot_num){
+        _ml::warn("Shared memory frame was overwritten while encoding", "Increase the slots of the ring");
+    }
+    while(write_seq == this->read_seq){
+        std::this_thread::sleep_for(std::chrono::milliseconds(SHM_POLL_INTERVAL));
+        write_seq = __atomic_load_n(&this->header->write_seq, __ATOMIC_ACQUIRE);
+    }
+    this->read_seq = write_seq;
+    
+    // refer to the slot of the latest frame without copying
+    const uint64_t slot = (write_seq-1) % this->header->slot_num;
+    const unsigned char *slot_ptr = this->map_ptr + SHM_RING_HEADER_SIZE + slot*this->header->slot_size;
+    frame = cv::Mat(this->header->height, this->header->width, CV_8UC3, (void*)slot_ptr);
+    return true;
+}
+
+/* get the size of the frames */
+const cv::Size ShmFrameSource::getFrameSize(){
+    return cv::Size(this->header->width, this->header->height);
+}
+
+/* constructor (open the device and start capturing) */
+V4l2FrameSource::V4l2FrameSource(const std::string& device, const int width, const int height, const int fps):
+    BaseFrameSource(SOURCE_UNPACED)
+{
+    this->fd = open(device.c_str(), O_RDWR);
+    if(this->fd == V4L2_FAILED){
+        _ml::caution("Failed to open V4L2 device", device);
+        this->opened = false;
+        return;
+    }
+    if(!this->setFormat(width, height, fps) || !this->mapBuffers()){
+        this->opened = false;
+        return;
+    }
+    enum v4l2_buf_type buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if(ioctl(this->fd, VIDIOC_STREAMON, &buf_type) == V4L2_FAILED){
+        _ml::caution("Failed to start V4L2 capture", std::strerror(errno));
+        this->opened = false;
+        return;
+    }
+    _ml::notice("Capturing " + device + " at " + std::to_string(this->width) + "x" + std::to_string(this->height));
+}
+
+/* destructor (stop capturing and release the buffers) */
+V4l2FrameSource::~V4l2FrameSource(){
+    enum v4l2_buf_type buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if(this->fd == V4L2_FAILED){
+        return;
+    }
+    ioctl(this->fd, VIDIOC_STREAMOFF, &buf_type);
+    for(int i=0; i<int(this->buf_ptrs.size()); ++i){
+        munmap(this->buf_ptrs[i], this->buf_sizes[i]);
+    }
+    close(this->fd);
+}
+
+/* set the format of the device (the size and the frame rate are kept as the device default if 0) */
+const bool V4l2FrameSource::setFormat(const int width, const int height, const int fps){
+    struct v4l2_format format;
+    std::memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if(ioctl(this->fd, VIDIOC_G_FMT, &format) == V4L2_FAILED){
+        _ml::caution("Could not get V4L2 format", std::strerror(errno));
+        return false;
+    }
+    if(width > 0 && height > 0){
+        format.fmt.pix.width = width;
+        format.fmt.pix.height = height;
+    }
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+    format.fmt.pix.field = V4L2_FIELD_NONE;
+    if(ioctl(this->fd, VIDIOC_S_FMT, &format) == V4L2_FAILED || format.fmt.pix.pixelformat != V4L2_PIX_FMT_YUYV){
+        _ml::caution("V4L2 device does not support YUYV", std::strerror(errno));
+        return false;
+    }
+    this->width = format.fmt.pix.width;
+    this->height = format.fmt.pix.height;
+    this->line_size = format.fmt.pix.bytesperline;
+    
+    // request the frame rate (the device may round it)
+    if(fps > 0){
+        struct v4l2_streamparm stream_param;
+        std::memset(&stream_param, 0, sizeof(stream_param));
+        stream_param.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        stream_param.parm.capture.timeperframe.numerator = 1;
+        stream_param.parm.capture.timeperframe.denominator = fps;
+        if(ioctl(this->fd, VIDIOC_S_PARM, &stream_param) == V4L2_FAILED){
+            _ml::warn("Could not set V4L2 frame rate", std::strerror(errno));
+        }
+    }
+    return true;
+}
+
+/* map and queue the capture buffers */
+const bool V4l2FrameSource::mapBuffers(){
+    struct v4l2_requestbuffers request;
+    std::memset(&request, 0, sizeof(request));
+    request.count = V4L2_BUFFER_NUM;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if(ioctl(this->fd, VIDIOC_REQBUFS, &request) == V4L2_FAILED || request.count == 0){
+        _ml::caution("Could not request V4L2 buffers", std::strerror(errno));
+        return false;
+    }
+    for(unsigned int i=0; i<request.count; ++i){
+        struct v4l2_buffer buf;
+        std::memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if(ioctl(this->fd, VIDIOC_QUERYBUF, &buf) == V4L2_FAILED){
+            _ml::caution("Could not query V4L2 buffer", std::strerror(errno));
+            return false;
+        }
+        void *buf_ptr = mmap(NULL, buf.length, PROT_READ|PROT_WRITE, MAP_SHARED, this->fd, buf.m.offset);
+        if(buf_ptr == MAP_FAILED){
+            _ml::caution("Failed to map V4L2 buffer", std::strerror(errno));
+            return false;
+        }
+        this->buf_ptrs.push_back(buf_ptr);
+        this->buf_sizes.push_back(buf.length);
+        if(ioctl(this->fd, VIDIOC_QBUF, &buf) == V4L2_FAILED){
+            _ml::caution("Could not queue V4L2 buffer", std::strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+/* capture the next frame (converted from the capture buffer, which is queued again right after) */
+const bool V4l2FrameSource::readFrame(cv::Mat& frame, int64_t& pts){
+    struct v4l2_buffer buf;
+    std::memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    int result;
+    do{
+        result = ioctl(this->fd, VIDIOC_DQBUF, &buf);
+    }while(result == V4L2_FAILED && errno == EINTR);
+    if(result == V4L2_FAILED){
+        _ml::warn("Could not capture V4L2 frame", std::strerror(errno));
+        return false;
+    }
+    const cv::Mat yuyv_frame(this->height, this->width, CV_8UC2, this->buf_ptrs[buf.index], this->line_size);
+    cv::cvtColor(yuyv_frame, this->frame, cv::COLOR_YUV2BGR_YUYV);
+    ioctl(this->fd, VIDIOC_QBUF, &buf);
+    frame = this->frame;
+    return true;
+}
+
+/* get the size of the frames */
+const cv::Size V4l2FrameSource::getFrameSize(){
+    return cv::Size(this->width, this->height);
+}
+
+/* check if the source has been opened */
+const bool BaseFrameSource::isOpened(){
+    return this->opened;
+}
+
+/* set the callback when the size of the next frames is known in advance (the size of the other sources is fixed) */
+void BaseFrameSource::setSizeCallback(const size_callback_t& callback){}
+
+/* constructor (open the first item and prefetch the second one) */
+PlaylistFrameSource::PlaylistFrameSource(const std::string& list_file, const int fps):
+    BaseFrameSource(fps)
+{
+    if(!this->loadList(list_file)){
+        this->opened = false;
+        return;
+    }
+    this->current = this->openItem(0);
+    if(this->current.index == PLAYLIST_ITEM_NONE){
+        _ml::caution("No item in playlist could be played", list_file);
+        this->opened = false;
+        return;
+    }
+    this->prefetch_thre = std::thread(&PlaylistFrameSource::prefetch, this, this->current.index+1, nullptr);
+    _ml::notice("Playing " + std::to_string(this->paths.size()) + " videos in " + list_file);
+}
+
+/* destructor (wait for the prefetch thread) */
+PlaylistFrameSource::~PlaylistFrameSource(){
+    if(this->prefetch_thre.joinable()){
+        this->prefetch_thre.join();
+    }
+}
+
+/* read the paths in a playlist file (a path per line, and the empty lines and the lines starting with # are skipped) */
+const bool PlaylistFrameSource::loadList(const std::string& list_file){
+    std::ifstream file(list_file);
+    if(!file){
+        _ml::caution("Failed to open playlist", list_file);
+        return false;
+    }
+    std::string line;
+    while(std::getline(file, line)){
+        line.erase(line.find_last_not_of(" \t\r")+1);
+        if(!line.empty() && line[0] != '#'){
+            this->paths.push_back(line);
+        }
+    }
+    if(this->paths.empty()){
+        _ml::caution("Playlist is empty", list_file);
+        return false;
+    }
+    return true;
+}
+
+/* open an item and decode its first frames (the items which cannot be played are skipped) */
+PlaylistItem PlaylistFrameSource::openItem(const int index){
+    PlaylistItem item;
+    const int path_num = this->paths.size();
+    for(int i=0; i<path_num; ++i){
+        const int item_index = (index+i) % path_num;
+        const source_ptr_t source = std::make_shared<VideoFrameSource>(this->paths[item_index], SOURCE_UNPACED);
+        if(!source->isOpened()){
+            continue;
+        }
+        
+        // decode the first frames so that the item starts without waiting for the decoder
+        item.frames.clear();
+        item.pts_list.clear();
+        for(int j=0; j<PLAYLIST_PREROLL_NUM; ++j){
+            cv::Mat frame;
+            int64_t pts;
+            if(!source->read(frame, pts)){
+                break;
+            }
+            item.frames.push_back(frame);
+            item.pts_list.push_back(pts);
+        }
+        if(item.frames.empty()){
+            _ml::warn("Skipped playlist item", "No frame in " + this->paths[item_index]);
+            continue;
+        }
+        item.index = item_index;
+        item.source = source;
+        return item;
+    }
+    return item;
+}
+
+/* open the next item in the background (the finished item is also released here) */
+void PlaylistFrameSource::prefetch(const int index, source_ptr_t finished){
+    finished.reset();
+    this->next = this->openItem(index % this->paths.size());
+    if(this->next.index == PLAYLIST_ITEM_NONE){
+        return;
+    }
+    
+    // let the encoder prepare for the frame size of the next item
+    const cv::Size size = this->next.frames[0].size();
+    size_callback_t callback;
+    {
+        std::lock_guard<std::mutex> lock(this->lock);
+        this->next_size = size;
+        callback = this->size_callback;
+    }
+    if(callback){
+        callback(size);
+    }
+}
+
+/* switch to the next item (false if no item can be played) */
+const bool PlaylistFrameSource::advance(){
+    this->prefetch_thre.join();
+    if(this->next.index == PLAYLIST_ITEM_NONE){
+        return false;
+    }
+    source_ptr_t finished = std::move(this->current.source);
+    this->current = std::move(this->next);
+    this->next = PlaylistItem();
+    this->preroll_index = 0;
+    this->pts_offset = this->last_pts + this->last_interval;
+    {
+        std::lock_guard<std::mutex> lock(this->lock);
+        this->next_size = cv::Size();
+    }
+    this->prefetch_thre = std::thread(&PlaylistFrameSource::prefetch, this, this->current.index+1, finished);
+    _ml::notice("Playing " + this->paths[this->current.index]);
+    return true;
+}
+
+/* read the next frame of the playlist (the timestamps continue across the items) */
+const bool PlaylistFrameSource::readFrame(cv::Mat& frame, int64_t& pts){
+    int64_t item_pts;
+    if(this->preroll_index < this->current.frames.size()){
+        frame = this->current.frames[this->preroll_index];
+        item_pts = this->current.pts_list[this->preroll_index];
+        ++this->preroll_index;
+    }else if(!this->current.source->read(frame, item_pts)){
+        if(!this->advance()){
+            return false;
+        }
+        return this->readFrame(frame, pts);
+    }
+    
+    pts = this->pts_offset + item_pts;
+    if(pts > this->last_pts){
+        this->last_interval = pts - this->last_pts;
+    }
+    this->last_pts = pts;
+    return true;
+}
+
+/* get the size of the frames of the current item */
+const cv::Size PlaylistFrameSource::getFrameSize(){
+    return this->current.frames[0].size();
+}
+
+/* set the callback when the next item is opened (called at once if it has been opened) */
+void PlaylistFrameSource::setSizeCallback(const size_callback_t& callback){
+    cv::Size size;
+    {
+        std::lock_guard<std::mutex> lock(this->lock);
+        this->size_callback = callback;
+        size = this->next_size;
+    }
+    if(size.area() > 0){
+        callback(size);
+    }
+}
+
+/* create the source of a type (the path of a video, the pattern, the shared memory name or the device) */
+const source_ptr_t createFrameSource(const source_params_t& params){
+    std::string src_type, src;
+    int width, height, fps;
+    std::tie(src_type, src, width, height, fps) = params;
+    source_ptr_t source;
+    if(src_type == SOURCE_SYNTHETIC){
+        source = std::make_shared<SyntheticFrameSource>(src, width, height, fps);
+    }else if(src_type == SOURCE_SHM){
+        source = std::make_shared<ShmFrameSource>(src);
+    }else if(src_type == SOURCE_V4L2){
+        source = std::make_shared<V4l2FrameSource>(src, width, height, fps);
+    }else if(src_type == SOURCE_PLAYLIST){
+        source = std::make_shared<PlaylistFrameSource>(src, fps);
+    }else{
+        source = std::make_shared<VideoFrameSource>(src, fps);
+    }
+    
+    // the caller decides whether a failed source is fatal
+    if(!source->isOpened()){
+        return nullptr;
+    }
+    return source;
+}
@@ -8,78 +8,145 @@
 /* constructor */
 FrontendServer::FrontendServer(_asio::io_service& ios, ConfigParser& parser, const int fs_port):
     ios(ios),
-    acc(ios, _ip::tcp::endpoint(_ip::tcp::v4(), fs_port))
+    parser(parser),
+    signals(ios, SIGHUP),
+    acc(ios, _ip::tcp::endpoint(_ip::tcp::v4(), fs_port)),
+    io_params(parser.getIoParams()),
+    sync_shards(io_params, THREAD_ROLE_SYNC),
+    conn_table(parser.getConnections())
 {
     // get the parameters from the config parser
-    std::string src, ycbcr_format_name;
-    int column, row, bezel_w, bezel_h, width, height, stream_port, sendbuf_num, recvbuf_num;
-    int target_fps, quality, dec_thre_num, tuning_term;
+    std::string src;
+    int column, row, bezel_w, bezel_h, target_fps, ycbcr_format, tuning_term;
     double fps_jitter;
     std::tie(
-        src, target_fps, fps_jitter, column, row, bezel_w, bezel_h, width, height, stream_port,
-        sendbuf_num, recvbuf_num, ycbcr_format_name, quality, dec_thre_num, tuning_term, this->ip_addrs
+        src, target_fps, fps_jitter, column, row, bezel_w, bezel_h, this->width, this->height, this->stream_port,
+        this->sendbuf_num, std::ignore, ycbcr_format, std::ignore, std::ignore, tuning_term, this->ip_addrs
     ) = parser.getFrontendServerParams();
     this->display_num = column * row;
+    this->layout = std::forward_as_tuple(column, row, bezel_w, bezel_h);
+    this->source_params = parser.getSourceParams();
+    this->media_clock = parser.useMediaClock();
+    this->windows = parser.getWindows();
+    this->conns = parser.getConnections();
+    this->sock_params = parser.getSocketParams();
+    this->backend = parser.getTransportBackend();
+    this->nodes = parser.getNodes();
     
-    // set the initial YCbCr format
-    int ycbcr_format;
-    if(ycbcr_format_name == "4:4:4"){
-        ycbcr_format = TJSAMP_444;
-    }else if(ycbcr_format_name == "4:2:2"){
-        ycbcr_format = TJSAMP_422;
-    }else if(ycbcr_format_name == "4:2:0"){ 
-        ycbcr_format = TJSAMP_420;
-    }else{
-        _ml::caution("YCbCr format is invalid", "Check config file");
-        std::exit(EXIT_FAILURE);
+    // the frame index wraps at the same page on every node, so the view framebuffers are sized for the most decoders
+    this->viewbuf_num = 0;
+    for(const node_params_t& node : this->nodes){
+        this->viewbuf_num = std::max(this->viewbuf_num, std::get<3>(node)+VIEWBUF_EXTRA_NUM);
     }
     
-    // set the parameters packed in the initial message
-    this->init_params.setIntParam("width", width);
-    this->init_params.setIntParam("height", height);
-    this->init_params.setIntParam("stream_port", stream_port);
+    // set the parameters packed in the initial message (the settings of each display node are added for it)
+    this->init_params.setIntParam("stream_port", this->stream_port);
     this->init_params.setIntParam("target_fps", target_fps);
     this->init_params.setDoubleParam("fps_jitter", fps_jitter);
-    this->init_params.setIntParam("recvbuf_num", recvbuf_num);
-    this->init_params.setIntParam("dec_thre_num", dec_thre_num);
+    this->init_params.setIntParam("viewbuf_num", this->viewbuf_num);
     this->init_params.setIntParam("tuning_term", tuning_term);
-    this->init_params.setIntParam("ycbcr_format", ycbcr_format);
-    this->init_params.setIntParam("quality", quality);
     
     // set the other parameters
     this->sock = std::make_shared<_ip::tcp::socket>(ios);
-    this->socks = std::vector<sock_ptr_t>(this->display_num);
     this->send_bufs = std::vector<tranbuf_ptr_t>(this->display_num);
     this->ycbcr_format_list = jpeg_params_t(this->display_num);
     this->quality_list = jpeg_params_t(this->display_num);
     for(int i=0; i<this->display_num; ++i){
-        this->send_bufs[i] = std::make_shared<TransceiveFramebuffer>(sendbuf_num);
+        this->send_bufs[i] = std::make_shared<TransceiveFramebuffer>(this->sendbuf_num, SENDBUF_NUM_MAX);
         this->ycbcr_format_list[i].store(ycbcr_format, std::memory_order_release);
-        this->quality_list[i].store(quality, std::memory_order_release);
-    }
-    
-    // launch the encoder thread
-    this->enc_thre = std::thread(std::bind(&FrontendServer::runFrameEncoder,
-                                           this,
-                                           src,
-                                           column,
-                                           row,
-                                           bezel_w,
-                                           bezel_h,
-                                           width,
-                                           height)
-    );
+        this->quality_list[i].store(std::get<5>(this->nodes[i]), std::memory_order_release);
+    }
+    this->initMetrics();
+    
+    if(!this->windows.empty()){
+        // composite the windows of the sources (each source is read and resized in its own thread)
+        const compositor_ptr_t compositor = std::make_shared<WindowCompositor>(this->windows);
+        if(!compositor->isOpened()){
+            std::exit(EXIT_FAILURE);
+        }
+        this->encoder.reset(new FrameEncoder(compositor,
+                                             column,
+                                             row,
+                                             bezel_w,
+                                             bezel_h,
+                                             this->width,
+                                             this->height,
+                                             parser.getTileShapes(),
+                                             this->ycbcr_format_list,
+                                             this->quality_list,
+                                             this->send_bufs
+        ));
+        this->encoder->setTileCodec(parser.getTileCodec());
+        compositor->run();
+        this->enc_thre = std::thread(std::bind(&FrontendServer::runFrameEncoder, this));
+    }else if(parser.getSourceType() == SOURCE_TILE_CONTAINER){
+        // stream the pre-encoded JPEG tiles without the encoder
+        this->container = std::make_shared<TileContainer>(src, this->display_num);
+    }else{
+        // open the source before launching the encoder thread
+        const source_ptr_t source = createFrameSource(this->source_params);
+        if(!source){
+            std::exit(EXIT_FAILURE);
+        }
+        this->encoder.reset(new FrameEncoder(source,
+                                             this->media_clock,
+                                             column,
+                                             row,
+                                             bezel_w,
+                                             bezel_h,
+                                             this->width,
+                                             this->height,
+                                             parser.getTileShapes(),
+                                             this->ycbcr_format_list,
+                                             this->quality_list,
+                                             this->send_bufs
+        ));
+        this->encoder->setTileCodec(parser.getTileCodec());
+        this->enc_thre = std::thread(std::bind(&FrontendServer::runFrameEncoder, this));
+    }
     
     // launch the sender thread
     this->send_thre = std::thread(std::bind(&FrontendServer::runFrameSender,
                                             this,
-                                            stream_port,
-                                            dec_thre_num+VIEWBUF_EXTRA_NUM)
+                                            this->stream_port,
+                                            this->viewbuf_num)
     );
     
+    // launch the sync manager (the nodes join it whenever they connect, and get the overlays with the sync messages)
+    this->overlays.reset(new OverlayManager(parser.getOverlays(), column, row, bezel_w, bezel_h, parser.getBlendGamma(),
+                                            this->width, this->height, parser.getTileShapes()));
+    this->manager.reset(new SyncManager(this->sync_shards,
+                                        this->conn_table,
+                                        this->conns,
+                                        parser.getSyncTimeout(),
+                                        this->ycbcr_format_list,
+                                        this->quality_list,
+                                        *this->overlays
+    ));
+    this->manager->run();
+    
     // start waiting for the display node connection
     _ml::notice("Waiting for display node connection at :" + std::to_string(fs_port));
     this->waitForConnection();
+    this->waitForSignal();
+}
+
+/* register the gauges of the display nodes (evaluated on each scrape) */
+void FrontendServer::initMetrics(){
+    for(int i=0; i<this->display_num; ++i){
+        const std::string labels = _mt::labels({{"display", std::to_string(i)}});
+        _mt::addGauge("tdw_send_queue_depth", "JPEG frames stored in the send framebuffer", labels,
+                      std::bind(&TransceiveFramebuffer::getStoredNum, this->send_bufs[i]));
+        _mt::addGauge("tdw_jpeg_quality", "Quality factor applied for each display node", labels,
+                      std::bind(&FrontendServer::getJpegParam, this, std::ref(this->quality_list), i));
+        _mt::addGauge("tdw_jpeg_subsampling", "YCbCr format applied for each display node", labels,
+                      std::bind(&FrontendServer::getJpegParam, this, std::ref(this->ycbcr_format_list), i));
+    }
+}
+
+/* get a JPEG parameter applied for a display node */
+const double FrontendServer::getJpegParam(jpeg_params_t& params, const int id){
+    return params[id].load(std::memory_order_acquire);
 }
 
 /* start waiting for the display node connection */
@@ -89,93 +156,262 @@ void FrontendServer::waitForConnection(){
     );
 }
 
-/* the callback when connected by the display node */
+/* make the initial message for a connection (a reconnecting display node gets its last JPEG parameters) */
+const std::string FrontendServer::makeInitMsg(const int id){
+    JsonHandler conn_params = this->init_params;
+    const conn_params_t& conn = this->conns[id];
+    if(std::get<2>(conn)){
+        // a relay node gets its display nodes in addition
+        std::string display_ids, display_ips;
+        for(const int display_id : std::get<1>(conn)){
+            display_ids += (display_ids.empty() ? "" : ",") + std::to_string(display_id);
+            display_ips += (display_ips.empty() ? "" : ",") + this->ip_addrs[display_id];
+        }
+        conn_params.setStringParam("display_ids", display_ids);
+        conn_params.setStringParam("display_ips", display_ips);
+        for(const int display_id : std::get<1>(conn)){
+            this->setNodeParams(conn_params, display_id, std::to_string(display_id) + ".");
+        }
+    }else{
+        this->setNodeParams(conn_params, std::get<1>(conn)[0], "");
+    }
+    return conn_params.serialize() + MSG_DELIMITER;
+}
+
+/* set the parameters of a display node in the initial message (a relay node hands them to the node by its ID) */
+void FrontendServer::setNodeParams(JsonHandler& params, const int display_id, const std::string& key_prefix){
+    int width, height, dec_thre_num, recvbuf_num;
+    std::tie(width, height, std::ignore, dec_thre_num, recvbuf_num, std::ignore) = this->nodes[display_id];
+    params.setIntParam(key_prefix+"width", width);
+    params.setIntParam(key_prefix+"height", height);
+    params.setIntParam(key_prefix+"recvbuf_num", recvbuf_num);
+    params.setIntParam(key_prefix+"dec_thre_num", dec_thre_num);
+    params.setIntParam(key_prefix+"ycbcr_format", this->ycbcr_format_list[display_id].load(std::memory_order_acquire));
+    params.setIntParam(key_prefix+"quality", this->quality_list[display_id].load(std::memory_order_acquire));
+}
+
+/* the callback when connected by the display node or the relay node */
 void FrontendServer::onConnect(const err_t& err){
-    const std::string ip_addr = this->sock->remote_endpoint().address().to_string();
+    // keep waiting for the other nodes and the reconnecting nodes (the handshakes run concurrently)
+    const sock_ptr_t sock = this->sock;
+    this->sock = std::make_shared<_ip::tcp::socket>(this->ios);
+    this->waitForConnection();
+    if(err){
+        _ml::warn("Could not accept node", err.message());
+        return;
+    }
+    
+    // receive the hello message to identify the node
+    const streambuf_ptr_t hello_buf = std::make_shared<_asio::streambuf>(HELLO_SIZE_MAX);
+    _asio::async_read_until(*sock,
+                            *hello_buf,
+                            MSG_DELIMITER,
+                            boost::bind(&FrontendServer::onRecvHello, this, _ph::error, _ph::bytes_transferred,
+                                        sock, hello_buf)
+    );
+}
+
+/* the callback when receiving the hello message (a node is found by its node ID, or by its IP address without it) */
+void FrontendServer::onRecvHello(const err_t& err, size_t t_bytes, const sock_ptr_t sock,
+                                 const streambuf_ptr_t hello_buf)
+{
+    err_t ep_err;
+    const std::string ip_addr = sock->remote_endpoint(ep_err).address().to_string();
     if(err){
-        _ml::caution("Could not accept " + ip_addr, err.message());
-        std::exit(EXIT_FAILURE);
+        _ml::warn("Could not receive hello message from " + ip_addr, err.message());
         return;
     }
     
-    // check the ID of the display node
-    const auto iter = std::find(this->ip_addrs.begin(), this->ip_addrs.end(), ip_addr);
-    const size_t id = std::distance(this->ip_addrs.begin(), iter);
-    if(id == this->ip_addrs.size()){
-        _ml::caution(ip_addr + " is not registered", "Check config file");
-        std::exit(EXIT_FAILURE);
+    // check the ID of the connection
+    const auto data = hello_buf->data();
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
+    const std::string node_key = parseHelloMsg(recv_msg, ip_addr);
+    const int id = findConnection(this->conns, node_key);
+    if(ep_err || id == CONN_NOT_FOUND){
+        _ml::warn(node_key + " (" + ip_addr + ") is not registered", "Check config file");
         return;
+    }else if(std::get<2>(this->conns[id])){
+        _ml::notice("Accepted relay node: " + node_key);
     }else{
-        _ml::notice("Accepted new display node: " + ip_addr);
+        _ml::notice("Accepted display node: " + node_key);
     }
+    setSocketOptions(*sock, this->sock_params);
+    const int gen = this->conn_table.join(id);
     
-    // send the initial message to the display node
-    const std::string send_msg = this->init_params.serialize() + MSG_DELIMITER;
-    _asio::async_write(*this->sock,
-                       _asio::buffer(send_msg),
-                       boost::bind(&FrontendServer::onSendInit, this, _ph::error, _ph::bytes_transferred, ip_addr)
+    // send the initial message to the node
+    const std::shared_ptr<std::string> init_msg = std::make_shared<std::string>(this->makeInitMsg(id));
+    _asio::async_write(*sock,
+                       _asio::buffer(*init_msg),
+                       boost::bind(&FrontendServer::onSendInit, this, _ph::error, _ph::bytes_transferred,
+                                   id, gen, sock, init_msg)
     );
-    
-    // prepare for a new TCP socket
-    this->socks[id] = this->sock;
-    this->sock = std::make_shared<_ip::tcp::socket>(this->ios);
 }
 
 /* the callback when sending the initial message */
-void FrontendServer::onSendInit(const err_t& err, size_t t_bytes, const std::string ip){
+void FrontendServer::onSendInit(const err_t& err, size_t t_bytes, const int id, const int gen, const sock_ptr_t sock,
+                                const std::shared_ptr<std::string> init_msg)
+{
     if(err){
-        _ml::caution("Failed to send init message to " + ip, err.message());
-        std::exit(EXIT_FAILURE);
+        this->conn_table.drop(id, gen, "Failed to send init message: " + err.message());
+        return;
     }
     
-    // repeat the same process until all the display nodes connect
-    ++this->connected_num;
-    if(this->connected_num < this->display_num){
-        this->waitForConnection();
-    }else{
-        // launch the sync manager in this thread
-        _ml::notice("All display nodes connected");
-        this->sock->close();
-        this->runSyncManager();
-    }
+    // receive the sync messages (the node joins the barrier from the first frame sent to it)
+    this->manager->addConnection(id, gen, sock);
 }
 
 /* launch the frame encoder */
-void FrontendServer::runFrameEncoder(const std::string video_src, const int column, const int row,
-                                     const int bezel_w, const int bezel_h, const int width, const int height)
-{
-    FrameEncoder encoder(video_src,
-                         column,
-                         row,
-                         bezel_w,
-                         bezel_h,
-                         width,
-                         height,
-                         this->ycbcr_format_list,
-                         this->quality_list,
-                         this->send_bufs
-    );
-    encoder.run();
+void FrontendServer::runFrameEncoder(){
+    _ft::setThreadName("encoder");
+    placeThread(THREAD_ROLE_ENCODER, 0, CORE_NOT_PINNED);
+    this->encoder->run();
 }
 
 /* launch the frame sender */
 void FrontendServer::runFrameSender(const int stream_port, const int viewbuf_num){
+    _ft::setThreadName("sender");
+    placeThread(THREAD_ROLE_SENDER, 0, CORE_NOT_PINNED);
+    std::unique_ptr<BaseFrameSender> sender;
     _asio::io_service ios;
-    FrameSender sender(ios,
-                       stream_port,
-                       this->display_num,
-                       this->send_bufs,
-                       viewbuf_num
-    );
+    if(this->backend == TRANSPORT_IO_URING){
+        sender.reset(new UringFrameSender(stream_port,
+                                          this->display_num,
+                                          this->conns,
+                                          this->send_bufs,
+                                          viewbuf_num,
+                                          this->container,
+                                          this->sock_params,
+                                          this->conn_table
+        ));
+    }else{
+        sender.reset(new FrameSender(ios,
+                                     stream_port,
+                                     this->display_num,
+                                     this->conns,
+                                     this->send_bufs,
+                                     viewbuf_num,
+                                     this->container,
+                                     this->sock_params,
+                                     this->io_params,
+                                     this->conn_table
+        ));
+    }
+    sender->run();
 }
 
-/* launch the sync manager */
-void FrontendServer::runSyncManager(){
-    SyncManager manager(this->ios,
-                        this->socks,
-                        this->ycbcr_format_list,
-                        this->quality_list
-    );
-    manager.run();
+/* start waiting for SIGHUP (e.g. kill -HUP after editing the config file) */
+void FrontendServer::waitForSignal(){
+    this->signals.async_wait(boost::bind(&FrontendServer::onSignal, this, _ph::error, _ph::signal_number));
+}
+
+/* the callback when SIGHUP is received */
+void FrontendServer::onSignal(const err_t& err, const int signum){
+    if(err){
+        return;
+    }
+    _ml::notice("Reloading config file");
+    this->reload();
+    this->waitForSignal();
+}
+
+/* apply the config file read again (the parameters shared with the running nodes are kept) */
+void FrontendServer::reload(){
+    if(!this->parser.reload()){
+        _ml::warn("Config file was not reloaded", "The current parameters are kept");
+        return;
+    }
+    std::string src;
+    int column, row, bezel_w, bezel_h, width, height, stream_port, sendbuf_num, target_fps, tuning_term;
+    double fps_jitter;
+    ip_list_t ip_addrs;
+    std::tie(
+        src, target_fps, fps_jitter, column, row, bezel_w, bezel_h, width, height, stream_port,
+        sendbuf_num, std::ignore, std::ignore, std::ignore, std::ignore, tuning_term, ip_addrs
+    ) = this->parser.getFrontendServerParams();
+    
+    // the nodes, the resolution, the tiles, the ports and the view framebuffers are fixed while the nodes are running
+    const node_list_t nodes = this->parser.getNodes();
+    bool nodes_fixed = int(nodes.size()) == this->display_num;
+    for(int i=0; nodes_fixed && i<this->display_num; ++i){
+        node_params_t node = nodes[i];
+        std::get<4>(node) = std::get<4>(this->nodes[i]);
+        std::get<5>(node) = std::get<5>(this->nodes[i]);
+        nodes_fixed = node == this->nodes[i];
+    }
+    if(column*row != this->display_num || width != this->width || height != this->height || !nodes_fixed
+       || stream_port != this->stream_port || ip_addrs != this->ip_addrs
+       || this->parser.getConnections() != this->conns || this->parser.getTransportBackend() != this->backend
+       || this->parser.getFrontendServerPort() != this->acc.local_endpoint().port()){
+        _ml::warn("Some parameters were not changed", "Restart head_server to change the nodes, the resolution, the ports, the decoders or the backend");
+    }
+    
+    // the nodes joining from now get the new parameters (the live nodes keep theirs until they reconnect)
+    this->init_params.setIntParam("target_fps", target_fps);
+    this->init_params.setDoubleParam("fps_jitter", fps_jitter);
+    this->init_params.setIntParam("tuning_term", tuning_term);
+    for(int i=0; i<this->display_num && i<int(nodes.size()); ++i){
+        std::get<4>(this->nodes[i]) = std::get<4>(nodes[i]);
+    }
+    this->manager->setSyncTimeout(this->parser.getSyncTimeout());
+    
+    // send the overlays and the edges to blend again to all the display nodes with their next sync messages
+    if(column*row == this->display_num){
+        this->overlays->setOverlays(this->parser.getOverlays(), column, row, bezel_w, bezel_h, this->parser.getBlendGamma());
+    }
+    
+    // resize the send framebuffers in place (the queued frames are kept)
+    if(sendbuf_num != this->sendbuf_num){
+        for(const tranbuf_ptr_t& send_buf : this->send_bufs){
+            send_buf->setCapacity(sendbuf_num);
+        }
+        this->sendbuf_num = sendbuf_num;
+        _ml::notice("Send framebuffer capacity is changed to " + std::to_string(sendbuf_num));
+    }
+    
+    if(!this->encoder){
+        if(this->parser.getSourceType() != SOURCE_TILE_CONTAINER || src != std::get<1>(this->source_params)){
+            _ml::warn("Tile container was not switched", "Restart head_server to change it");
+        }
+        return;
+    }
+    
+    // choose the codec from the next tile
+    this->encoder->setTileCodec(this->parser.getTileCodec());
+    
+    // re-tile the frames at the next frame
+    const layout_params_t layout = std::forward_as_tuple(column, row, bezel_w, bezel_h);
+    if(column*row == this->display_num && layout != this->layout){
+        this->encoder->setLayout(layout);
+        this->layout = layout;
+    }
+    
+    // the sources of the windows are opened only at startup
+    if(!this->windows.empty() || !this->parser.getWindows().empty()){
+        if(this->parser.getWindows() != this->windows){
+            _ml::warn("Windows were not changed", "Restart head_server to change the windows");
+        }
+        return;
+    }
+    
+    // switch the video source at the next frame
+    const source_params_t source_params = this->parser.getSourceParams();
+    const bool media_clock = this->parser.useMediaClock();
+    if(this->parser.getSourceType() == SOURCE_TILE_CONTAINER){
+        _ml::warn("Video source was not switched", "Restart head_server to stream a tile container");
+    }else if(source_params != this->source_params || media_clock != this->media_clock){
+        this->switchSource(source_params, media_clock);
+    }
 }
 
+/* switch the video source without stopping the encoder (the current source is kept until the new one is opened) */
+void FrontendServer::switchSource(const source_params_t& params, const bool media_clock){
+    const source_ptr_t source = createFrameSource(params);
+    if(!source){
+        _ml::warn("Video source was not switched", "The current source is kept");
+        return;
+    }
+    this->encoder->switchSource(source, media_clock);
+    this->source_params = params;
+    this->media_clock = media_clock;
+}
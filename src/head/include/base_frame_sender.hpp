@@ -0,0 +1,74 @@
+/****************************************
+*         base_frame_sender.hpp         *
+*  (super class of JPEG frame senders)  *
+****************************************/
+
+#ifndef BASE_FRAME_SENDER_HPP
+#define BASE_FRAME_SENDER_HPP
+
+#include "async_logger.hpp"
+#include "socket_utils.hpp"
+#include "transceive_framebuffer.hpp"
+#include "tile_container.hpp"
+#include "frame_tracer.hpp"
+#include "metrics.hpp"
+#include "connection_table.hpp"
+#include <vector>
+#include <mutex>
+extern "C"{
+    #include <sys/socket.h>
+}
+
+/* super class of JPEG frame senders */
+class BaseFrameSender{
+    protected:
+        const int display_num;                                    // the number of the displays
+        const conn_list_t conns;                                  // the connections to the display nodes and the relay nodes
+        const int conn_num;                                       // the number of the connections
+        int fb_id = 0;                                            // the index in the view framebuffer
+        const int viewbuf_num;                                    // the number of domains in the view framebuffer
+        std::string send_head;                                    // the header of the send messages
+        std::vector<std::string> send_msgs;                       // the JPEG frames in the send messages
+        std::vector<_asio::const_buffer> jpeg_bufs;               // the buffers of the JPEG frames to be sent
+        std::vector<std::string> tile_sizes;                      // the size fields of the JPEG frames for the relay nodes
+        std::vector<std::vector<_asio::const_buffer>> send_seqs;  // the buffer sequences of the send messages
+        std::vector<tranbuf_ptr_t>& send_bufs;                    // the send framebuffer
+        const container_ptr_t container;                          // the pre-encoded tile container
+        int container_frame = 0;                                  // the index of the next frame in the tile container
+        const sockopt_params_t sock_params;                       // the options of the TCP sockets
+        const bool tcp_cork;                                      // the flag to cork the TCP sockets while sending a frame
+        int frame_seq = -1;                                       // the sequence number of the frame being sent
+        int64_t send_t = 0;                                       // the time to start sending the frame
+        std::vector<hist_ptr_t> send_hists;                       // the latency histograms of sending a frame to the connections
+        std::vector<counter_ptr_t> sent_bytes;                    // the sent bytes to the connections
+        counter_ptr_t sent_frames;                                // the number of the frames sent to all the connections
+        ConnectionTable& table;                                   // the states of the connections
+        std::mutex conn_lock;                                     // the mutex lock of the stream connections
+        std::vector<int> live_gens;                               // the generations of the live stream connections
+        std::vector<int> pending_gens;                            // the generations of the stream connections waiting to be admitted
+        std::vector<int> frame_conns;                             // the connections the current frame is sent to
+        bool idle = true;                                         // the flag not to be sending a frame (no connection is live)
+        
+        const bool prepareFrame();                                 // prepare the JPEG frames to be sent next
+        void recordSent(const int id);                             // record a completed send message
+        const std::string formatTileSize(const size_t size);       // format the size field of a JPEG frame
+        const bool addStream(const int id);                        // register an accepted stream connection
+        void updateStreams();                                      // release the dropped connections and admit the new ones
+        void dropStream(const int id, const std::string& reason);  // drop a live connection failing to send a frame
+        void onDrop(const int id);                                 // the callback when a connection is dropped
+        virtual void admitSocket(const int id) = 0;                // make the pending socket of a connection live
+        virtual void releaseSocket(const int id,                   // close the socket of a connection
+                                   const bool pending) = 0;
+        virtual void shutdownSocket(const int id,                  // shut down the socket of a connection (from any thread)
+                                    const bool pending) = 0;
+    
+    public:
+        BaseFrameSender(const int display_num, const conn_list_t& conns,  // constructor
+                        std::vector<tranbuf_ptr_t>& send_bufs, const int viewbuf_num,
+                        const container_ptr_t container, const sockopt_params_t& sock_params,
+                        ConnectionTable& table);
+        virtual ~BaseFrameSender(){}  // destructor
+        virtual void run() = 0;       // start sending JPEG frames
+};
+
+#endif  /* BASE_FRAME_SENDER_HPP */
@@ -8,40 +8,89 @@
 
 #include "socket_utils.hpp"
 #include "base_config_parser.hpp"
+#include "io_shards.hpp"
+#include "frame_source.hpp"
+#include "window_compositor.hpp"
+#include "overlay_manager.hpp"
+#include "tile_codec.hpp"
+#include "frame_encoder.hpp"
 #include <vector>
+extern "C"{
+    #include <turbojpeg.h>
+}
 
 using ip_list_t = std::vector<std::string>;
+using node_params_t = std::tuple<int, int, int, int, int, int>;
+using node_list_t = std::vector<node_params_t>;
 using fs_params_t = std::tuple<
-    std::string, int, double, int, int, int, int, int, int, int, int, int, std::string, int, int, int, ip_list_t
+    std::string, int, double, int, int, int, int, int, int, int, int, int, int, int, int, int, ip_list_t
 >;
 
+const std::string TRANSPORT_ASIO = "asio";          // the transport backend with Boost.Asio
+const std::string TRANSPORT_IO_URING = "io_uring";  // the transport backend with io_uring
+const int SYNC_TIMEOUT_DEFAULT = 3000;              // the default time to wait for the sync messages after the first one [ms]
+const int SENDBUF_NUM_MAX = 64;                     // the capacity allocated for each send framebuffer (resized up to it)
+
 /* parser of head_conf.json */
 class ConfigParser : public BaseConfigParser{
     private:
         std::string src;           // the video source
+        std::string src_type;      // the type of the video source
+        int src_width;             // the width of the generated or captured frames
+        int src_height;            // the height of the generated or captured frames
+        int src_fps;               // the frame rate to give the timestamps to the source
+        bool media_clock;          // the flag to pace the frames with the media clock
         int target_fps;            // the target frame rate
         double fps_jitter;         // the acceptable jitter of the frame rate
         int column;                // the number of displays in a horizontal direction
         int row;                   // the number of displays in a vertical direction
         int bezel_w;               // the length of each bezel in a horizontal direction
         int bezel_h;               // the height of each bezel in a vertical direction
+        double blend_gamma;        // the gamma of the projectors to blend the overlapping edges
         int width;                 // the number of horizontal pixels in each display
         int height;                // the numver of vertical pixels in each display
         int fs_port;               // the port number for the frontend server
         int stream_port;           // the port number for streaming JPEG frames
         int sendbuf_num;           // the number of domains in the send framebuffer
         int recvbuf_num;           // the number of domains in the receive framebuffer
-        std::string ycbcr_format;  // the initial value of the YCbCr format
+        int ycbcr_format;          // the initial value of the YCbCr format
         int quality;               // the initial value of the quality factor
         int dec_thre_num;          // the number of the decoder threads
         int tuning_term;           // the tuning term of the JPEG parameters
-        ip_list_t ip_addrs;        // the IP addresses of the display nodes
+        std::string tile_codec;    // the codec of the tiles
+        ip_list_t ip_addrs;        // the IP addresses (or the node IDs) of the display nodes
+        node_list_t nodes;         // the settings of each display node (the global ones unless overridden)
+        window_list_t windows;     // the windows of the sources composited on the wall
+        overlay_list_t overlays;   // the overlays composited by the display nodes
+        conn_list_t conns;         // the connections to the display nodes and the relay nodes
+        std::string backend;       // the transport backend to stream JPEG frames
+        int io_thre_num;           // the number of the I/O threads for the display nodes
+        bool pin_io_thres;         // the flag to pin each I/O thread to a core
+        int sync_timeout;          // the time to wait for the sync messages after the first one in a round
         
         const bool readParams(const _pt::ptree& conf) override;  // read the parameters
+        const bool readDisplayNodes(const _pt::ptree& conf);     // read the display nodes and their settings
+        const bool readRelayNodes(const _pt::ptree& conf);       // read the relay nodes
+        const bool readWindows(const _pt::ptree& conf);          // read the windows
+        const bool readOverlays(const _pt::ptree& conf);         // read the overlays
     
     public:
         ConfigParser(const std::string& filename);    // constructor
+        const bool reload();                          // read the config file again
         const int getFrontendServerPort();            // get the port number for the frontend server
+        const std::string getSourceType();            // get the type of the video source
+        const source_params_t getSourceParams();      // get the parameters of the video source
+        const bool useMediaClock();                   // check if the frames are paced with the media clock
+        const std::string getTransportBackend();      // get the transport backend
+        const conn_list_t getConnections();           // get the connections to the display nodes
+        const io_params_t getIoParams();              // get the parameters of the I/O threads
+        const int getSyncTimeout();                   // get the time to wait for the sync messages
+        const std::string getTileCodec();             // get the codec of the tiles
+        const window_list_t getWindows();             // get the windows of the sources
+        const overlay_list_t getOverlays();           // get the overlays on the display nodes
+        const double getBlendGamma();                 // get the gamma to blend the overlapping edges
+        const node_list_t getNodes();                 // get the settings of each display node
+        const tile_shape_list_t getTileShapes();      // get the size and the rotation of the tile of each display node
         const fs_params_t getFrontendServerParams();  // pass the parameters to the frontend server
 };
 
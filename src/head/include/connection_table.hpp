@@ -0,0 +1,48 @@
+/******************************************************
+*                connection_table.hpp                 *
+*  (states of the display nodes and the relay nodes)  *
+******************************************************/
+
+#ifndef CONNECTION_TABLE_HPP
+#define CONNECTION_TABLE_HPP
+
+#include "async_logger.hpp"
+#include "socket_utils.hpp"
+#include "metrics.hpp"
+#include <vector>
+#include <mutex>
+#include <functional>
+
+using drop_callback_t = std::function<void(const int)>;
+
+const int CONN_DOWN = 0;     // the state of a connection not connected
+const int CONN_JOINING = 1;  // the state of a connection waiting to be admitted at the next frame boundary
+const int CONN_LIVE = 2;     // the state of a connection streaming frames and joining the sync barrier
+const int CONN_NO_GEN = -1;  // the generation of a connection not connected
+
+/* states of the connections shared by the frontend server, the frame sender and the sync manager */
+class ConnectionTable{
+    private:
+        std::mutex lock;                              // the mutex lock of the states
+        std::vector<std::string> ip_addrs;            // the IP addresses of the connections
+        std::vector<int> states;                      // the states of the connections
+        std::vector<int> generations;                 // the number of the times each connection joined
+        std::vector<int> join_seqs;                   // the sequence numbers of the first frames sent to the live connections
+        std::vector<drop_callback_t> drop_callbacks;  // the callbacks when a connection is dropped
+        std::vector<counter_ptr_t> drop_counts;       // the number of the drops of each connection
+        
+        void notifyDrop(const int id);             // call the callbacks of a dropped connection
+        const double getStateValue(const int id);  // get the state of a connection for the metrics
+    
+    public:
+        ConnectionTable(const conn_list_t& conns);                          // constructor
+        void addDropCallback(const drop_callback_t& callback);              // add a callback when a connection is dropped
+        const int join(const int id);                                       // register a new control connection
+        const bool admit(const int id, const int gen, const int seq);       // make a joining connection live from a frame
+        void drop(const int id, const int gen, const std::string& reason);  // drop a connection
+        const int getState(const int id, const int gen);                    // get the state of a connection
+        const int getGeneration(const int id);                              // get the generation of a connection
+        const int getJoinSeq(const int id);                                 // get the sequence number of the first frame of a connection
+};
+
+#endif  /* CONNECTION_TABLE_HPP */
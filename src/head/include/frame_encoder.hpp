@@ -6,50 +6,121 @@
 #ifndef FRAME_ENCODER_HPP
 #define FRAME_ENCODER_HPP
 
-#include "mutex_logger.hpp"
+#include "async_logger.hpp"
 #include "sync_utils.hpp"
 #include "transceive_framebuffer.hpp"
+#include "frame_tracer.hpp"
+#include "metrics.hpp"
+#include "frame_source.hpp"
+#include "window_compositor.hpp"
+#include "frame_memory.hpp"
+#include "tile_codec.hpp"
 #include <cstdlib>
+#include <mutex>
 #include <opencv2/core.hpp>
-#include <opencv2/videoio.hpp>
 #include <opencv2/imgproc.hpp>
 extern "C"{
     #include <turbojpeg.h>
 }
 
+using layout_params_t = std::tuple<int, int, int, int>;
+using tile_shape_t = std::tuple<int, int, int>;
+using tile_shape_list_t = std::vector<tile_shape_t>;
+
 const int COLOR_CHANNEL_NUM = 3;  // the number of the color channels
 const int JPEG_FAILED = -1;       // the return value in failing JPEG encode
+const int ROTATION_NONE = 0;      // the angle not to rotate a tile
+const int ROTATION_90 = 90;       // the angle to rotate a tile clockwise by a quarter turn
+const int ROTATION_180 = 180;     // the angle to rotate a tile by a half turn
+const int ROTATION_270 = 270;     // the angle to rotate a tile counterclockwise by a quarter turn
+
+/* parameters to resize the frames of a size onto the layout */
+struct ResizePlan{
+    layout_params_t layout;         // the columns, the rows and the bezels of the layout
+    cv::Size frame_size;            // the size of the source frames
+    double ratio;                   // the resize ratio
+    int interpolation_type;         // the resize method
+    framemem_ptr_t memory;          // the memory of the resized frame
+    cv::Mat resized_frame;          // the resized frame
+    cv::Rect roi;                   // the area to paste a resized frame
+    std::vector<cv::Rect> regions;  // the areas displayed by the display nodes
+};
 
 /* JPEG encoder for video frames */
 class FrameEncoder{
     private:
         const tjhandle handle;                  // the TurboJPEG encoder
-        cv::VideoCapture video;                 // the video
+        source_ptr_t source;                    // the source of the raw frames
+        compositor_ptr_t compositor;            // the compositor of the windows (null with a single source)
+        MediaClock clock;                       // the clock to pace the frames at their timestamps
         const int display_num;                  // the number of the displays
-        double ratio;                           // the resize ratio
-        int interpolation_type;                 // the resize method
-        cv::Mat resized_frame;                  // the resized frame
-        cv::Rect roi;                           // the area to paste a resized frame
+        layout_params_t layout;                 // the columns, the rows and the bezels of the layout
+        const int width;                        // the number of horizontal pixels in each cell of the wall
+        const int height;                       // the number of vertical pixels in each cell of the wall
+        tile_shape_list_t tile_shapes;          // the framebuffer size of each display node and the angle to rotate its tile
+        ResizePlan plan;                        // the parameters to resize the current frames
         jpeg_params_t& ycbcr_format_list;       // the YCbCr formats applied for the display nodes
         jpeg_params_t& quality_list;            // the quality factors applied for the display nodes
-        std::vector<cv::Rect> regions;          // the areas displayed by the display nodes
+        framemem_ptr_t raw_memory;              // the memory of the raw frames
         std::vector<cv::Mat> raw_frames;        // raw frames sended to the display nodes
+        std::vector<cv::Mat> scaled_tiles;      // the tiles scaled before rotating them (only for the nodes needing both)
         std::vector<tranbuf_ptr_t>& send_bufs;  // the send framebuffer
+        std::vector<std::string> last_tiles;    // the last tiles sent to the display nodes (kept with windows)
+        bool repaint = true;                    // the flag to paint all the windows at the next frame
+        int frame_seq = 0;                      // the sequence number of the frame being encoded
+        hist_ptr_t capture_hist;                // the latency histogram of capturing a frame
+        hist_ptr_t resize_hist;                 // the latency histogram of resizing a frame
+        std::vector<hist_ptr_t> encode_hists;   // the latency histograms of encoding a tile for the display nodes
+        std::vector<hist_ptr_t> enqueue_hists;  // the latency histograms of pushing a tile for the display nodes
+        counter_ptr_t encode_failures;          // the number of the failed encodes
+        counter_ptr_t late_drops;               // the number of the frames dropped before encoding to keep up
+        counter_ptr_t lossless_tiles;           // the number of the tiles encoded without loss
+        std::atomic_bool auto_codec{false};     // the flag to choose the codec of each tile
+        std::mutex reconf_lock;                 // the mutex lock of the requested changes
+        source_ptr_t next_source;               // the source switched to at the next frame (null if not requested)
+        bool next_media_clock = false;          // the flag to pace the next source with the media clock
+        layout_params_t next_layout;            // the layout applied at the next frame
+        bool relayout = false;                  // the flag to apply the next layout
+        ResizePlan next_plan;                   // the parameters prepared for the frames of the next source
+        bool plan_ready = false;                // the flag to have prepared the next parameters
         
-        void setResizeParams(const int column, const int row,       // set the parameters for resizing a frame
-                             const int bezel_w, const int bezel_h,
-                             const int width, const int height,
-                             const int frame_w, const int frame_h);
-        void resize(cv::Mat& video_frame);                          // resize a frame
-        void encode(const int id);                                  // encode a frame
+        void initMetrics();                                                 // register the metrics
+        void initRawFrames();                                               // allocate the raw frames
+        void extractTile(const int id);                                     // cut out the tile of a display node from the wall
+        const bool encodeLossless(const int id);                            // encode a tile of screen content without loss
+        void enqueue(const int id, const std::string& tile);                // push an encoded tile
+        const ResizePlan makeResizePlan(const layout_params_t& layout,      // make the parameters for resizing a frame
+                                        const cv::Size& frame_size);
+        void prepareResizePlan(const cv::Size frame_size);                  // prepare the parameters for the next source
+        void adoptResizePlan(const cv::Size& frame_size);                   // switch to the parameters for a new frame size
+        void applyChanges();                                                // apply the requested changes between the frames
+        const cv::Size getWallSize(const layout_params_t& layout);          // get the size of the wall including the bezels
+        const bool compositeFrame();                                        // composite the windows and encode the changed tiles
         
     public:
-        FrameEncoder(const std::string src, const int column, const int row,  // constructor
-                     const int bezel_w, const int bezel_h, const int width,
-                     const int height, jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list,
+        FrameEncoder(const source_ptr_t source, const bool media_clock,        // constructor
+                     const int column, const int row, const int bezel_w, const int bezel_h,
+                     const int width, const int height, const tile_shape_list_t& tile_shapes,
+                     jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list,
+                     std::vector<tranbuf_ptr_t>& send_bufs);
+        FrameEncoder(const compositor_ptr_t compositor,                        // constructor (with the windows)
+                     const int column, const int row, const int bezel_w, const int bezel_h,
+                     const int width, const int height, const tile_shape_list_t& tile_shapes,
+                     jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list,
+                     std::vector<tranbuf_ptr_t>& send_bufs);
+        FrameEncoder(const int frame_w, const int frame_h,                     // constructor (without a video)
+                     const int column, const int row, const int bezel_w, const int bezel_h,
+                     const int width, const int height, const tile_shape_list_t& tile_shapes,
+                     jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list,
                      std::vector<tranbuf_ptr_t>& send_bufs);
-        ~FrameEncoder();  // destructor
-        void run();       // start encoding frames
+        ~FrameEncoder();                                                       // destructor
+        void resize(cv::Mat& video_frame);                                     // resize a frame
+        void encode(const int id);                                             // encode a frame
+        const bool encodeFrame();                                              // encode the next video frame
+        void run();                                                            // start encoding frames
+        void switchSource(const source_ptr_t source, const bool media_clock);  // switch the source at the next frame
+        void setLayout(const layout_params_t& layout);                         // change the layout at the next frame
+        void setTileCodec(const std::string& codec);                           // set the codec of the tiles
 };
 
 #endif  /* FRAME_ENCODER_HPP */
@@ -6,36 +6,39 @@
 #ifndef FRAME_SENDER_HPP
 #define FRAME_SENDER_HPP
 
-#include "mutex_logger.hpp"
-#include "socket_utils.hpp"
-#include "transceive_framebuffer.hpp"
-#include <vector>
+#include "base_frame_sender.hpp"
+#include "io_shards.hpp"
 #include <atomic>
 
-/* sender of JPEG frames */
-class FrameSender{
+/* sender of JPEG frames (the connections are sharded across the I/O threads) */
+class FrameSender : public BaseFrameSender{
     private:
         _asio::io_service& ios;                 // the I/O event loop
         sock_ptr_t sock;                        // the TCP socket
         _ip::tcp::acceptor acc;                 // the TCP acceptor
         std::vector<sock_ptr_t> socks;          // the in-use TCP sockets
-        const int display_num;                  // the number of the displays
-        int fb_id = 0;                          // the index in the view framebuffer
-        const int viewbuf_num;                  // the number of domains in the view framebuffer
+        std::vector<sock_ptr_t> pending_socks;  // the TCP sockets waiting to be admitted
         std::atomic_int send_count;             // the number of sended frames
-        std::vector<std::string> send_msgs;     // the send message
-        std::vector<tranbuf_ptr_t>& send_bufs;  // the send framebuffer
+        IoShards shards;                        // the I/O event loops for the connections
         
-        void run();                                          // start waiting for TCP connection
-        void sendFrame();                                    // send a JPEG frame
-        void onConnect(const err_t& err);                    // the callback when connected by the display node
-        void onSendFrame(const err_t& err, size_t t_bytes);  // the callback when sending a frame
+        void sendFrame();                                                // send a JPEG frame
+        void writeFrame(const int id);                                   // write a send message
+        void onConnect(const err_t& err);                                // the callback when connected by a node
+        void onRecvHello(const err_t& err, size_t t_bytes,               // the callback when receiving the hello message
+                         const sock_ptr_t sock, const streambuf_ptr_t hello_buf);
+        void onSendFrame(const err_t& err, size_t t_bytes,               // the callback when sending a frame
+                         const int id);
+        void admitSocket(const int id) override;                         // make the pending socket of a connection live
+        void releaseSocket(const int id, const bool pending) override;   // close the socket of a connection
+        void shutdownSocket(const int id, const bool pending) override;  // shut down the socket of a connection
     
     public:
         FrameSender(_asio::io_service& ios, const int port,  // constructor
-                    const int display_num, std::vector<tranbuf_ptr_t>& send_bufs,
-                    const int viewbuf_num);
+                    const int display_num, const conn_list_t& conns, std::vector<tranbuf_ptr_t>& send_bufs,
+                    const int viewbuf_num, const container_ptr_t container,
+                    const sockopt_params_t& sock_params, const io_params_t& io_params,
+                    ConnectionTable& table);
+        void run() override;                                 // start waiting for TCP connection
 };
 
 #endif  /* FRAME_SENDER_HPP */
-
@@ -0,0 +1,200 @@
+/***************************************
+*          frame_source.hpp           *
+*  (sources of the raw video frames)  *
+***************************************/
+
+#ifndef FRAME_SOURCE_HPP
+#define FRAME_SOURCE_HPP
+
+#include "async_logger.hpp"
+#include "media_clock.hpp"
+#include <string>
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <fstream>
+#include <functional>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <opencv2/imgproc.hpp>
+extern "C"{
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <sys/ioctl.h>
+    #include <linux/videodev2.h>
+}
+
+using source_params_t = std::tuple<std::string, std::string, int, int, int>;
+using size_callback_t = std::function<void(const cv::Size)>;
+
+const std::string SOURCE_VIDEO = "video";                    // the source type to encode a video file
+const std::string SOURCE_TILE_CONTAINER = "tile_container";  // the source type to stream a pre-encoded tile container
+const std::string SOURCE_SYNTHETIC = "synthetic";            // the source type to generate test patterns
+const std::string SOURCE_SHM = "shm";                        // the source type to read a shared memory ring
+const std::string SOURCE_V4L2 = "v4l2";                      // the source type to capture a V4L2 device
+const std::string SOURCE_PLAYLIST = "playlist";              // the source type to play the videos in a list back to back
+const std::string PATTERN_GRADIENT = "gradient";             // the synthetic pattern of a moving gradient
+const std::string PATTERN_NOISE = "noise";                   // the synthetic pattern of random noise
+const std::string PATTERN_TEXT = "text";                     // the synthetic pattern of a frame counter and a moving box
+const int SYNTHETIC_WIDTH_DEFAULT = 1920;                    // the default width of the synthetic frames
+const int SYNTHETIC_HEIGHT_DEFAULT = 1080;                   // the default height of the synthetic frames
+const int SOURCE_UNPACED = 0;                                // the frame rate not to give the timestamps to a source
+const int BGR_CHANNEL_NUM = 3;                               // the number of the channels in a BGR frame
+const uint32_t SHM_RING_MAGIC = 0x52574454;                  // the magic number of a shared memory ring ("TDWR")
+const uint32_t SHM_RING_VERSION = 1;                         // the format version of a shared memory ring
+const size_t SHM_RING_HEADER_SIZE = 4096;                    // the size reserved for the header (the slots are page aligned)
+const int SHM_POLL_INTERVAL = 1;                             // the interval to poll a new frame in a shared memory ring [ms]
+const int V4L2_BUFFER_NUM = 4;                               // the number of the capture buffers of a V4L2 device
+const int V4L2_FAILED = -1;                                  // the return value in failing V4L2 system calls
+const int PLAYLIST_PREROLL_NUM = 3;                          // the number of the frames decoded in advance from the next item
+const int PLAYLIST_ITEM_NONE = -1;                           // the index of a playlist item which could not be opened
+
+/* header of a shared memory ring (written by the producer process) */
+struct ShmRingHeader{
+    uint32_t magic;      // the magic number
+    uint32_t version;    // the format version
+    uint32_t width;      // the width of the frames
+    uint32_t height;     // the height of the frames
+    uint32_t slot_num;   // the number of the frame slots
+    uint32_t reserved;   // the padding
+    uint64_t slot_size;  // the size of each slot
+    uint64_t write_seq;  // the number of the written frames (frame n is in slot n%slot_num)
+};
+
+/* super class of the sources of raw BGR frames */
+class BaseFrameSource{
+    private:
+        const int64_t frame_interval;  // the interval of the timestamps given by the frame rate [ns] (zero if not given)
+        int64_t frame_count = 0;       // the number of the read frames
+        
+        virtual const bool readFrame(cv::Mat& frame, int64_t& pts) = 0;  // read the next frame and its timestamp
+    
+    protected:
+        bool opened = true;  // the flag to have opened the source
+    
+    public:
+        BaseFrameSource(const int fps);                                 // constructor
+        virtual ~BaseFrameSource(){}                                    // destructor
+        virtual const cv::Size getFrameSize() = 0;                      // get the size of the frames
+        const bool read(cv::Mat& frame, int64_t& pts);                  // read the next frame and its presentation timestamp
+        const bool isOpened();                                          // check if the source has been opened
+        virtual void setSizeCallback(const size_callback_t& callback);  // set the callback when the next frame size is known
+};
+
+using source_ptr_t = std::shared_ptr<BaseFrameSource>;
+
+/* video file or stream decoded by OpenCV */
+class VideoFrameSource : public BaseFrameSource{
+    private:
+        cv::VideoCapture video;  // the video
+        
+        const bool readFrame(cv::Mat& frame, int64_t& pts) override;  // read the next frame
+    
+    public:
+        VideoFrameSource(const std::string& src, const int fps);  // constructor
+        const cv::Size getFrameSize() override;                   // get the size of the frames
+};
+
+/* generator of test patterns (without any decode) */
+class SyntheticFrameSource : public BaseFrameSource{
+    private:
+        const std::string pattern;  // the pattern
+        cv::Mat frame;              // the generated frame
+        cv::Mat gradient;           // the gradient of twice the width to be scrolled
+        int frame_count = 0;        // the number of the generated frames
+        
+        const bool readFrame(cv::Mat& frame, int64_t& pts) override;  // generate the next frame
+    
+    public:
+        SyntheticFrameSource(const std::string& pattern, const int width,  // constructor
+                             const int height, const int fps);
+        const cv::Size getFrameSize() override;                            // get the size of the frames
+};
+
+/* reader of a shared memory ring written by another process (the frames are not copied) */
+class ShmFrameSource : public BaseFrameSource{
+    private:
+        int fd = -1;                             // the file descriptor of the shared memory
+        size_t map_size;                         // the size of the mapping
+        const unsigned char *map_ptr = nullptr;  // the address of the mapping
+        const ShmRingHeader *header;             // the header of the ring
+        uint64_t read_seq = 0;                   // the number of the frames written when the last frame was read
+        
+        const bool readFrame(cv::Mat& frame, int64_t& pts) override;  // wait for and refer to the latest frame
+    
+    public:
+        ShmFrameSource(const std::string& name);  // constructor
+        ~ShmFrameSource();                         // destructor
+        const cv::Size getFrameSize() override;    // get the size of the frames
+};
+
+/* capturer of a V4L2 device (YUYV frames converted into BGR) */
+class V4l2FrameSource : public BaseFrameSource{
+    private:
+        int fd = V4L2_FAILED;           // the file descriptor of the device
+        int width;                      // the width of the frames
+        int height;                     // the height of the frames
+        int line_size;                  // the bytes per line of the captured frames
+        std::vector<void*> buf_ptrs;    // the addresses of the capture buffers
+        std::vector<size_t> buf_sizes;  // the sizes of the capture buffers
+        cv::Mat frame;                  // the converted frame
+        
+        const bool setFormat(const int width, const int height, const int fps);  // set the format of the device
+        const bool mapBuffers();                                                 // map and queue the capture buffers
+        const bool readFrame(cv::Mat& frame, int64_t& pts) override;             // capture the next frame
+    
+    public:
+        V4l2FrameSource(const std::string& device, const int width,  // constructor
+                        const int height, const int fps);
+        ~V4l2FrameSource();                                          // destructor
+        const cv::Size getFrameSize() override;                      // get the size of the frames
+};
+
+/* item of a playlist opened in advance */
+struct PlaylistItem{
+    int index = PLAYLIST_ITEM_NONE;  // the index in the playlist
+    source_ptr_t source;             // the source of the item
+    std::vector<cv::Mat> frames;     // the frames decoded in advance
+    std::vector<int64_t> pts_list;   // the timestamps of the frames decoded in advance
+};
+
+/* playlist of videos played back to back (the next item is opened and pre-rolled in the background) */
+class PlaylistFrameSource : public BaseFrameSource{
+    private:
+        std::vector<std::string> paths;  // the paths of the videos
+        PlaylistItem current;            // the item being played
+        size_t preroll_index = 0;        // the index of the next pre-rolled frame of the current item
+        PlaylistItem next;               // the item opened in advance
+        std::thread prefetch_thre;       // the thread to open the next item
+        std::mutex lock;                 // the mutex lock of the size of the next item
+        size_callback_t size_callback;   // the callback when the size of the next item is known
+        cv::Size next_size;              // the size of the frames of the next item (empty until it is opened)
+        int64_t pts_offset = 0;          // the timestamp of the start of the current item [ns]
+        int64_t last_pts = 0;            // the timestamp of the last frame [ns]
+        int64_t last_interval = 0;       // the interval between the last two frames [ns]
+        
+        const bool loadList(const std::string& list_file);            // read the paths in a playlist file
+        PlaylistItem openItem(const int index);                       // open an item and decode its first frames
+        void prefetch(const int index, source_ptr_t finished);        // open the next item in the background
+        const bool advance();                                         // switch to the next item
+        const bool readFrame(cv::Mat& frame, int64_t& pts) override;  // read the next frame of the playlist
+    
+    public:
+        PlaylistFrameSource(const std::string& list_file, const int fps);  // constructor
+        ~PlaylistFrameSource();                                            // destructor
+        const cv::Size getFrameSize() override;                            // get the size of the frames of the current item
+        void setSizeCallback(const size_callback_t& callback) override;    // set the callback when the next item is opened
+};
+
+const source_ptr_t createFrameSource(const source_params_t& params);  // create the source of a type (null if it failed)
+
+#endif  /* FRAME_SOURCE_HPP */
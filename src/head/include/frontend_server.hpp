@@ -9,36 +9,70 @@
 #include "config_parser.hpp"
 #include "frame_encoder.hpp"
 #include "frame_sender.hpp"
+#include "uring_frame_sender.hpp"
+#include "tile_container.hpp"
 #include "sync_manager.hpp"
 #include <thread>
+#include <csignal>
 
 /* class for the frontend server */
 class FrontendServer{
     private:
-        _asio::io_service& ios;                // the I/O event loop
-        sock_ptr_t sock;                       // the TCP socket
-        _ip::tcp::acceptor acc;                // the TCP acceptor
-        std::vector<sock_ptr_t> socks;         // the in-use TCP sockets
-        int display_num;                       // the number of the displays
-        JsonHandler init_params;               // the parameters packed in the initial message
-        int connected_num = 0;                 // the number of the connected display nodes
-        jpeg_params_t ycbcr_format_list;       // the YCbCr format list for the display nodes
-        jpeg_params_t quality_list;            // the quality factor list for the display nodes
-        ip_list_t ip_addrs;                    // the IP addresses of the display nodes
-        std::vector<tranbuf_ptr_t> send_bufs;  // the send framebuffer
-        std::thread send_thre;                 // the sender thread
-        std::thread enc_thre;                  // the encoder thread
+        _asio::io_service& ios;                    // the I/O event loop
+        ConfigParser& parser;                      // the parser of the config file
+        _asio::signal_set signals;                 // the signals to reload the config file
+        sock_ptr_t sock;                           // the TCP socket
+        _ip::tcp::acceptor acc;                    // the TCP acceptor
+        int display_num;                           // the number of the displays
+        int width;                                 // the number of horizontal pixels in each cell of the wall
+        int height;                                // the number of vertical pixels in each cell of the wall
+        int stream_port;                           // the port number for streaming JPEG frames
+        int viewbuf_num;                           // the number of domains in the view framebuffer of every display node
+        node_list_t nodes;                         // the settings of each display node
+        int sendbuf_num;                           // the number of domains in the send framebuffer
+        layout_params_t layout;                    // the columns, the rows and the bezels of the layout
+        source_params_t source_params;             // the parameters of the video source
+        bool media_clock;                          // the flag to pace the frames with the media clock
+        window_list_t windows;                     // the windows of the sources composited on the wall
+        JsonHandler init_params;                   // the parameters packed in the initial message
+        jpeg_params_t ycbcr_format_list;           // the YCbCr format list for the display nodes
+        jpeg_params_t quality_list;                // the quality factor list for the display nodes
+        ip_list_t ip_addrs;                        // the IP addresses of the display nodes
+        conn_list_t conns;                         // the connections to the display nodes and the relay nodes
+        std::vector<tranbuf_ptr_t> send_bufs;      // the send framebuffer
+        container_ptr_t container;                 // the pre-encoded tile container
+        sockopt_params_t sock_params;              // the options of the TCP sockets
+        std::string backend;                       // the transport backend
+        io_params_t io_params;                     // the parameters of the I/O threads
+        IoShards sync_shards;                      // the I/O event loops for the sync messages
+        ConnectionTable conn_table;                // the states of the connections
+        std::unique_ptr<OverlayManager> overlays;  // the overlays on the display nodes
+        std::unique_ptr<SyncManager> manager;      // the sync manager
+        std::unique_ptr<FrameEncoder> encoder;     // the frame encoder (null while streaming a tile container)
+        std::thread send_thre;                     // the sender thread
+        std::thread enc_thre;                      // the encoder thread
         
-        void waitForConnection();                          // start waiting for TCP connection
-        void onConnect(const err_t& err);                  // the callback when connected by the display node
-        void onSendInit(const err_t& err,  size_t t_bytes, // the callback when sending the initial message
-                        const std::string ip);
-        void runFrameEncoder(const std::string video_src,  // launch the frame encoder
-                             const int column, const int row, const int bezel_w, const int bezel_h,
-                             const int width, const int height);
-        void runFrameSender(const int stream_port,         // launch the frame sender
+        void waitForConnection();                           // start waiting for TCP connection
+        void onConnect(const err_t& err);                   // the callback when connected by a node
+        void onRecvHello(const err_t& err, size_t t_bytes,  // the callback when receiving the hello message
+                         const sock_ptr_t sock, const streambuf_ptr_t hello_buf);
+        void onSendInit(const err_t& err,  size_t t_bytes,  // the callback when sending the initial message
+                        const int id, const int gen, const sock_ptr_t sock,
+                        const std::shared_ptr<std::string> init_msg);
+        const std::string makeInitMsg(const int id);        // make the initial message for a connection
+        void setNodeParams(JsonHandler& params,             // set the parameters of a display node in the initial message
+                           const int display_id, const std::string& key_prefix);
+        void runFrameEncoder();                             // launch the frame encoder
+        void runFrameSender(const int stream_port,          // launch the frame sender
                             const int viewbuf_num);
-        void runSyncManager();                             // launch the sync manager
+        void initMetrics();                                 // register the gauges of the display nodes
+        const double getJpegParam(jpeg_params_t& params,    // get a JPEG parameter applied for a display node
+                                  const int id);
+        void waitForSignal();                               // start waiting for SIGHUP
+        void onSignal(const err_t& err, const int signum);  // the callback when SIGHUP is received
+        void reload();                                      // apply the config file read again
+        void switchSource(const source_params_t& params,    // switch the video source without stopping the encoder
+                          const bool media_clock);
     
     public:
         FrontendServer(_asio::io_service& ios, ConfigParser& parser, const int fs_port);  // constructor
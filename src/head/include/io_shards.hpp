@@ -0,0 +1,37 @@
+/*********************************************
+*               io_shards.hpp                *
+*  (I/O event loops sharded across threads)  *
+*********************************************/
+
+#ifndef IO_SHARDS_HPP
+#define IO_SHARDS_HPP
+
+#include "socket_utils.hpp"
+#include "thread_utils.hpp"
+#include "frame_tracer.hpp"
+#include <vector>
+
+using ios_ptr_t = std::shared_ptr<_asio::io_service>;
+using work_ptr_t = std::shared_ptr<_asio::io_service::work>;
+using io_params_t = std::tuple<int, bool>;
+
+/* I/O event loops sharded across threads */
+class IoShards{
+    private:
+        std::vector<ios_ptr_t> ioss;        // the I/O event loops
+        std::vector<work_ptr_t> works;      // the works to keep the event loops running
+        std::vector<std::thread> io_thres;  // the I/O threads
+        const bool pin_threads;             // the flag to pin each I/O thread to a core
+        const std::string role;             // the role to place the I/O threads
+        
+        void runService(const ios_ptr_t ios, const int index);  // run an event loop
+    
+    public:
+        IoShards(const io_params_t& io_params, const std::string& role);  // constructor
+        ~IoShards();                                                      // destructor
+        _asio::io_service& getService(const int id);                      // get the event loop for a connection
+        void run();                                                       // launch the I/O threads
+        void join();                                                      // wait for the I/O threads
+};
+
+#endif  /* IO_SHARDS_HPP */
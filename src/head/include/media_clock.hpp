@@ -0,0 +1,39 @@
+/******************************************
+*             media_clock.hpp             *
+*  (clock to pace the frames of a video)  *
+******************************************/
+
+#ifndef MEDIA_CLOCK_HPP
+#define MEDIA_CLOCK_HPP
+
+#include "async_logger.hpp"
+#include <chrono>
+#include <thread>
+#include <cstdint>
+
+const int64_t MEDIA_TIME_NONE = -1;               // the timestamp of a live frame (not paced with the media clock)
+const int64_t MEDIA_RESYNC_LATENESS = 1000000000;  // the lateness to anchor the clock again instead of dropping frames [ns]
+const double MEDIA_COST_WEIGHT = 0.125;           // the weight of the latest frame in the average processing time
+
+/* clock which maps the timestamps of a video onto the steady clock */
+class MediaClock{
+    private:
+        bool enabled;                // the flag to pace the frames
+        bool anchored = false;       // the flag to have anchored the clock
+        int64_t origin_t;            // the time of the anchor [ns]
+        int64_t origin_pts;          // the timestamp of the anchor [ns]
+        int64_t last_pts;            // the timestamp of the last frame [ns]
+        int64_t frame_interval = 0;  // the interval between the last two timestamps (the acceptable lateness) [ns]
+        double cost = 0;             // the average time to process a frame [ns]
+        
+        const int64_t now();                                 // get the time of the steady clock
+        void anchor(const int64_t now_t, const int64_t pts);  // anchor a timestamp to the current time
+    
+    public:
+        MediaClock(const bool enabled);             // constructor
+        const bool schedule(const int64_t pts);     // wait until the deadline of a frame (false if it should be dropped)
+        void addCost(const int64_t elapsed_time);  // add the time to process a frame to the average
+        void reset(const bool enabled);            // anchor the clock again at the next frame
+};
+
+#endif  /* MEDIA_CLOCK_HPP */
@@ -0,0 +1,103 @@
+/****************************************************
+*                overlay_manager.hpp                *
+*  (manager of the overlays on the display nodes)   *
+****************************************************/
+
+#ifndef OVERLAY_MANAGER_HPP
+#define OVERLAY_MANAGER_HPP
+
+#include "async_logger.hpp"
+#include "json_handler.hpp"
+#include "overlay_message.hpp"
+#include "frame_encoder.hpp"
+#include <map>
+#include <mutex>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+const std::string OVERLAY_TYPE_TEXT = "text";         // the overlay of a fixed text (e.g. a caption)
+const std::string OVERLAY_TYPE_CLOCK = "clock";       // the overlay of the local time
+const std::string OVERLAY_TYPE_TICKER = "ticker";     // the overlay of a text scrolled leftward
+const std::string OVERLAY_TYPE_SPRITE = "sprite";     // the overlay of an RGBA image
+const std::string OVERLAY_CLOCK_FORMAT = "%H:%M:%S";  // the default format of a clock (in strftime)
+const std::string OVERLAY_DISPLAY_ID = "{id}";        // the placeholder replaced with the display ID
+const int OVERLAY_FONT = cv::FONT_HERSHEY_SIMPLEX;    // the font of the glyph atlases
+const int OVERLAY_GLYPH_PADDING = 2;                  // the padding around each glyph in an atlas
+const int OVERLAY_CLOCK_SIZE = 64;                    // the size of the buffer to format a clock
+const int OVERLAY_GEN_NONE = -1;                      // the generation of a display node without any overlay
+const double BLEND_GAMMA_DEFAULT = 2.2;               // the default gamma of the projectors to blend their edges
+
+/* parameters of an overlay in head_conf.json */
+struct OverlayParams{
+    std::string type;  // the type
+    std::string text;  // the text (the format of a clock, or the RGBA file of a sprite)
+    int x;             // the left in the wall (or in each display)
+    int y;             // the top in the wall (or in each display)
+    int width;         // the width a ticker is scrolled in, or the width of a sprite
+    int height;        // the height of a sprite
+    double scale;      // the scale of the font
+    int speed;         // the pixels a ticker is scrolled by in each frame
+    int color[3];      // the RGB color of a text
+    bool per_display;  // the flag to place the overlay in each display at the same position
+};
+
+using overlay_list_t = std::vector<OverlayParams>;
+
+/* overlay placed on the wall */
+struct OverlayState{
+    OverlayParams params;  // the parameters
+    int resource;          // the ID of the glyph atlas or the sprite
+    int cell_w;            // the width of each glyph (for a ticker)
+    std::string text;      // the current text
+    int version = 0;       // the number of the changes of the text
+};
+
+/* overlays sent to a display node */
+struct OverlayPeer{
+    int gen = OVERLAY_GEN_NONE;                                                // the generation of the connection the overlays were sent to
+    int epoch = OVERLAY_GEN_NONE;                                              // the set of the overlays sent
+    std::vector<int> versions;                                                 // the versions of the overlays sent
+};
+
+/* manager of the overlays on the display nodes (each display node gets the commands with its sync messages) */
+class OverlayManager{
+    private:
+        std::mutex lock;                         // the mutex lock of the overlays
+        int width;                               // the number of horizontal pixels in each display
+        int height;                              // the number of vertical pixels in each display
+        tile_shape_list_t tile_shapes;           // the framebuffer size of each display node and the angle its tile is rotated by
+        std::vector<cv::Point> origins;          // the top left of each display in the wall
+        std::vector<std::string> resource_cmds;  // the commands to store the glyph atlases and the sprites
+        std::vector<OverlayState> overlays;      // the overlays
+        std::vector<std::string> blend_cmds;     // the commands to blend the edges of each display (empty without overlaps)
+        std::vector<OverlayPeer> peers;          // the overlays sent to the display nodes
+        int epoch = 0;                           // the number of the changes of the overlays
+        
+        const int addAtlas(const double scale, int& cell_w);           // rasterize a glyph atlas
+        const int addSprite(const OverlayParams& params);              // read an RGBA sprite
+        void refresh(OverlayState& overlay);                           // update the text of a clock
+        const cv::Size getUprightSize(const int id);                   // get the page size of a display before its rotation
+        const std::string makeBlendCmd(const int id, const int left,   // make the command to blend the edges of a display
+                                       const int right, const int top, const int bottom, const double blend_gamma);
+        const std::string makeLayerCmd(const int index, const int id,  // make the command to place an overlay on a display
+                                       const int round);
+    
+    public:
+        OverlayManager(const overlay_list_t& overlay_list,                     // constructor
+                       const int column, const int row, const int bezel_w, const int bezel_h,
+                       const double blend_gamma, const int width, const int height,
+                       const tile_shape_list_t& tile_shapes);
+        void setOverlays(const overlay_list_t& overlay_list,                   // replace the overlays and the edges to blend
+                         const int column, const int row, const int bezel_w, const int bezel_h,
+                         const double blend_gamma);
+        const std::string getCmds(const std::vector<int>& ids, const int gen,  // get the commands for the display nodes of a connection
+                                  const int round);
+};
+
+#endif  /* OVERLAY_MANAGER_HPP */
@@ -6,45 +6,83 @@
 #ifndef SYNC_MANAGER_HPP
 #define SYNC_MANAGER_HPP
 
-#include "mutex_logger.hpp"
+#include "async_logger.hpp"
 #include "socket_utils.hpp"
 #include "sync_utils.hpp"
 #include "json_handler.hpp"
+#include "io_shards.hpp"
+#include "frame_tracer.hpp"
+#include "metrics.hpp"
+#include "connection_table.hpp"
+#include "overlay_manager.hpp"
 #include <cmath>
+#include <mutex>
 extern "C"{
     #include <turbojpeg.h>
 }
 
-using streambuf_ptr_t = std::shared_ptr<_asio::streambuf>;
+const int FPS_INTERVAL = 100;        // the interval to display the current fps
+const int SYNC_TIMEOUT_DISABLED = 0;  // the sync timeout not to drop the connections holding the barrier
+const int SYNC_ROUND_NONE = -1;       // the round of a connection which has not sent a sync message
 
-const int FPS_INTERVAL = 100;  // the interval to display the current fps
-
-/* synchronization process manager */
+/* synchronization process manager (the connections are sharded across the I/O threads) */
 class SyncManager{
     private:
-        _asio::io_service& ios;                    // the I/O event loop
-        std::vector<sock_ptr_t>& socks;            // the in-use TCP sockets
+        IoShards& shards;                          // the I/O event loops for the connections
+        ConnectionTable& table;                    // the states of the connections
+        const conn_list_t conns;                   // the connections to the display nodes and the relay nodes
+        const int conn_num;                        // the number of the connections
+        int sync_timeout;                          // the time to wait for the sync messages after the first one in a round [ms]
+        std::mutex sync_lock;                      // the mutex lock of the barrier
+        std::vector<sock_ptr_t> socks;             // the in-use TCP sockets (used only in the I/O thread of each connection)
+        std::vector<int> sock_gens;                // the generations of the connections of the sockets
         std::vector<streambuf_ptr_t> stream_bufs;  // the stream buffers
-        const int display_num;                     // the number of the displays
-        std::atomic_int sync_count;                // the count of the synchronized displays
+        std::vector<std::string> sync_msgs;        // the sync messages being sent with the overlay commands
+        std::vector<int> synced_rounds;            // the last round each connection sent a sync message for
+        int round = 0;                             // the current round (the sequence number of the frame displayed next)
+        _asio::steady_timer timer;                 // the timer of the sync timeout
+        int timer_round = SYNC_ROUND_NONE;         // the round the timer was started for
         jpeg_params_t& ycbcr_format_list;          // the YCbCr formats applied for the display nodes
         jpeg_params_t& quality_list;               // the quality factors applied for the display nodes
-        JsonHandler sync_params;                   // the parsed sync message
+        OverlayManager& overlays;                  // the overlays on the display nodes
         hr_clock_t pre_t;                          // the starting time of a term
         int frame_count = 0;                       // the count of obsoleted frames
+        int64_t round_t = 0;                       // the arrival time of the first sync message in a round (0 before it)
+        std::vector<hist_ptr_t> lag_hists;         // the latency histograms of the sync messages behind the first one
+        std::vector<hist_ptr_t> wait_hists;        // the latency histograms of waiting for a frame in the display nodes
+        std::vector<std::atomic_int> recv_depths;  // the receive framebuffer depths reported by the display nodes
+        counter_ptr_t sync_rounds;                 // the number of the completed sync rounds
+        counter_ptr_t sync_timeouts;               // the number of the connections dropped for the sync timeout
         
+        void initMetrics();                                                    // register the metrics
+        const double getRecvDepth(const int id);                               // get the receive framebuffer depth of a display node
         const std::string changeYCbCr(const int change_flag, const int id);    // change the YCbCr format
         const std::string changeQuality(const int change_flag, const int id);  // change the quality factor
-        void parseSyncMsg(const std::string& msg, const int id);               // parse a sync message
-        void onRecvSync(const err_t& err, size_t t_bytes, const int id);       // the callback when receiving a sync message
-        void onSendSync(const err_t& err, size_t t_bytes, const int id);       // the callback when sending a sync message
-        void sendSync();                                                       // send a sync message
+        void parseSyncMsg(const std::string& msg, const int conn_id);          // parse a sync message
+        void applySyncParams(const int param_flag, const int change_flag,      // apply the requested JPEG parameters
+                             const int id);
+        void attachConnection(const int id, const int gen,                     // start receiving the sync messages of a connection
+                              const sock_ptr_t sock);
+        void closeConnection(const int id, const int gen);                     // close the socket of a dropped connection
+        void onDrop(const int id);                                             // the callback when a connection is dropped
+        void readSync(const int id, const int gen);                            // start receiving a sync message
+        void onRecvSync(const err_t& err, size_t t_bytes, const int id,        // the callback when receiving a sync message
+                        const int gen);
+        void onSendSync(const err_t& err, size_t t_bytes, const int id,        // the callback when sending a sync message
+                        const int gen);
+        void onTimeout(const err_t& err, const int timeout_round);             // the callback when the sync timeout expires
+        const std::vector<int> getParticipants();                              // get the connections in the current round
+        void checkBarrier();                                                   // complete the rounds all the participants reached
+        void writeSync(const int id, const int gen, const int round);          // write a sync message
         
     public:
-        SyncManager(_asio::io_service& ios, std::vector<sock_ptr_t>& socks,  // constructor
-                    jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list);
-        void run();  // start the synchronizaton process
+        SyncManager(IoShards& shards, ConnectionTable& table,  // constructor
+                    const conn_list_t& conns, const int sync_timeout,
+                    jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list, OverlayManager& overlays);
+        void addConnection(const int id, const int gen,        // add the control connection of a node
+                           const sock_ptr_t sock);
+        void run();                                            // start the synchronizaton process
+        void setSyncTimeout(const int sync_timeout);           // change the time to wait for the sync messages
 };
 
 #endif  /* SYNC_MANAGER_HPP */
-
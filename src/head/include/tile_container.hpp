@@ -0,0 +1,74 @@
+/******************************************
+*           tile_container.hpp            *
+*  (container of pre-encoded JPEG tiles)  *
+******************************************/
+
+#ifndef TILE_CONTAINER_HPP
+#define TILE_CONTAINER_HPP
+
+#include "async_logger.hpp"
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+extern "C"{
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+}
+
+const uint32_t TILE_CONTAINER_MAGIC = 0x43574454;  // the magic number of a tile container ("TDWC")
+const uint32_t TILE_CONTAINER_VERSION = 1;         // the format version of a tile container
+
+/* header of a tile container */
+struct TileContainerHeader{
+    uint32_t magic;         // the magic number
+    uint32_t version;       // the format version
+    uint32_t display_num;   // the number of the displays
+    uint32_t frame_num;     // the number of the frames
+    uint64_t index_offset;  // the offset of the tile index
+};
+
+/* entry of the tile index */
+struct TileIndexEntry{
+    uint64_t offset;  // the offset of a JPEG tile
+    uint64_t size;    // the size of a JPEG tile
+};
+
+/* reader of a tile container (mapped onto the memory) */
+class TileContainer{
+    private:
+        int fd;                             // the file descriptor of the container
+        size_t file_size;                   // the size of the container
+        const unsigned char *file_ptr;      // the address of the mapped container
+        const TileContainerHeader *header;  // the header of the container
+        const TileIndexEntry *index;        // the tile index
+        
+    public:
+        TileContainer(const std::string& filename, const int display_num);  // constructor
+        ~TileContainer();                                                    // destructor
+        const int getFrameNum();                                             // get the number of the frames
+        const unsigned char *getTile(const int frame, const int id,         // get a JPEG tile
+                                     size_t& tile_size);
+};
+
+/* writer of a tile container */
+class TileContainerWriter{
+    private:
+        FILE *fp;                           // the output file
+        const int display_num;              // the number of the displays
+        uint64_t offset;                    // the offset of the next JPEG tile
+        std::vector<TileIndexEntry> index;  // the tile index
+        
+    public:
+        TileContainerWriter(const std::string& filename, const int display_num);  // constructor
+        ~TileContainerWriter();                                                    // destructor
+        void append(const std::string& jpeg_frame);                               // append a JPEG tile
+        const int getFrameNum();                                                   // get the number of the written frames
+};
+
+using container_ptr_t = std::shared_ptr<TileContainer>;
+
+#endif  /* TILE_CONTAINER_HPP */
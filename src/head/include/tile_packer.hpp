@@ -0,0 +1,19 @@
+/*********************************************
+*              tile_packer.hpp               *
+*  (main function to pre-encode JPEG tiles)  *
+*********************************************/
+
+#ifndef TILE_PACKER_HPP
+#define TILE_PACKER_HPP
+
+#include "config_parser.hpp"
+#include "frame_encoder.hpp"
+#include "tile_container.hpp"
+
+const int ARGUMENT_NUM = 3;           // the number of the command line arguments
+const int CONF_ARG_INDEX = 1;         // the index of the config file in the command line arguments
+const int OUTPUT_ARG_INDEX = 2;       // the index of the output file in the command line arguments
+const int PACKER_BUF_NUM = 1;         // the number of domains in the framebuffer for packing
+const int PACKER_LOG_INTERVAL = 100;  // the interval to display the number of packed frames
+
+#endif  /* TILE_PACKER_HPP */
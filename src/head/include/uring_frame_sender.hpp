@@ -0,0 +1,77 @@
+/******************************************
+*         uring_frame_sender.hpp          *
+*  (sender of JPEG frames with io_uring)  *
+******************************************/
+
+#ifndef URING_FRAME_SENDER_HPP
+#define URING_FRAME_SENDER_HPP
+
+#include "base_frame_sender.hpp"
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+extern "C"{
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/uio.h>
+    #include <sys/syscall.h>
+    #include <poll.h>
+    #include <linux/io_uring.h>
+}
+
+const int URING_FAILED = -1;      // the return value in failing io_uring system calls
+const int URING_FILE_EMPTY = -1;  // the registered file of a connection not live
+const int POLL_FOREVER = -1;      // the timeout to wait for a node until it connects
+
+/* sender of JPEG frames with io_uring (the writes of a frame are submitted in a batch) */
+class UringFrameSender : public BaseFrameSender{
+    private:
+        _asio::io_service ios;                             // the I/O event loop (only for accepting)
+        _ip::tcp::acceptor acc;                            // the TCP acceptor
+        std::vector<sock_ptr_t> socks;                     // the in-use TCP sockets
+        std::vector<sock_ptr_t> pending_socks;             // the TCP sockets waiting to be admitted
+        std::vector<sock_ptr_t> hello_socks;               // the accepted TCP sockets waiting for their hello messages
+        std::vector<std::string> hello_msgs;               // the parts of the hello messages received on them
+        int ring_fd;                                       // the file descriptor of the io_uring instance
+        unsigned int sq_entry_num;                         // the number of the submission queue entries
+        void *sq_ptr;                                      // the address of the submission queue ring
+        void *cq_ptr;                                      // the address of the completion queue ring
+        size_t sq_size;                                    // the size of the submission queue ring
+        size_t cq_size;                                    // the size of the completion queue ring
+        struct io_uring_sqe *sqes;                         // the submission queue entries
+        unsigned int *sq_tail;                             // the tail of the submission queue
+        unsigned int *sq_mask;                             // the index mask of the submission queue
+        unsigned int *sq_array;                            // the index array of the submission queue
+        unsigned int *cq_head;                             // the head of the completion queue
+        unsigned int *cq_tail;                             // the tail of the completion queue
+        unsigned int *cq_mask;                             // the index mask of the completion queue
+        struct io_uring_cqe *cqes;                         // the completion queue entries
+        std::vector<struct msghdr> send_hdrs;              // the headers of the send messages
+        std::vector<std::vector<struct iovec>> send_iovs;  // the buffers of the send messages
+        std::vector<int> send_iov_index;                   // the index of the first unsent buffer in each send message
+        int pending_num = 0;                               // the number of the send messages not written yet
+        
+        const bool setupRing(const unsigned int entry_num);              // set up the io_uring instance
+        const bool registerFiles();                                      // register an empty file table
+        void updateFile(const int id, int fd);                           // update the registered file of a connection
+        void acceptStreams();                                            // accept the display nodes and the relay nodes
+        const bool readHello(const int index);                           // read the hello message of an accepted socket
+        void queueWrite(const int id);                                   // queue a write of the send message
+        const int enter(const unsigned int submit_num,                   // submit the queued writes and wait for completion
+                        const unsigned int wait_num);
+        const int reapCompletions();                                     // reap the completed writes
+        void sendFrame();                                                // send a JPEG frame to all the live connections
+        void admitSocket(const int id) override;                         // make the pending socket of a connection live
+        void releaseSocket(const int id, const bool pending) override;   // close the socket of a connection
+        void shutdownSocket(const int id, const bool pending) override;  // shut down the socket of a connection
+        
+    public:
+        UringFrameSender(const int port, const int display_num,  // constructor
+                         const conn_list_t& conns, std::vector<tranbuf_ptr_t>& send_bufs, const int viewbuf_num,
+                         const container_ptr_t container, const sockopt_params_t& sock_params,
+                         ConnectionTable& table);
+        ~UringFrameSender();                                     // destructor
+        void run() override;                                     // start sending JPEG frames
+};
+
+#endif  /* URING_FRAME_SENDER_HPP */
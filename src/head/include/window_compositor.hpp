@@ -0,0 +1,68 @@
+/**************************************************
+*             window_compositor.hpp              *
+*  (compositor of the windows of several sources) *
+**************************************************/
+
+#ifndef WINDOW_COMPOSITOR_HPP
+#define WINDOW_COMPOSITOR_HPP
+
+#include "async_logger.hpp"
+#include "frame_tracer.hpp"
+#include "media_clock.hpp"
+#include "frame_source.hpp"
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+using window_params_t = std::tuple<source_params_t, bool, cv::Rect>;
+using window_list_t = std::vector<window_params_t>;
+
+/* window showing a source in a region of the wall */
+struct Window{
+    source_ptr_t source;     // the source
+    MediaClock clock;        // the clock to pace the frames at their timestamps
+    cv::Rect rect;           // the region in the wall
+    cv::Size frame_size;     // the size of the source frames
+    cv::Rect roi;            // the area to paste a resized frame in the region
+    int interpolation_type;  // the resize method
+    cv::Mat staged;          // the frame being resized (the size of the region)
+    cv::Mat ready;           // the latest resized frame
+    bool updated = false;    // the flag to have a frame not painted yet
+    bool finished = false;   // the flag to have read all the frames of the source
+    
+    Window(const source_ptr_t source, const bool media_clock,  // constructor
+           const cv::Rect& rect);
+};
+
+using window_ptr_t = std::shared_ptr<Window>;
+
+/* compositor of the windows of several sources (each source is read and resized in its own thread) */
+class WindowCompositor{
+    private:
+        std::vector<window_ptr_t> windows;        // the windows in the order of painting
+        std::vector<std::thread> window_thres;    // the threads of the windows
+        std::mutex lock;                          // the mutex lock of the frames of the windows
+        std::condition_variable updated_cond;     // the condition to have a new frame in a window
+        int finished_num = 0;                     // the number of the windows whose source is finished
+        bool stopped = false;                     // the flag to stop the threads
+        
+        void runWindow(const window_ptr_t window);                        // read and resize the frames of a window
+        void setResizeParams(Window& window, const cv::Size& frame_size);  // set the parameters to resize the frames of a window
+        const bool hasUpdate();                                           // check if any window has a new frame
+    
+    public:
+        WindowCompositor(const window_list_t& window_list);          // constructor
+        ~WindowCompositor();                                         // destructor
+        const bool isOpened();                                       // check if all the sources have been opened
+        void run();                                                  // launch the threads of the windows
+        const bool composite(cv::Mat& canvas, const bool repaint,   // wait for new frames and paint them onto the wall
+                             std::vector<cv::Rect>& dirty_rects);
+};
+
+using compositor_ptr_t = std::shared_ptr<WindowCompositor>;
+
+#endif  /* WINDOW_COMPOSITOR_HPP */
@@ -0,0 +1,54 @@
+/*********************************************
+*               io_shards.cpp                *
+*  (I/O event loops sharded across threads)  *
+*********************************************/
+
+#include "io_shards.hpp"
+
+/* constructor */
+IoShards::IoShards(const io_params_t& io_params, const std::string& role):
+    pin_threads(std::get<1>(io_params)),
+    role(role)
+{
+    for(int i=0; i<std::get<0>(io_params); ++i){
+        this->ioss.push_back(std::make_shared<_asio::io_service>());
+        this->works.push_back(std::make_shared<_asio::io_service::work>(*this->ioss[i]));
+    }
+}
+
+/* destructor (stop the I/O threads) */
+IoShards::~IoShards(){
+    this->works.clear();
+    for(auto& ios : this->ioss){
+        ios->stop();
+    }
+    this->join();
+}
+
+/* get the event loop for a connection (connections are assigned to the shards in turn) */
+_asio::io_service& IoShards::getService(const int id){
+    return *this->ioss[id%this->ioss.size()];
+}
+
+/* launch the I/O threads */
+void IoShards::run(){
+    for(size_t i=0; i<this->ioss.size(); ++i){
+        this->io_thres.push_back(std::thread(std::bind(&IoShards::runService, this, this->ioss[i], i)));
+    }
+}
+
+/* run an event loop (the threads section of the config overrides pinning each thread to the core of its index) */
+void IoShards::runService(const ios_ptr_t ios, const int index){
+    _ft::setThreadName("io");
+    placeThread(this->role, index, this->pin_threads ? index : CORE_NOT_PINNED);
+    ios->run();
+}
+
+/* wait for the I/O threads */
+void IoShards::join(){
+    for(auto& io_thre : this->io_thres){
+        if(io_thre.joinable()){
+            io_thre.join();
+        }
+    }
+}
@@ -14,6 +14,16 @@ int main(int argc, char *argv[]){
         std::exit(EXIT_FAILURE);
     }
     ConfigParser parser(argv[ARGUMENT_INDEX]);
+    _ml::init(parser.getLogParams());
+    _ft::init(parser.getTraceParams(), "head");
+    initThreadPlacement(parser.getThreadParams(), {THREAD_ROLE_SENDER, THREAD_ROLE_SYNC}, THREAD_ROLE_ENCODER);
+    
+    // serve the metrics (disabled with port 0)
+    std::unique_ptr<MetricsServer> metrics_server;
+    const metrics_params_t metrics_params = parser.getMetricsParams();
+    if(std::get<1>(metrics_params) != METRICS_PORT_DISABLED){
+        metrics_server.reset(new MetricsServer(metrics_params));
+    }
     
     // launch the frontend server
     _asio::io_service ios;
@@ -0,0 +1,73 @@
+/******************************************
+*             media_clock.cpp             *
+*  (clock to pace the frames of a video)  *
+******************************************/
+
+#include "media_clock.hpp"
+
+/* constructor */
+MediaClock::MediaClock(const bool enabled):
+    enabled(enabled)
+{}
+
+/* get the time of the steady clock */
+const int64_t MediaClock::now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/* anchor a timestamp to the current time */
+void MediaClock::anchor(const int64_t now_t, const int64_t pts){
+    this->origin_t = now_t;
+    this->origin_pts = pts;
+    this->last_pts = pts;
+    this->anchored = true;
+}
+
+/* wait until the deadline of a frame, or return false if it cannot be processed before the next frame is due */
+const bool MediaClock::schedule(const int64_t pts){
+    if(!this->enabled || pts == MEDIA_TIME_NONE){
+        return true;
+    }
+    
+    // anchor the clock at the first frame or when the timestamps go back (e.g. a looped video)
+    const int64_t now_t = this->now();
+    if(!this->anchored || pts < this->last_pts){
+        this->anchor(now_t, pts);
+        return true;
+    }
+    this->frame_interval = pts - this->last_pts;
+    this->last_pts = pts;
+    
+    // wait for an early frame
+    const int64_t deadline = this->origin_t + (pts-this->origin_pts);
+    if(now_t < deadline){
+        std::this_thread::sleep_for(std::chrono::nanoseconds(deadline-now_t));
+        return true;
+    }
+    
+    // catch up from the current frame after a stall (e.g. until the display nodes connect)
+    if(now_t-deadline > MEDIA_RESYNC_LATENESS){
+        _ml::notice("Media clock was anchored again after a stall of " + std::to_string((now_t-deadline)/1000000) + " ms");
+        this->anchor(now_t, pts);
+        return true;
+    }
+    return now_t+int64_t(this->cost) <= deadline+this->frame_interval;
+}
+
+/* add the time to process a frame to the average */
+void MediaClock::addCost(const int64_t elapsed_time){
+    if(this->cost == 0){
+        this->cost = elapsed_time;
+    }else{
+        this->cost += MEDIA_COST_WEIGHT * (elapsed_time-this->cost);
+    }
+}
+
+/* anchor the clock again at the next frame (e.g. when the source is switched) */
+void MediaClock::reset(const bool enabled){
+    this->enabled = enabled;
+    this->anchored = false;
+    this->frame_interval = 0;
+}
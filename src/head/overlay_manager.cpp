@@ -0,0 +1,299 @@
+/****************************************************
+*                overlay_manager.cpp                *
+*  (manager of the overlays on the display nodes)   *
+****************************************************/
+
+#include "overlay_manager.hpp"
+
+static const std::string serializeCmd(JsonHandler& cmd);  // serialize a command in a line
+
+/* serialize a command in a line (without the newline of the JSON writer) */
+static const std::string serializeCmd(JsonHandler& cmd){
+    std::string cmd_str = cmd.serialize();
+    while(!cmd_str.empty() && cmd_str[cmd_str.length()-1] == OVERLAY_DELIMITER){
+        cmd_str.erase(cmd_str.length()-1);
+    }
+    return cmd_str;
+}
+
+/* constructor */
+OverlayManager::OverlayManager(const overlay_list_t& overlay_list, const int column, const int row,
+                               const int bezel_w, const int bezel_h, const double blend_gamma, const int width,
+                               const int height, const tile_shape_list_t& tile_shapes):
+    width(width),
+    height(height),
+    tile_shapes(tile_shapes),
+    peers(column*row)
+{
+    this->setOverlays(overlay_list, column, row, bezel_w, bezel_h, blend_gamma);
+}
+
+/* rasterize a glyph atlas (the printable ASCII in cells of the widest glyph) */
+const int OverlayManager::addAtlas(const double scale, int& cell_w){
+    const int thickness = std::max(1, (int)(scale*2));
+    int glyph_w = 0;
+    int glyph_h = 0;
+    int baseline_h = 0;
+    for(int i=0; i<OVERLAY_GLYPH_NUM; ++i){
+        int baseline;
+        const cv::Size size = cv::getTextSize(std::string(1, (char)(OVERLAY_GLYPH_FIRST+i)), OVERLAY_FONT, scale, thickness, &baseline);
+        glyph_w = std::max(glyph_w, size.width);
+        glyph_h = std::max(glyph_h, size.height);
+        baseline_h = std::max(baseline_h, baseline);
+    }
+    cell_w = glyph_w + OVERLAY_GLYPH_PADDING*2;
+    const int cell_h = glyph_h + baseline_h + OVERLAY_GLYPH_PADDING*2;
+    
+    // draw the glyphs side by side in the alpha channel
+    cv::Mat atlas = cv::Mat::zeros(cell_h, cell_w*OVERLAY_GLYPH_NUM, CV_8UC1);
+    for(int i=0; i<OVERLAY_GLYPH_NUM; ++i){
+        cv::putText(atlas,
+                    std::string(1, (char)(OVERLAY_GLYPH_FIRST+i)),
+                    cv::Point(cell_w*i+OVERLAY_GLYPH_PADDING, glyph_h+OVERLAY_GLYPH_PADDING),
+                    OVERLAY_FONT,
+                    scale,
+                    cv::Scalar(255),
+                    thickness,
+                    cv::LINE_AA
+        );
+    }
+    JsonHandler cmd;
+    cmd.setStringParam("cmd", OVERLAY_ATLAS);
+    cmd.setIntParam("id", this->resource_cmds.size());
+    cmd.setIntParam("cell_width", cell_w);
+    cmd.setIntParam("cell_height", cell_h);
+    cmd.setStringParam("data", encodeBase64(atlas.data, atlas.total()));
+    this->resource_cmds.push_back(serializeCmd(cmd));
+    return this->resource_cmds.size() - 1;
+}
+
+/* read an RGBA sprite (-1 if the file can not be read) */
+const int OverlayManager::addSprite(const OverlayParams& params){
+    const size_t size = (size_t)params.width * params.height * OVERLAY_SPRITE_CHANNEL_NUM;
+    std::vector<unsigned char> pixels(size);
+    std::ifstream file(params.text, std::ios::in|std::ios::binary);
+    if(!file.read((char*)pixels.data(), size)){
+        _ml::warn("Could not read sprite", params.text);
+        return -1;
+    }
+    
+    // the pages of the display nodes are in the channel order of the source frames
+    const cv::Mat rgba(params.height, params.width, CV_8UC4, pixels.data());
+    cv::Mat bgra;
+    cv::cvtColor(rgba, bgra, cv::COLOR_RGBA2BGRA);
+    JsonHandler cmd;
+    cmd.setStringParam("cmd", OVERLAY_SPRITE);
+    cmd.setIntParam("id", this->resource_cmds.size());
+    cmd.setIntParam("width", params.width);
+    cmd.setIntParam("height", params.height);
+    cmd.setStringParam("data", encodeBase64(bgra.data, bgra.total()*bgra.elemSize()));
+    this->resource_cmds.push_back(serializeCmd(cmd));
+    return this->resource_cmds.size() - 1;
+}
+
+/* replace the overlays and the edges to blend (sent again to all the display nodes with their next sync messages) */
+void OverlayManager::setOverlays(const overlay_list_t& overlay_list, const int column, const int row,
+                                 const int bezel_w, const int bezel_h, const double blend_gamma)
+{
+    std::lock_guard<std::mutex> lock(this->lock);
+    this->origins = std::vector<cv::Point>(column*row);
+    for(int j=0; j<row; ++j){
+        for(int i=0; i<column; ++i){
+            this->origins[i+column*j] = cv::Point((this->width+bezel_w*2)*i, (this->height+bezel_h*2)*j);
+        }
+    }
+    
+    // a negative bezel overlaps the neighbors by twice its length, and each display fades the strips facing them
+    const int overlap_w = std::max(-bezel_w*2, 0);
+    const int overlap_h = std::max(-bezel_h*2, 0);
+    this->blend_cmds = std::vector<std::string>(column*row);
+    if(overlap_w > 0 || overlap_h > 0){
+        for(int j=0; j<row; ++j){
+            for(int i=0; i<column; ++i){
+                this->blend_cmds[i+column*j] = this->makeBlendCmd(i+column*j,
+                                                                  i>0 ? overlap_w : 0,
+                                                                  i<column-1 ? overlap_w : 0,
+                                                                  j>0 ? overlap_h : 0,
+                                                                  j<row-1 ? overlap_h : 0,
+                                                                  blend_gamma
+                );
+            }
+        }
+    }
+    
+    // the texts and the sprites are drawn upright in the pages, so they would be turned on a rotated display
+    bool rotated = false;
+    for(const tile_shape_t& tile_shape : this->tile_shapes){
+        rotated = rotated || std::get<2>(tile_shape) != ROTATION_NONE;
+    }
+    if(rotated && !overlay_list.empty()){
+        _ml::warn("Overlays are not shown on display", "Tile of display is rotated");
+    }
+    
+    // the glyph atlases are shared by the texts of the same scale
+    std::map<double, int> atlas_ids;
+    std::map<double, int> cell_widths;
+    this->resource_cmds.clear();
+    this->overlays.clear();
+    for(const OverlayParams& params : overlay_list){
+        OverlayState overlay;
+        overlay.params = params;
+        overlay.cell_w = 0;
+        if(params.type == OVERLAY_TYPE_SPRITE){
+            overlay.resource = this->addSprite(params);
+            if(overlay.resource < 0){
+                continue;
+            }
+        }else{
+            if(atlas_ids.count(params.scale) == 0){
+                atlas_ids[params.scale] = this->addAtlas(params.scale, cell_widths[params.scale]);
+            }
+            overlay.resource = atlas_ids[params.scale];
+            overlay.cell_w = cell_widths[params.scale];
+            overlay.text = params.text;
+        }
+        this->overlays.push_back(overlay);
+    }
+    ++this->epoch;
+}
+
+/* update the text of a clock (a new version is sent when the text changes) */
+void OverlayManager::refresh(OverlayState& overlay){
+    if(overlay.params.type != OVERLAY_TYPE_CLOCK){
+        return;
+    }
+    const std::time_t now = std::time(nullptr);
+    struct tm local_t;
+    localtime_r(&now, &local_t);
+    char text[OVERLAY_CLOCK_SIZE];
+    if(std::strftime(text, sizeof(text), overlay.params.text.c_str(), &local_t) == 0){
+        text[0] = '\0';
+    }
+    if(overlay.text != text){
+        overlay.text = text;
+        ++overlay.version;
+    }
+}
+
+/* get the page size of a display before its rotation (the size of the cell if the display does not override it) */
+const cv::Size OverlayManager::getUprightSize(const int id){
+    if(id >= (int)this->tile_shapes.size()){
+        return cv::Size(this->width, this->height);
+    }
+    int tile_w, tile_h, rotation;
+    std::tie(tile_w, tile_h, rotation) = this->tile_shapes[id];
+    const bool quarter_turn = rotation == ROTATION_90 || rotation == ROTATION_270;
+    return quarter_turn ? cv::Size(tile_h, tile_w) : cv::Size(tile_w, tile_h);
+}
+
+/* make the command to blend the edges of a display (the strips in the cell are scaled and rotated into its page as the tile is) */
+const std::string OverlayManager::makeBlendCmd(const int id, const int left, const int right, const int top,
+                                               const int bottom, const double blend_gamma)
+{
+    const cv::Size upright_size = this->getUprightSize(id);
+    const double scale_x = (double)upright_size.width / this->width;
+    const double scale_y = (double)upright_size.height / this->height;
+    int edges[4] = {(int)std::lround(left*scale_x), (int)std::lround(top*scale_y),
+                    (int)std::lround(right*scale_x), (int)std::lround(bottom*scale_y)};
+    
+    // a clockwise quarter turn moves the left edge to the top (the edges are in clockwise order)
+    const int rotation = id<(int)this->tile_shapes.size() ? std::get<2>(this->tile_shapes[id]) : ROTATION_NONE;
+    std::rotate(edges, edges+4-rotation/ROTATION_90, edges+4);
+    JsonHandler cmd;
+    cmd.setIntParam("display", id);
+    cmd.setStringParam("cmd", OVERLAY_BLEND);
+    cmd.setIntParam("left", edges[0]);
+    cmd.setIntParam("top", edges[1]);
+    cmd.setIntParam("right", edges[2]);
+    cmd.setIntParam("bottom", edges[3]);
+    cmd.setDoubleParam("gamma", blend_gamma);
+    return serializeCmd(cmd);
+}
+
+/* make the command to place an overlay on a display (in the coordinates of the display, scaled into its page) */
+const std::string OverlayManager::makeLayerCmd(const int index, const int id, const int round){
+    const OverlayState& overlay = this->overlays[index];
+    const OverlayParams& params = overlay.params;
+    const cv::Point origin = params.per_display ? cv::Point(0, 0) : this->origins[id];
+    const cv::Size upright_size = this->getUprightSize(id);
+    JsonHandler cmd;
+    cmd.setIntParam("display", id);
+    cmd.setIntParam("layer", index);
+    cmd.setIntParam("x", (int)((int64_t)(params.x-origin.x)*upright_size.width/this->width));
+    cmd.setIntParam("y", (int)((int64_t)(params.y-origin.y)*upright_size.height/this->height));
+    if(params.type == OVERLAY_TYPE_SPRITE){
+        cmd.setStringParam("cmd", OVERLAY_IMAGE);
+        cmd.setIntParam("sprite", overlay.resource);
+        return serializeCmd(cmd);
+    }
+    
+    // the label of each display gets its ID
+    std::string text = overlay.text;
+    const size_t id_pos = text.find(OVERLAY_DISPLAY_ID);
+    if(id_pos != std::string::npos){
+        text.replace(id_pos, OVERLAY_DISPLAY_ID.length(), std::to_string(id));
+    }
+    
+    // a ticker starts at the same phase on all the displays, including the ones joining later
+    int clip_w = 0;
+    int offset = 0;
+    if(params.type == OVERLAY_TYPE_TICKER){
+        clip_w = params.width;
+        offset = (int)((int64_t)round * params.speed % (clip_w + overlay.cell_w*(int)text.length()));
+    }
+    cmd.setStringParam("cmd", OVERLAY_TEXT);
+    cmd.setIntParam("atlas", overlay.resource);
+    cmd.setStringParam("text", text);
+    cmd.setIntParam("r", params.color[0]);
+    cmd.setIntParam("g", params.color[1]);
+    cmd.setIntParam("b", params.color[2]);
+    cmd.setIntParam("clip_width", clip_w);
+    cmd.setIntParam("speed", params.type==OVERLAY_TYPE_TICKER ? params.speed : 0);
+    cmd.setIntParam("offset", offset);
+    return serializeCmd(cmd);
+}
+
+/* get the commands for the display nodes of a connection (all the overlays for a new connection, and the changed ones otherwise) */
+const std::string OverlayManager::getCmds(const std::vector<int>& ids, const int gen, const int round){
+    std::lock_guard<std::mutex> lock(this->lock);
+    for(OverlayState& overlay : this->overlays){
+        this->refresh(overlay);
+    }
+    
+    std::string reset_cmds, layer_cmds;
+    bool send_resources = false;
+    for(const int id : ids){
+        OverlayPeer& peer = this->peers[id];
+        if(peer.gen != gen || peer.epoch != this->epoch){
+            JsonHandler cmd;
+            cmd.setIntParam("display", id);
+            cmd.setStringParam("cmd", OVERLAY_RESET);
+            reset_cmds += OVERLAY_DELIMITER + serializeCmd(cmd);
+            if(!this->blend_cmds[id].empty()){
+                reset_cmds += OVERLAY_DELIMITER + this->blend_cmds[id];
+            }
+            send_resources = true;
+            peer.gen = gen;
+            peer.epoch = this->epoch;
+            peer.versions.assign(this->overlays.size(), OVERLAY_GEN_NONE);
+        }
+        const bool upright = id >= (int)this->tile_shapes.size() || std::get<2>(this->tile_shapes[id]) == ROTATION_NONE;
+        for(int i=0; i<(int)this->overlays.size(); ++i){
+            if(peer.versions[i] != this->overlays[i].version){
+                if(upright){
+                    layer_cmds += OVERLAY_DELIMITER + this->makeLayerCmd(i, id, round);
+                }
+                peer.versions[i] = this->overlays[i].version;
+            }
+        }
+    }
+    
+    // the resources are sent once to the connection (a relay node passes them to all its display nodes)
+    std::string cmds = reset_cmds;
+    if(send_resources){
+        for(const std::string& resource_cmd : this->resource_cmds){
+            cmds += OVERLAY_DELIMITER + resource_cmd;
+        }
+    }
+    return cmds + layer_cmds;
+}
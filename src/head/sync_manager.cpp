@@ -6,18 +6,54 @@
 #include "sync_manager.hpp"
 
 /* constructor */
-SyncManager::SyncManager(_asio::io_service& ios, std::vector<sock_ptr_t>& socks,
-                         jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list):
-    ios(ios),
-    socks(socks),
-    display_num(socks.size()),
-    sync_count(0),
+SyncManager::SyncManager(IoShards& shards, ConnectionTable& table, const conn_list_t& conns, const int sync_timeout,
+                         jpeg_params_t& ycbcr_format_list, jpeg_params_t& quality_list, OverlayManager& overlays):
+    shards(shards),
+    table(table),
+    conns(conns),
+    conn_num(conns.size()),
+    sync_timeout(sync_timeout),
+    socks(conns.size()),
+    sock_gens(conns.size(), CONN_NO_GEN),
+    sync_msgs(conns.size()),
+    synced_rounds(conns.size(), SYNC_ROUND_NONE),
+    timer(shards.getService(0)),
     ycbcr_format_list(ycbcr_format_list),
-    quality_list(quality_list)
+    quality_list(quality_list),
+    overlays(overlays),
+    recv_depths(quality_list.size())
 {
-    for(int i=0; i<this->display_num; ++i){
+    for(int i=0; i<this->conn_num; ++i){
         this->stream_bufs.push_back(std::make_shared<_asio::streambuf>());
     }
+    this->table.addDropCallback(std::bind(&SyncManager::onDrop, this, std::placeholders::_1));
+    this->initMetrics();
+}
+
+/* register the metrics (the statistics of the display nodes are reported in the sync messages) */
+void SyncManager::initMetrics(){
+    for(const conn_params_t& conn : this->conns){
+        this->lag_hists.push_back(_mt::addHistogram(
+            "tdw_sync_lag_seconds", "Arrival of each sync message behind the first one in a round",
+            _mt::labels({{"conn", std::get<0>(conn)}})
+        ));
+    }
+    for(int i=0; i<int(this->recv_depths.size()); ++i){
+        const std::string labels = _mt::labels({{"display", std::to_string(i)}});
+        this->recv_depths[i].store(0, std::memory_order_relaxed);
+        this->wait_hists.push_back(_mt::addHistogram(
+            "tdw_display_wait_seconds", "Wait for a decoded frame in each display node", labels
+        ));
+        _mt::addGauge("tdw_display_recv_queue_depth", "JPEG frames stored in the receive framebuffer of each display node",
+                      labels, std::bind(&SyncManager::getRecvDepth, this, i));
+    }
+    this->sync_rounds = _mt::addCounter("tdw_sync_rounds_total", "Number of the completed sync rounds", "");
+    this->sync_timeouts = _mt::addCounter("tdw_sync_timeouts_total", "Number of the connections dropped for the sync timeout", "");
+}
+
+/* get the receive framebuffer depth reported by a display node */
+const double SyncManager::getRecvDepth(const int id){
+    return this->recv_depths[id].load(std::memory_order_relaxed);
 }
 
 /* change the YCbCr format */
@@ -70,12 +106,24 @@ const std::string SyncManager::changeQuality(const int change_flag, const int id
     return std::to_string(new_quality);
 }
 
-/* parse a sync message */
-void SyncManager::parseSyncMsg(const std::string& sync_msg, const int id){
-    this->sync_params.deserialize(sync_msg);
-    const int param_flag = this->sync_params.getIntParam("param");
-    const int change_flag = this->sync_params.getIntParam("change");
-    
+/* parse a sync message (a relay node aggregates the sync messages keyed by the display ID) */
+void SyncManager::parseSyncMsg(const std::string& sync_msg, const int conn_id){
+    JsonHandler sync_params;
+    sync_params.deserialize(sync_msg);
+    const bool relay = std::get<2>(this->conns[conn_id]);
+    for(const int id : std::get<1>(this->conns[conn_id])){
+        const std::string key_prefix = relay ? std::to_string(id)+"." : "";
+        this->applySyncParams(sync_params.getIntParam(key_prefix+"param"),
+                              sync_params.getIntParam(key_prefix+"change"),
+                              id
+        );
+        this->wait_hists[id]->observe((int64_t)sync_params.getIntParam(key_prefix+"wait_us") * 1000);
+        this->recv_depths[id].store(sync_params.getIntParam(key_prefix+"recv_depth"), std::memory_order_relaxed);
+    }
+}
+
+/* apply the JPEG parameters requested by a display node */
+void SyncManager::applySyncParams(const int param_flag, const int change_flag, const int id){
     if(param_flag == JPEG_YCbCr_CHANGE){
         const std::string new_type = this->changeYCbCr(change_flag, id);
         if(new_type != ""){
@@ -89,23 +137,193 @@ void SyncManager::parseSyncMsg(const std::string& sync_msg, const int id){
     }
 }
 
+/* add the control connection of a node (after the initial message is sent) */
+void SyncManager::addConnection(const int id, const int gen, const sock_ptr_t sock){
+    // move the socket onto the I/O thread of the connection
+    const auto sock_fd = sock->release();
+    const sock_ptr_t shard_sock = std::make_shared<_ip::tcp::socket>(this->shards.getService(id), _ip::tcp::v4(), sock_fd);
+    _asio::post(this->shards.getService(id),
+                boost::bind(&SyncManager::attachConnection, this, id, gen, shard_sock)
+    );
+}
+
+/* start receiving the sync messages of a connection (in the I/O thread of the connection) */
+void SyncManager::attachConnection(const int id, const int gen, const sock_ptr_t sock){
+    if(this->table.getState(id, gen) == CONN_DOWN){
+        return;
+    }
+    {
+        // an old socket of the node is closed when it is released
+        std::lock_guard<std::mutex> lock(this->sync_lock);
+        this->socks[id] = sock;
+        this->sock_gens[id] = gen;
+        this->synced_rounds[id] = SYNC_ROUND_NONE;
+    }
+    this->stream_bufs[id] = std::make_shared<_asio::streambuf>();
+    this->readSync(id, gen);
+}
+
+/* close the socket of a dropped connection (in the I/O thread of the connection) */
+void SyncManager::closeConnection(const int id, const int gen){
+    if(this->sock_gens[id] != gen){
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->sync_lock);
+        this->sock_gens[id] = CONN_NO_GEN;
+        this->synced_rounds[id] = SYNC_ROUND_NONE;
+    }
+    err_t err;
+    this->socks[id]->close(err);
+    this->socks[id].reset();
+}
+
+/* the callback when a connection is dropped (the barrier is released if it waited for the connection) */
+void SyncManager::onDrop(const int id){
+    std::lock_guard<std::mutex> lock(this->sync_lock);
+    const int gen = this->sock_gens[id];
+    if(gen != CONN_NO_GEN && this->table.getState(id, gen) == CONN_DOWN){
+        _asio::post(this->shards.getService(id),
+                    boost::bind(&SyncManager::closeConnection, this, id, gen)
+        );
+    }
+    this->checkBarrier();
+}
+
+/* start receiving a sync message */
+void SyncManager::readSync(const int id, const int gen){
+    _asio::async_read_until(*this->socks[id],
+                            *this->stream_bufs[id],
+                            MSG_DELIMITER,
+                            boost::bind(&SyncManager::onRecvSync, this, _ph::error, _ph::bytes_transferred, id, gen)
+    );
+}
+
 /* the callback when receiving a sync message */
-void SyncManager::onRecvSync(const err_t& err, size_t t_bytes, const int id){
+void SyncManager::onRecvSync(const err_t& err, size_t t_bytes, const int id, const int gen){
+    if(gen != this->sock_gens[id]){
+        return;
+    }
     if(err){
-        _ml::caution("Failed to receive sync message", err.message());
-        std::exit(EXIT_FAILURE);
+        this->table.drop(id, gen, "Failed to receive sync message: " + err.message());
+        return;
+    }
+    if(this->table.getState(id, gen) != CONN_LIVE){
+        this->table.drop(id, gen, "Sync message was received before the first frame");
+        return;
     }
     
     // parse a sync message
+    const int64_t arrival_t = _ft::now();
     const auto data = this->stream_bufs[id]->data();
     std::string sync_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
     sync_msg.erase(sync_msg.length()-MSG_DELIMITER_LEN);
     this->parseSyncMsg(sync_msg, id);
     this->stream_bufs[id]->consume(t_bytes);
     
-    // synchronize all the display nodes
-    this->sync_count.fetch_add(1, std::memory_order_release);
-    if(this->sync_count.load(std::memory_order_acquire) == this->display_num){
+    // count the message in the round of its frame (a new connection starts from the frame it was admitted at)
+    std::lock_guard<std::mutex> lock(this->sync_lock);
+    const int msg_round = this->synced_rounds[id]==SYNC_ROUND_NONE ? this->table.getJoinSeq(id) : this->synced_rounds[id]+1;
+    this->synced_rounds[id] = msg_round;
+    if(msg_round == this->round){
+        // measure the lag behind the first sync message in the round
+        if(this->round_t == 0){
+            this->round_t = arrival_t;
+        }
+        this->lag_hists[id]->observe(arrival_t-this->round_t);
+    }
+    this->checkBarrier();
+}
+
+/* the callback when sending a sync message */
+void SyncManager::onSendSync(const err_t& err, size_t t_bytes, const int id, const int gen){
+    if(gen != this->sock_gens[id]){
+        return;
+    }
+    if(err){
+        this->table.drop(id, gen, "Failed to send sync message: " + err.message());
+        return;
+    }
+    
+    // restart receiving sync messages
+    this->readSync(id, gen);
+}
+
+/* the callback when the sync timeout expires (the connections holding the barrier are dropped) */
+void SyncManager::onTimeout(const err_t& err, const int timeout_round){
+    if(err){
+        return;
+    }
+    std::vector<int> laggards;
+    int sync_timeout;
+    {
+        std::lock_guard<std::mutex> lock(this->sync_lock);
+        if(timeout_round != this->round){
+            return;
+        }
+        sync_timeout = this->sync_timeout;
+        for(const int id : this->getParticipants()){
+            if(this->sock_gens[id] != this->table.getGeneration(id) || this->synced_rounds[id] < this->round){
+                laggards.push_back(id);
+            }
+        }
+    }
+    for(const int id : laggards){
+        this->sync_timeouts->add(1);
+        this->table.drop(id, this->table.getGeneration(id),
+                         "No sync message in " + std::to_string(sync_timeout) + " ms");
+    }
+}
+
+/* get the connections in the current round (the live connections admitted at or before its frame) */
+const std::vector<int> SyncManager::getParticipants(){
+    std::vector<int> participants;
+    for(int i=0; i<this->conn_num; ++i){
+        if(this->table.getState(i, this->table.getGeneration(i)) == CONN_LIVE
+           && this->table.getJoinSeq(i) <= this->round){
+            participants.push_back(i);
+        }
+    }
+    return participants;
+}
+
+/* complete the rounds which all the participants reached (call with the lock) */
+void SyncManager::checkBarrier(){
+    while(true){
+        const std::vector<int> participants = this->getParticipants();
+        if(participants.empty()){
+            // skip the frames which no connection displays (e.g. while all the connections were down)
+            int next_round = SYNC_ROUND_NONE;
+            for(int i=0; i<this->conn_num; ++i){
+                if(this->table.getState(i, this->table.getGeneration(i)) == CONN_LIVE
+                   && (next_round == SYNC_ROUND_NONE || this->table.getJoinSeq(i) < next_round)){
+                    next_round = this->table.getJoinSeq(i);
+                }
+            }
+            if(next_round == SYNC_ROUND_NONE){
+                return;
+            }
+            this->round = next_round;
+            this->round_t = 0;
+            continue;
+        }
+        
+        // wait for the rest of the participants (dropped after the sync timeout)
+        int synced_num = 0;
+        for(const int id : participants){
+            if(this->sock_gens[id] == this->table.getGeneration(id) && this->synced_rounds[id] >= this->round){
+                ++synced_num;
+            }
+        }
+        if(synced_num < int(participants.size())){
+            if(synced_num > 0 && this->timer_round != this->round && this->sync_timeout != SYNC_TIMEOUT_DISABLED){
+                this->timer_round = this->round;
+                this->timer.expires_after(_chrono::milliseconds(this->sync_timeout));
+                this->timer.async_wait(boost::bind(&SyncManager::onTimeout, this, _ph::error, this->round));
+            }
+            return;
+        }
+        
         // calculate the current frame rate
         ++this->frame_count;
         if(this->frame_count%FPS_INTERVAL == 0){
@@ -114,47 +332,40 @@ void SyncManager::onRecvSync(const err_t& err, size_t t_bytes, const int id){
             _ml::notice(std::to_string(this->frame_count) + ": " + std::to_string(fps) + "fps");
             this->pre_t = post_t;
         }
-        this->sync_count.store(0, std::memory_order_release);
-        this->sendSync();
+        this->sync_rounds->add(1);
+        
+        // release the participants in their I/O threads
+        for(const int id : participants){
+            _asio::post(this->shards.getService(id),
+                        boost::bind(&SyncManager::writeSync, this, id, this->sock_gens[id], this->round)
+            );
+        }
+        ++this->round;
+        this->round_t = 0;
+        this->timer.cancel();
     }
 }
 
-/* the callback when sending a sync message */
-void SyncManager::onSendSync(const err_t& err, size_t t_bytes, const int id){
-    if(err){
-        _ml::caution("Failed to send sync message", err.message());
-        std::exit(EXIT_FAILURE);
+/* write a sync message with the overlay commands for the connection (in the I/O thread of the connection) */
+void SyncManager::writeSync(const int id, const int gen, const int round){
+    if(gen != this->sock_gens[id]){
+        return;
     }
-    
-    // restart receiving sync messages
-    _asio::async_read_until(*this->socks[id],
-                            *this->stream_bufs[id],
-                            MSG_DELIMITER,
-                            boost::bind(&SyncManager::onRecvSync, this, _ph::error, _ph::bytes_transferred, id)
+    this->sync_msgs[id] = SYNC_HEAD + this->overlays.getCmds(std::get<1>(this->conns[id]), gen, round) + MSG_DELIMITER;
+    _asio::async_write(*this->socks[id],
+                       _asio::buffer(this->sync_msgs[id]),
+                       boost::bind(&SyncManager::onSendSync, this, _ph::error, _ph::bytes_transferred, id, gen)
     );
 }
 
-/* send a sync message */
-void SyncManager::sendSync(){
-    const std::string send_msg = "sync" + MSG_DELIMITER;
-    for(int i=0; i<this->display_num; ++i){
-        _asio::async_write(*this->socks[i],
-                           _asio::buffer(send_msg),
-                           boost::bind(&SyncManager::onSendSync, this, _ph::error, _ph::bytes_transferred, i)
-        );
-    }
-}
-
-/* start the synchronization process */
+/* start the synchronization process (the connections are added by the frontend server) */
 void SyncManager::run(){
     this->pre_t = _chrono::high_resolution_clock::now();
-    for(int i=0; i<this->display_num; ++i){
-        _asio::async_read_until(*this->socks[i],
-                                *this->stream_bufs[i],
-                                MSG_DELIMITER,
-                                boost::bind(&SyncManager::onRecvSync, this, _ph::error, _ph::bytes_transferred, i)
-        );
-    }
-    this->ios.run();
+    this->shards.run();
 }
 
+/* change the time to wait for the sync messages (applied from the next round) */
+void SyncManager::setSyncTimeout(const int sync_timeout){
+    std::lock_guard<std::mutex> lock(this->sync_lock);
+    this->sync_timeout = sync_timeout;
+}
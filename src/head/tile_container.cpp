@@ -0,0 +1,127 @@
+/******************************************
+*           tile_container.cpp            *
+*  (container of pre-encoded JPEG tiles)  *
+******************************************/
+
+#include "tile_container.hpp"
+
+/* constructor (map the container onto the memory) */
+TileContainer::TileContainer(const std::string& filename, const int display_num){
+    // open the container
+    this->fd = open(filename.c_str(), O_RDONLY);
+    if(this->fd == -1){
+        _ml::caution("Failed to open tile container", filename);
+        std::exit(EXIT_FAILURE);
+    }
+    struct stat file_stat;
+    if(fstat(this->fd, &file_stat) == -1 || (size_t)file_stat.st_size < sizeof(TileContainerHeader)){
+        _ml::caution("Tile container is invalid", filename);
+        std::exit(EXIT_FAILURE);
+    }
+    this->file_size = file_stat.st_size;
+    
+    // map the container onto the memory (JPEG tiles are sent from the page cache directly)
+    void *file_ptr = mmap(NULL, this->file_size, PROT_READ, MAP_SHARED, this->fd, 0);
+    if(file_ptr == MAP_FAILED){
+        _ml::caution("Failed to map tile container", "mmap failed");
+        std::exit(EXIT_FAILURE);
+    }
+    madvise(file_ptr, this->file_size, MADV_SEQUENTIAL|MADV_WILLNEED);
+    this->file_ptr = (const unsigned char*)file_ptr;
+    
+    // check the header
+    this->header = (const TileContainerHeader*)this->file_ptr;
+    if(this->header->magic != TILE_CONTAINER_MAGIC || this->header->version != TILE_CONTAINER_VERSION){
+        _ml::caution("Tile container is invalid", filename);
+        std::exit(EXIT_FAILURE);
+    }
+    if(int(this->header->display_num) != display_num){
+        _ml::caution("Number of display nodes does not match tile container", std::to_string(this->header->display_num));
+        std::exit(EXIT_FAILURE);
+    }
+    const uint64_t index_offset = this->header->index_offset;
+    const uint64_t entry_num = (uint64_t)this->header->frame_num * this->header->display_num;
+    const uint64_t index_size = sizeof(TileIndexEntry) * entry_num;
+    if(this->header->frame_num == 0 || index_offset < sizeof(TileContainerHeader) || index_offset > this->file_size
+       || index_size > this->file_size-index_offset){
+        _ml::caution("Tile container is broken", filename);
+        std::exit(EXIT_FAILURE);
+    }
+    this->index = (const TileIndexEntry*)(this->file_ptr+index_offset);
+    
+    // every tile lies between the header and the index (the sum is not computed, so it does not overflow)
+    for(uint64_t i=0; i<entry_num; ++i){
+        const TileIndexEntry& entry = this->index[i];
+        if(entry.offset < sizeof(TileContainerHeader) || entry.offset > index_offset
+           || entry.size > index_offset-entry.offset){
+            _ml::caution("Tile container is broken", filename);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    _ml::notice("Loaded tile container with " + std::to_string(this->header->frame_num) + " frames");
+}
+
+/* destructor (unmap the container) */
+TileContainer::~TileContainer(){
+    munmap((void*)this->file_ptr, this->file_size);
+    close(this->fd);
+}
+
+/* get the number of the frames */
+const int TileContainer::getFrameNum(){
+    return this->header->frame_num;
+}
+
+/* get a JPEG tile */
+const unsigned char *TileContainer::getTile(const int frame, const int id, size_t& tile_size){
+    const TileIndexEntry& entry = this->index[frame*this->header->display_num+id];
+    tile_size = entry.size;
+    return this->file_ptr + entry.offset;
+}
+
+/* constructor (open the output file) */
+TileContainerWriter::TileContainerWriter(const std::string& filename, const int display_num):
+    display_num(display_num),
+    offset(sizeof(TileContainerHeader))
+{
+    this->fp = std::fopen(filename.c_str(), "wb");
+    if(this->fp == NULL){
+        _ml::caution("Failed to create tile container", filename);
+        std::exit(EXIT_FAILURE);
+    }
+    
+    // reserve the header (filled in on closing)
+    const TileContainerHeader header = {};
+    std::fwrite(&header, sizeof(header), 1, this->fp);
+}
+
+/* destructor (write the tile index and the header) */
+TileContainerWriter::~TileContainerWriter(){
+    const TileContainerHeader header = {
+        TILE_CONTAINER_MAGIC,
+        TILE_CONTAINER_VERSION,
+        (uint32_t)this->display_num,
+        (uint32_t)this->getFrameNum(),
+        this->offset
+    };
+    std::fwrite(this->index.data(), sizeof(TileIndexEntry), this->index.size(), this->fp);
+    std::fseek(this->fp, 0, SEEK_SET);
+    std::fwrite(&header, sizeof(header), 1, this->fp);
+    std::fclose(this->fp);
+}
+
+/* append a JPEG tile (in order of frames and display nodes) */
+void TileContainerWriter::append(const std::string& jpeg_frame){
+    if(std::fwrite(jpeg_frame.data(), 1, jpeg_frame.length(), this->fp) != jpeg_frame.length()){
+        _ml::caution("Failed to write tile container", "Disk may be full");
+        std::exit(EXIT_FAILURE);
+    }
+    const TileIndexEntry entry = {this->offset, jpeg_frame.length()};
+    this->index.push_back(entry);
+    this->offset += jpeg_frame.length();
+}
+
+/* get the number of the written frames */
+const int TileContainerWriter::getFrameNum(){
+    return this->index.size() / this->display_num;
+}
@@ -0,0 +1,58 @@
+/*********************************************
+*              tile_packer.cpp               *
+*  (main function to pre-encode JPEG tiles)  *
+*********************************************/
+
+#include "tile_packer.hpp"
+
+/* main function */
+int main(int argc, char *argv[]){
+    // parse the head_conf.json
+    if(argc != ARGUMENT_NUM){
+        _ml::caution("Number of arguments is invalid", "Usage: tile_packer <config file> <output file>");
+        std::exit(EXIT_FAILURE);
+    }
+    ConfigParser parser(argv[CONF_ARG_INDEX]);
+    std::string src;
+    int column, row, bezel_w, bezel_h, width, height, stream_port, sendbuf_num, recvbuf_num;
+    int target_fps, ycbcr_format, quality, dec_thre_num, tuning_term;
+    double fps_jitter;
+    ip_list_t ip_addrs;
+    std::tie(
+        src, target_fps, fps_jitter, column, row, bezel_w, bezel_h, width, height, stream_port,
+        sendbuf_num, recvbuf_num, ycbcr_format, quality, dec_thre_num, tuning_term, ip_addrs
+    ) = parser.getFrontendServerParams();
+    const int display_num = column * row;
+    
+    // prepare the encoder with the initial JPEG parameters (the quality of each display node)
+    const node_list_t nodes = parser.getNodes();
+    jpeg_params_t ycbcr_format_list(display_num);
+    jpeg_params_t quality_list(display_num);
+    std::vector<tranbuf_ptr_t> pack_bufs(display_num);
+    for(int i=0; i<display_num; ++i){
+        pack_bufs[i] = std::make_shared<TransceiveFramebuffer>(PACKER_BUF_NUM);
+        ycbcr_format_list[i].store(ycbcr_format, std::memory_order_release);
+        quality_list[i].store(std::get<5>(nodes[i]), std::memory_order_release);
+    }
+    const source_ptr_t source = createFrameSource(parser.getSourceParams());
+    if(!source){
+        std::exit(EXIT_FAILURE);
+    }
+    FrameEncoder encoder(source, false, column, row, bezel_w, bezel_h, width, height, parser.getTileShapes(),
+                         ycbcr_format_list, quality_list, pack_bufs);
+    encoder.setTileCodec(parser.getTileCodec());
+    
+    // encode all the video frames into the tile container
+    TileContainerWriter writer(argv[OUTPUT_ARG_INDEX], display_num);
+    while(encoder.encodeFrame()){
+        for(int i=0; i<display_num; ++i){
+            writer.append(pack_bufs[i]->pop());
+        }
+        if(writer.getFrameNum()%PACKER_LOG_INTERVAL == 0){
+            _ml::notice("Packed " + std::to_string(writer.getFrameNum()) + " frames");
+        }
+    }
+    _ml::notice("Finished packing " + std::to_string(writer.getFrameNum()) + " frames");
+    
+    return EXIT_SUCCESS;
+}
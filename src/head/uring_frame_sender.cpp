@@ -0,0 +1,344 @@
+/******************************************
+*         uring_frame_sender.cpp          *
+*  (sender of JPEG frames with io_uring)  *
+******************************************/
+
+#include "uring_frame_sender.hpp"
+
+/* constructor */
+UringFrameSender::UringFrameSender(const int port, const int display_num, const conn_list_t& conns,
+                                   std::vector<tranbuf_ptr_t>& send_bufs, const int viewbuf_num,
+                                   const container_ptr_t container, const sockopt_params_t& sock_params,
+                                   ConnectionTable& table):
+    BaseFrameSender(display_num, conns, send_bufs, viewbuf_num, container, sock_params, table),
+    acc(ios, _ip::tcp::endpoint(_ip::tcp::v4(), port)),
+    socks(conns.size()),
+    pending_socks(conns.size()),
+    send_hdrs(conns.size()),
+    send_iovs(conns.size()),
+    send_iov_index(conns.size())
+{
+    // set up the io_uring instance
+    if(!this->setupRing(this->conn_num) || !this->registerFiles()){
+        _ml::caution("Failed to set up io_uring", "Set transport.backend to asio");
+        std::exit(EXIT_FAILURE);
+    }
+    _ml::notice("Streaming video frames with io_uring at :" + std::to_string(port));
+}
+
+/* destructor (release the io_uring instance) */
+UringFrameSender::~UringFrameSender(){
+    munmap(this->sqes, this->sq_entry_num*sizeof(struct io_uring_sqe));
+    if(this->cq_ptr != this->sq_ptr){
+        munmap(this->cq_ptr, this->cq_size);
+    }
+    munmap(this->sq_ptr, this->sq_size);
+    close(this->ring_fd);
+}
+
+/* set up the io_uring instance */
+const bool UringFrameSender::setupRing(const unsigned int entry_num){
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    this->ring_fd = syscall(__NR_io_uring_setup, entry_num, &params);
+    if(this->ring_fd == URING_FAILED){
+        _ml::warn("io_uring_setup failed", std::strerror(errno));
+        return false;
+    }
+    this->sq_entry_num = params.sq_entries;
+    
+    // map the submission and completion queue rings
+    this->sq_size = params.sq_off.array + params.sq_entries*sizeof(unsigned int);
+    this->cq_size = params.cq_off.cqes + params.cq_entries*sizeof(struct io_uring_cqe);
+    if(params.features & IORING_FEAT_SINGLE_MMAP){
+        this->sq_size = std::max(this->sq_size, this->cq_size);
+    }
+    this->sq_ptr = mmap(NULL, this->sq_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                        this->ring_fd, IORING_OFF_SQ_RING);
+    if(this->sq_ptr == MAP_FAILED){
+        _ml::warn("Could not map submission queue", std::strerror(errno));
+        return false;
+    }
+    if(params.features & IORING_FEAT_SINGLE_MMAP){
+        this->cq_ptr = this->sq_ptr;
+    }else{
+        this->cq_ptr = mmap(NULL, this->cq_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                            this->ring_fd, IORING_OFF_CQ_RING);
+        if(this->cq_ptr == MAP_FAILED){
+            _ml::warn("Could not map completion queue", std::strerror(errno));
+            return false;
+        }
+    }
+    this->sqes = (struct io_uring_sqe*)mmap(NULL, params.sq_entries*sizeof(struct io_uring_sqe),
+                                            PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                                            this->ring_fd, IORING_OFF_SQES);
+    if(this->sqes == MAP_FAILED){
+        _ml::warn("Could not map submission queue entries", std::strerror(errno));
+        return false;
+    }
+    
+    // get the pointers in the rings
+    unsigned char *sq_base = (unsigned char*)this->sq_ptr;
+    unsigned char *cq_base = (unsigned char*)this->cq_ptr;
+    this->sq_tail = (unsigned int*)(sq_base+params.sq_off.tail);
+    this->sq_mask = (unsigned int*)(sq_base+params.sq_off.ring_mask);
+    this->sq_array = (unsigned int*)(sq_base+params.sq_off.array);
+    this->cq_head = (unsigned int*)(cq_base+params.cq_off.head);
+    this->cq_tail = (unsigned int*)(cq_base+params.cq_off.tail);
+    this->cq_mask = (unsigned int*)(cq_base+params.cq_off.ring_mask);
+    this->cqes = (struct io_uring_cqe*)(cq_base+params.cq_off.cqes);
+    return true;
+}
+
+/* register an empty file table (the registered file index is the ID of the connection) */
+const bool UringFrameSender::registerFiles(){
+    std::vector<int> sock_fds(this->conn_num, URING_FILE_EMPTY);
+    if(syscall(__NR_io_uring_register, this->ring_fd, IORING_REGISTER_FILES,
+               sock_fds.data(), sock_fds.size()) == URING_FAILED){
+        _ml::warn("Could not register file table", std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/* update the registered file of a connection (no write is pending on it) */
+void UringFrameSender::updateFile(const int id, int fd){
+    struct io_uring_files_update update;
+    std::memset(&update, 0, sizeof(update));
+    update.offset = id;
+    update.fds = (unsigned long)&fd;
+    if(syscall(__NR_io_uring_register, this->ring_fd, IORING_REGISTER_FILES_UPDATE, &update, 1) == URING_FAILED){
+        _ml::caution("Failed to update sockets registered to io_uring", std::strerror(errno));
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+/* accept the display nodes and the relay nodes, and read their hello messages (waiting only if no connection is live) */
+void UringFrameSender::acceptStreams(){
+    bool wait = this->idle;
+    while(true){
+        // poll the acceptor and the sockets in the handshake together, so a slow node does not hold up the others
+        std::vector<struct pollfd> poll_fds(this->hello_socks.size()+1);
+        poll_fds[0].fd = this->acc.native_handle();
+        poll_fds[0].events = POLLIN;
+        for(size_t i=0; i<this->hello_socks.size(); ++i){
+            poll_fds[i+1].fd = this->hello_socks[i]->native_handle();
+            poll_fds[i+1].events = POLLIN;
+        }
+        if(::poll(poll_fds.data(), poll_fds.size(), wait ? POLL_FOREVER : 0) <= 0){
+            return;
+        }
+        
+        // read the hello messages arrived (the sockets are removed from the back, so the indices stay valid)
+        for(int i=int(this->hello_socks.size())-1; i>=0; --i){
+            if(poll_fds[i+1].revents != 0 && this->readHello(i)){
+                wait = false;
+            }
+        }
+        
+        if(poll_fds[0].revents & POLLIN){
+            const sock_ptr_t sock = std::make_shared<_ip::tcp::socket>(this->ios);
+            err_t err;
+            this->acc.non_blocking(true, err);
+            this->acc.accept(*sock, err);
+            if(err == _asio::error::would_block){
+                continue;
+            }else if(err){
+                _ml::warn("Failed stream connection", err.message());
+                continue;
+            }
+            sock->non_blocking(true, err);
+            this->hello_socks.push_back(sock);
+            this->hello_msgs.push_back("");
+        }
+    }
+}
+
+/* read the hello message of an accepted socket (true if the connection is registered, and the socket leaves the handshake) */
+const bool UringFrameSender::readHello(const int index){
+    const sock_ptr_t sock = this->hello_socks[index];
+    std::string& hello_msg = this->hello_msgs[index];
+    char read_buf[HELLO_SIZE_MAX];
+    err_t err;
+    const size_t read_size = sock->read_some(_asio::buffer(read_buf), err);
+    if(err == _asio::error::would_block){
+        return false;
+    }
+    hello_msg.append(read_buf, read_size);
+    const size_t delimiter_pos = hello_msg.find(MSG_DELIMITER);
+    if(!err && delimiter_pos == std::string::npos && hello_msg.length() < HELLO_SIZE_MAX){
+        return false;
+    }
+    this->hello_socks.erase(this->hello_socks.begin()+index);
+    const std::string recv_msg = hello_msg.substr(0, delimiter_pos);
+    this->hello_msgs.erase(this->hello_msgs.begin()+index);
+    
+    // check the ID of the connection
+    err_t ep_err;
+    const std::string ip_addr = sock->remote_endpoint(ep_err).address().to_string();
+    if(delimiter_pos == std::string::npos){
+        _ml::warn("Failed stream connection from " + ip_addr, err ? err.message() : "Hello message is too long");
+        return false;
+    }
+    const std::string node_key = parseHelloMsg(recv_msg, ip_addr);
+    const int id = findConnection(this->conns, node_key);
+    if(ep_err || id == CONN_NOT_FOUND){
+        _ml::warn("Unexpected stream connection from " + node_key + " (" + ip_addr + ")", "Check config file");
+        return false;
+    }
+    sock->non_blocking(false, err);
+    setSocketOptions(*sock, this->sock_params);
+    
+    // wait for the next frame boundary
+    std::lock_guard<std::mutex> lock(this->conn_lock);
+    if(!this->addStream(id)){
+        _ml::warn("Unexpected stream connection from " + node_key, "No control connection");
+        return false;
+    }
+    this->pending_socks[id] = sock;
+    return true;
+}
+
+/* queue a write of the send message (from the first unsent buffer) */
+void UringFrameSender::queueWrite(const int id){
+    const int iov_index = this->send_iov_index[id];
+    struct msghdr& send_hdr = this->send_hdrs[id];
+    std::memset(&send_hdr, 0, sizeof(send_hdr));
+    send_hdr.msg_iov = &this->send_iovs[id][iov_index];
+    send_hdr.msg_iovlen = this->send_iovs[id].size() - iov_index;
+    
+    const unsigned int tail = *this->sq_tail;
+    const unsigned int index = tail & *this->sq_mask;
+    struct io_uring_sqe *sqe = &this->sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->flags = IOSQE_FIXED_FILE;
+    sqe->fd = id;
+    sqe->addr = (unsigned long)&send_hdr;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = id;
+    this->sq_array[index] = index;
+    __atomic_store_n(this->sq_tail, tail+1, __ATOMIC_RELEASE);
+}
+
+/* submit the queued writes and wait for completion */
+const int UringFrameSender::enter(const unsigned int submit_num, const unsigned int wait_num){
+    int result;
+    do{
+        result = syscall(__NR_io_uring_enter, this->ring_fd, submit_num, wait_num, IORING_ENTER_GETEVENTS, NULL, 0);
+    }while(result == URING_FAILED && errno == EINTR);
+    return result;
+}
+
+/* reap the completed writes (return the number of the writes queued again) */
+const int UringFrameSender::reapCompletions(){
+    int requeue_num = 0;
+    unsigned int head = *this->cq_head;
+    while(head != __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE)){
+        const struct io_uring_cqe& cqe = this->cqes[head & *this->cq_mask];
+        const int id = cqe.user_data;
+        if(cqe.res < 0){
+            // drop the connection without stopping the others
+            this->dropStream(id, "Failed to send frame: " + std::string(std::strerror(-cqe.res)));
+            --this->pending_num;
+            ++head;
+            continue;
+        }
+        
+        // skip the sent buffers
+        size_t sent_size = cqe.res;
+        std::vector<struct iovec>& iovs = this->send_iovs[id];
+        const int iov_num = iovs.size();
+        int& iov_index = this->send_iov_index[id];
+        while(iov_index < iov_num && sent_size >= iovs[iov_index].iov_len){
+            sent_size -= iovs[iov_index].iov_len;
+            ++iov_index;
+        }
+        if(iov_index < iov_num){
+            // queue the rest of a partially sent message
+            iovs[iov_index].iov_base = (unsigned char*)iovs[iov_index].iov_base + sent_size;
+            iovs[iov_index].iov_len -= sent_size;
+            this->queueWrite(id);
+            ++requeue_num;
+        }else{
+            --this->pending_num;
+            if(this->tcp_cork){
+                setCork(*this->socks[id], false);
+            }
+            this->recordSent(id);
+        }
+        ++head;
+    }
+    __atomic_store_n(this->cq_head, head, __ATOMIC_RELEASE);
+    return requeue_num;
+}
+
+/* send a JPEG frame to all the live connections (in one io_uring_enter) */
+void UringFrameSender::sendFrame(){
+    if(!this->prepareFrame()){
+        return;
+    }
+    for(const int id : this->frame_conns){
+        const std::vector<_asio::const_buffer>& send_seq = this->send_seqs[id];
+        std::vector<struct iovec>& iovs = this->send_iovs[id];
+        iovs.resize(send_seq.size());
+        for(int j=0; j<int(send_seq.size()); ++j){
+            iovs[j].iov_base = (void*)_asio::buffer_cast<const void*>(send_seq[j]);
+            iovs[j].iov_len = _asio::buffer_size(send_seq[j]);
+        }
+        this->send_iov_index[id] = 0;
+        if(this->tcp_cork){
+            setCork(*this->socks[id], true);
+        }
+        this->queueWrite(id);
+    }
+    
+    // wait until all the send messages are written or failed
+    this->pending_num = this->frame_conns.size();
+    unsigned int submit_num = this->frame_conns.size();
+    while(this->pending_num > 0){
+        if(this->enter(submit_num, this->pending_num) == URING_FAILED){
+            _ml::caution("io_uring_enter failed", std::strerror(errno));
+            std::exit(EXIT_FAILURE);
+        }
+        submit_num = this->reapCompletions();
+    }
+    this->sent_frames->add(1);
+}
+
+/* start sending JPEG frames (the nodes are accepted between the frames) */
+void UringFrameSender::run(){
+    while(true){
+        this->acceptStreams();
+        this->sendFrame();
+    }
+}
+
+/* make the pending socket of a connection live */
+void UringFrameSender::admitSocket(const int id){
+    this->socks[id] = this->pending_socks[id];
+    this->pending_socks[id].reset();
+    this->updateFile(id, this->socks[id]->native_handle());
+}
+
+/* close the socket of a connection (no write is pending on it) */
+void UringFrameSender::releaseSocket(const int id, const bool pending){
+    sock_ptr_t& sock = pending ? this->pending_socks[id] : this->socks[id];
+    if(sock){
+        if(!pending){
+            this->updateFile(id, URING_FILE_EMPTY);
+        }
+        err_t err;
+        sock->close(err);
+        sock.reset();
+    }
+}
+
+/* shut down the socket of a connection (the pending write fails with an error) */
+void UringFrameSender::shutdownSocket(const int id, const bool pending){
+    const sock_ptr_t& sock = pending ? this->pending_socks[id] : this->socks[id];
+    if(sock){
+        ::shutdown(sock->native_handle(), SHUT_RDWR);
+    }
+}
@@ -0,0 +1,145 @@
+/**************************************************
+*             window_compositor.cpp              *
+*  (compositor of the windows of several sources) *
+**************************************************/
+
+#include "window_compositor.hpp"
+
+/* constructor */
+Window::Window(const source_ptr_t source, const bool media_clock, const cv::Rect& rect):
+    source(source),
+    clock(media_clock),
+    rect(rect)
+{}
+
+/* constructor (open the sources of all the windows) */
+WindowCompositor::WindowCompositor(const window_list_t& window_list){
+    for(const window_params_t& params : window_list){
+        const source_ptr_t source = createFrameSource(std::get<0>(params));
+        if(!source){
+            this->windows.clear();
+            return;
+        }
+        const window_ptr_t window = std::make_shared<Window>(source, std::get<1>(params), std::get<2>(params));
+        this->setResizeParams(*window, source->getFrameSize());
+        this->windows.push_back(window);
+    }
+}
+
+/* destructor (stop the threads after their current frames) */
+WindowCompositor::~WindowCompositor(){
+    {
+        std::lock_guard<std::mutex> lock(this->lock);
+        this->stopped = true;
+    }
+    for(std::thread& window_thre : this->window_thres){
+        window_thre.join();
+    }
+}
+
+/* check if all the sources have been opened */
+const bool WindowCompositor::isOpened(){
+    return !this->windows.empty();
+}
+
+/* launch the threads of the windows */
+void WindowCompositor::run(){
+    for(const window_ptr_t& window : this->windows){
+        this->window_thres.push_back(std::thread(std::bind(&WindowCompositor::runWindow, this, window)));
+    }
+}
+
+/* set the parameters to resize the frames of a window (the frames are fitted into the region) */
+void WindowCompositor::setResizeParams(Window& window, const cv::Size& frame_size){
+    const double x_ratio = (double)window.rect.width / (double)frame_size.width;
+    const double y_ratio = (double)window.rect.height / (double)frame_size.height;
+    const double ratio = x_ratio<y_ratio ? x_ratio : y_ratio;
+    const int resize_w = (int)((double)frame_size.width * ratio);
+    const int resize_h = (int)((double)frame_size.height * ratio);
+    window.frame_size = frame_size;
+    window.roi = cv::Rect((window.rect.width-resize_w)/2, (window.rect.height-resize_h)/2, resize_w, resize_h);
+    window.interpolation_type = ratio>=1 ? cv::INTER_LINEAR : cv::INTER_AREA;
+    window.staged = cv::Mat::zeros(window.rect.size(), CV_8UC3);
+    
+    // the letterbox of the last frame is not reused
+    std::lock_guard<std::mutex> lock(this->lock);
+    window.ready = cv::Mat::zeros(window.rect.size(), CV_8UC3);
+}
+
+/* read and resize the frames of a window (in the thread of the window) */
+void WindowCompositor::runWindow(const window_ptr_t window){
+    _ft::setThreadName("window");
+    cv::Mat frame;
+    int64_t pts;
+    while(window->source->read(frame, pts)){
+        if(!window->clock.schedule(pts)){
+            continue;
+        }
+        const int64_t resize_t = _ft::now();
+        if(frame.size() != window->frame_size){
+            this->setResizeParams(*window, frame.size());
+        }
+        cv::Mat paste_area = window->staged(window->roi);
+        cv::resize(frame, paste_area, window->roi.size(), 0, 0, window->interpolation_type);
+        window->clock.addCost(_ft::now()-resize_t);
+        
+        // publish the frame (the last frame is resized into next time)
+        {
+            std::lock_guard<std::mutex> lock(this->lock);
+            if(this->stopped){
+                return;
+            }
+            std::swap(window->staged, window->ready);
+            window->updated = true;
+        }
+        this->updated_cond.notify_one();
+    }
+    
+    // the last frame is kept on the wall
+    {
+        std::lock_guard<std::mutex> lock(this->lock);
+        window->finished = true;
+        ++this->finished_num;
+    }
+    this->updated_cond.notify_one();
+}
+
+/* check if any window has a new frame (call with the lock) */
+const bool WindowCompositor::hasUpdate(){
+    for(const window_ptr_t& window : this->windows){
+        if(window->updated){
+            return true;
+        }
+    }
+    return false;
+}
+
+/* wait for new frames and paint them onto the wall (false when all the sources are finished) */
+const bool WindowCompositor::composite(cv::Mat& canvas, const bool repaint, std::vector<cv::Rect>& dirty_rects){
+    std::unique_lock<std::mutex> lock(this->lock);
+    while(!repaint && !this->hasUpdate()){
+        if(this->finished_num == (int)this->windows.size()){
+            return false;
+        }
+        this->updated_cond.wait(lock);
+    }
+    
+    // paint the updated windows, and the windows above them which they would overwrite
+    const cv::Rect wall(0, 0, canvas.cols, canvas.rows);
+    dirty_rects.clear();
+    for(const window_ptr_t& window : this->windows){
+        const cv::Rect area = window->rect & wall;
+        bool paint = repaint || window->updated;
+        for(const cv::Rect& dirty_rect : dirty_rects){
+            paint = paint || (dirty_rect & area).area() > 0;
+        }
+        window->updated = false;
+        if(!paint || area.area() == 0){
+            continue;
+        }
+        const cv::Rect src_area(area.x-window->rect.x, area.y-window->rect.y, area.width, area.height);
+        window->ready(src_area).copyTo(canvas(area));
+        dirty_rects.push_back(area);
+    }
+    return true;
+}
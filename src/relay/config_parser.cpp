@@ -0,0 +1,40 @@
+/********************************
+*      config_parser.cpp        *
+*  (parser of relay_conf.json)  *
+********************************/
+
+#include "config_parser.hpp"
+
+/* constructor (load relay_conf.json) */
+ConfigParser::ConfigParser(const std::string& conf_file):
+    BaseConfigParser(conf_file)
+{
+    if(!this->readParams(this->conf)){
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+/* read the parameters in JSON */
+const bool ConfigParser::readParams(const _pt::ptree& conf){
+    try{
+        this->ip = this->getStrParam("head_node.ip");
+        this->port = this->getIntParam("head_node.port");
+        this->fs_port = this->getIntParam("port.frontend_server");
+        this->stream_port = this->getIntParam("port.frame_streamer");
+        this->id = this->getStrParam("node.id", "");
+    }catch(...){
+        _ml::caution("Could not get parameter", "Config file is invalid");
+        return false;
+    }
+    return true;
+}
+
+/* pass the parameters to the relay server */
+const rs_params_t ConfigParser::getRelayServerParams(){
+    const std::string ip = this->ip;
+    const int port = this->port;
+    const int fs_port = this->fs_port;
+    const int stream_port = this->stream_port;
+    const std::string id = this->id;
+    return std::forward_as_tuple(ip, port, fs_port, stream_port, id);
+}
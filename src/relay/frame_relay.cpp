@@ -0,0 +1,205 @@
+/********************************************
+*             frame_relay.cpp               *
+*  (relay of JPEG frames to display nodes)  *
+********************************************/
+
+#include "frame_relay.hpp"
+
+/* constructor */
+FrameRelay::FrameRelay(_asio::io_service& ios, const std::string& head_ip, const int head_port, const int port,
+                       const conn_list_t& conns, const sockopt_params_t& sock_params, const std::string& node_id):
+    ios(ios),
+    head_sock(ios),
+    acc(ios, _ip::tcp::endpoint(_ip::tcp::v4(), port)),
+    socks(conns.size()),
+    conns(conns),
+    display_num(conns.size()),
+    head_ip(head_ip),
+    head_port(head_port),
+    sock_params(sock_params),
+    tcp_cork(std::get<1>(sock_params)),
+    hello_msg(makeHelloMsg(node_id)),
+    send_seqs(conns.size())
+{
+    this->sock = std::make_shared<_ip::tcp::socket>(ios);
+    _ml::notice("Relaying video frames at :" + std::to_string(port));
+}
+
+/* start relaying JPEG frames (accept the display nodes first) */
+void FrameRelay::run(){
+    this->acc.async_accept(*this->sock,
+                           boost::bind(&FrameRelay::onConnect, this, _ph::error)
+    );
+    this->ios.run();
+}
+
+/* the callback when connected by the display node (the display nodes are accepted concurrently) */
+void FrameRelay::onConnect(const err_t& err){
+    if(err == _asio::error::operation_aborted){
+        return;
+    }else if(err){
+        _ml::caution("Failed stream connection", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    const sock_ptr_t sock = this->sock;
+    this->sock = std::make_shared<_ip::tcp::socket>(this->ios);
+    this->acc.async_accept(*this->sock,
+                           boost::bind(&FrameRelay::onConnect, this, _ph::error)
+    );
+    
+    // receive the hello message to identify the display node
+    const streambuf_ptr_t hello_buf = std::make_shared<_asio::streambuf>(HELLO_SIZE_MAX);
+    _asio::async_read_until(*sock,
+                            *hello_buf,
+                            MSG_DELIMITER,
+                            boost::bind(&FrameRelay::onRecvHello, this, _ph::error, _ph::bytes_transferred,
+                                        sock, hello_buf)
+    );
+}
+
+/* the callback when receiving the hello message from the display node */
+void FrameRelay::onRecvHello(const err_t& err, size_t t_bytes, const sock_ptr_t sock,
+                             const streambuf_ptr_t hello_buf)
+{
+    const std::string ip_addr = sock->remote_endpoint().address().to_string();
+    if(err){
+        _ml::caution("Failed stream connection with " + ip_addr, err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    
+    // check the ID of the display node
+    const auto data = hello_buf->data();
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
+    const std::string node_key = parseHelloMsg(recv_msg, ip_addr);
+    const int id = findConnection(this->conns, node_key);
+    if(id == CONN_NOT_FOUND || this->socks[id]){
+        _ml::caution("Unexpected stream connection from " + node_key, "Check config file");
+        std::exit(EXIT_FAILURE);
+    }
+    setSocketOptions(*sock, this->sock_params);
+    this->socks[id] = sock;
+    
+    // connect to the head node when all the display nodes are connected (the options are set first to apply SO_RCVBUF)
+    ++this->connected_num;
+    if(this->connected_num == this->display_num){
+        this->acc.close();
+        this->head_sock.open(_ip::tcp::v4());
+        setSocketOptions(this->head_sock, this->sock_params);
+        this->head_sock.async_connect(_ip::tcp::endpoint(_ip::address::from_string(this->head_ip), this->head_port),
+                                      boost::bind(&FrameRelay::onConnectHead, this, _ph::error)
+        );
+    }
+}
+
+/* the callback when connecting to the head node */
+void FrameRelay::onConnectHead(const err_t& err){
+    if(err){
+        _ml::caution("Failed stream connection with head node", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    
+    // identify this node, and start receiving the bundles
+    _asio::async_write(this->head_sock,
+                       _asio::buffer(this->hello_msg),
+                       boost::bind(&FrameRelay::onSendHello, this, _ph::error, _ph::bytes_transferred)
+    );
+    this->recvFrame();
+}
+
+/* the callback when sending the hello message */
+void FrameRelay::onSendHello(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Failed to send hello message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+/* start receiving the next bundle */
+void FrameRelay::recvFrame(){
+    _asio::async_read_until(this->head_sock,
+                            this->stream_buf,
+                            MSG_DELIMITER,
+                            boost::bind(&FrameRelay::onRecvFrame, this, _ph::error, _ph::bytes_transferred)
+    );
+}
+
+/* the callback when receiving a bundle (the next bundle is received while relaying the current one) */
+void FrameRelay::onRecvFrame(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Could not receive frame", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    const auto data = this->stream_buf.data();
+    this->recv_msg.assign(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    this->recv_msg.erase(this->recv_msg.length()-MSG_DELIMITER_LEN);
+    this->stream_buf.consume(t_bytes);
+    
+    if(this->sending){
+        this->recv_ready = true;
+    }else{
+        this->relayFrame();
+    }
+}
+
+/* relay the JPEG frames in a bundle (the frames refer to the bundle without copying) */
+void FrameRelay::relayFrame(){
+    std::swap(this->send_msg, this->recv_msg);
+    
+    // split the bundle (the frame index, and the size field and the JPEG frame for each display node)
+    const size_t msg_len = this->send_msg.length();
+    this->send_head = this->send_msg.substr(FRAME_ID_INDEX, FRAME_ID_LEN);
+    size_t offset = FRAME_ID_INDEX + FRAME_ID_LEN;
+    for(int i=0; i<this->display_num; ++i){
+        size_t tile_size = msg_len;
+        if(offset+TILE_SIZE_LEN <= msg_len){
+            tile_size = std::stoul(this->send_msg.substr(offset, TILE_SIZE_LEN));
+            offset += TILE_SIZE_LEN;
+        }
+        if(offset+tile_size > msg_len){
+            _ml::caution("Received broken frame", "Check layout of relay node");
+            std::exit(EXIT_FAILURE);
+        }
+        this->send_seqs[i] = {
+            _asio::buffer(this->send_head),
+            _asio::buffer(this->send_msg.data()+offset, tile_size),
+            _asio::buffer(MSG_DELIMITER)
+        };
+        offset += tile_size;
+    }
+    
+    // send the JPEG frames to the display nodes
+    this->sending = true;
+    for(int i=0; i<this->display_num; ++i){
+        if(this->tcp_cork){
+            setCork(*this->socks[i], true);
+        }
+        _asio::async_write(*this->socks[i],
+                           this->send_seqs[i],
+                           boost::bind(&FrameRelay::onSendFrame, this, _ph::error, _ph::bytes_transferred, i)
+        );
+    }
+    this->recvFrame();
+}
+
+/* the callback when sending a JPEG frame */
+void FrameRelay::onSendFrame(const err_t& err, size_t t_bytes, const int id){
+    if(err){
+        _ml::caution("Failed to send frame", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    if(this->tcp_cork){
+        setCork(*this->socks[id], false);
+    }
+    
+    // If all the frames are sent, relay the next bundle if received
+    ++this->send_count;
+    if(this->send_count == this->display_num){
+        this->send_count = 0;
+        this->sending = false;
+        if(this->recv_ready){
+            this->recv_ready = false;
+            this->relayFrame();
+        }
+    }
+}
@@ -0,0 +1,29 @@
+/********************************
+*      config_parser.hpp        *
+*  (parser of relay_conf.json)  *
+********************************/
+
+#ifndef CONFIG_PARSER_HPP
+#define CONFIG_PARSER_HPP
+
+#include "base_config_parser.hpp"
+
+using rs_params_t = std::tuple<std::string, int, int, int, std::string>;
+
+/* parser of relay_conf.json */
+class ConfigParser : public BaseConfigParser{
+    private:
+        std::string ip;   // the IP address of the head node
+        int port;         // the port number of the head node
+        int fs_port;      // the port number for the display nodes
+        int stream_port;  // the port number for relaying JPEG frames
+        std::string id;   // the node ID sent to the head node (empty to be found by the IP address)
+        
+        const bool readParams(const _pt::ptree& conf) override;  // read the parameters
+    
+    public:
+        ConfigParser(const std::string& conf_file);  // constructor
+        const rs_params_t getRelayServerParams();    // pass the parameters to the relay server
+};
+
+#endif  /* CONFIG_PARSER_HPP */
@@ -0,0 +1,55 @@
+/********************************************
+*             frame_relay.hpp               *
+*  (relay of JPEG frames to display nodes)  *
+********************************************/
+
+#ifndef FRAME_RELAY_HPP
+#define FRAME_RELAY_HPP
+
+#include "async_logger.hpp"
+#include "socket_utils.hpp"
+#include <vector>
+
+/* relay of JPEG frames (the frames bundled by the head node are split for the display nodes) */
+class FrameRelay{
+    private:
+        _asio::io_service& ios;                                   // the I/O event loop
+        _ip::tcp::socket head_sock;                               // the TCP socket to the head node
+        sock_ptr_t sock;                                          // the TCP socket
+        _ip::tcp::acceptor acc;                                   // the TCP acceptor
+        std::vector<sock_ptr_t> socks;                            // the in-use TCP sockets for the display nodes
+        const conn_list_t conns;                                  // the connections to the display nodes
+        const int display_num;                                    // the number of the display nodes
+        const std::string head_ip;                                // the IP address of the head node
+        const int head_port;                                      // the port number of the head node
+        const sockopt_params_t sock_params;                       // the options of the TCP sockets
+        const bool tcp_cork;                                      // the flag to cork the TCP sockets while sending a frame
+        const std::string hello_msg;                              // the hello message to the head node
+        _asio::streambuf stream_buf;                              // the streambuffer
+        std::string recv_msg;                                     // the bundled JPEG frames received next
+        std::string send_msg;                                     // the bundled JPEG frames being relayed
+        std::string send_head;                                    // the header of the send messages
+        std::vector<std::vector<_asio::const_buffer>> send_seqs;  // the buffer sequences of the send messages
+        int connected_num = 0;                                    // the number of the connected display nodes
+        int send_count = 0;                                       // the number of the relayed frames
+        bool sending = false;                                     // the flag whether the frames are being relayed
+        bool recv_ready = false;                                  // the flag whether the next bundle is received
+        
+        void onConnect(const err_t& err);                                  // the callback when connected by the display node
+        void onRecvHello(const err_t& err, size_t t_bytes,                 // the callback when receiving the hello message
+                         const sock_ptr_t sock, const streambuf_ptr_t hello_buf);
+        void onConnectHead(const err_t& err);                              // the callback when connecting to the head node
+        void onSendHello(const err_t& err, size_t t_bytes);                // the callback when sending the hello message
+        void recvFrame();                                                  // start receiving the next bundle
+        void onRecvFrame(const err_t& err, size_t t_bytes);                // the callback when receiving a bundle
+        void relayFrame();                                                 // relay the JPEG frames in a bundle
+        void onSendFrame(const err_t& err, size_t t_bytes, const int id);  // the callback when sending a frame
+    
+    public:
+        FrameRelay(_asio::io_service& ios, const std::string& head_ip,  // constructor
+                   const int head_port, const int port, const conn_list_t& conns,
+                   const sockopt_params_t& sock_params, const std::string& node_id);
+        void run();                                                      // start relaying JPEG frames
+};
+
+#endif  /* FRAME_RELAY_HPP */
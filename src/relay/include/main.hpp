@@ -0,0 +1,14 @@
+/***************************************
+*               main.hpp               *
+*  (main function for the relay node)  *
+***************************************/
+
+#ifndef MAIN_HPP
+#define MAIN_HPP
+
+#include "relay_server.hpp"
+
+const int ARGUMENT_NUM = 2;    // the number of the command line arguments
+const int ARGUMENT_INDEX = 1;  // the index of the command line arguments
+
+#endif  /* MAIN_HPP */
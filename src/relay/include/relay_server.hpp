@@ -0,0 +1,64 @@
+/*********************************
+*       relay_server.hpp         *
+*  (class for the relay server)  *
+*********************************/
+
+#ifndef RELAY_SERVER_HPP
+#define RELAY_SERVER_HPP
+
+#include "config_parser.hpp"
+#include "frame_relay.hpp"
+#include "json_handler.hpp"
+#include "overlay_message.hpp"
+#include "sync_utils.hpp"
+#include <sstream>
+#include <thread>
+
+const char LIST_DELIMITER = ',';  // the delimiter of the lists in the initial message
+
+/* class for the relay server (a sub-wall of display nodes is served via one connection to the head node) */
+class RelayServer{
+    private:
+        _asio::io_service& ios;                    // the I/O event loop
+        _ip::tcp::socket head_sock;                // the TCP socket to the head node
+        _asio::streambuf head_buf;                 // the streambuffer for the head node
+        sock_ptr_t sock;                           // the TCP socket
+        _ip::tcp::acceptor acc;                    // the TCP acceptor
+        std::vector<sock_ptr_t> socks;             // the in-use TCP sockets for the display nodes
+        std::vector<streambuf_ptr_t> stream_bufs;  // the stream buffers for the display nodes
+        conn_list_t conns;                         // the connections to the display nodes
+        int display_num = 0;                       // the number of the display nodes
+        std::string head_ip;                       // the IP address of the head node
+        int stream_port;                           // the port number for relaying JPEG frames
+        sockopt_params_t sock_params;              // the options of the TCP sockets
+        std::string node_id;                       // the node ID sent to the head node
+        std::string hello_msg;                     // the hello message to the head node
+        std::vector<std::string> init_msgs;        // the initial messages for the display nodes
+        JsonHandler sync_params;                   // the sync messages aggregated for the head node
+        std::string sync_msg;                      // the aggregated sync message
+        std::vector<std::string> sync_msgs;        // the sync messages with the overlay commands for the display nodes
+        int connected_num = 0;                     // the number of the connected display nodes
+        int sync_count = 0;                        // the count of the synchronized display nodes
+        _asio::io_service relay_ios;               // the I/O event loop for relaying JPEG frames
+        std::unique_ptr<FrameRelay> relay;         // the frame relay
+        std::thread relay_thre;                    // the frame relay thread
+        
+        void onConnectHead(const err_t& err);                             // the callback when connecting to the head node
+        void onSendHello(const err_t& err, size_t t_bytes);               // the callback when sending the hello message
+        void onRecvInitMsg(const err_t& err, size_t t_bytes);             // the callback when receiving the initial message
+        void waitForConnection();                                         // start waiting for TCP connection
+        void onConnect(const err_t& err);                                 // the callback when connected by the display node
+        void onRecvHello(const err_t& err, size_t t_bytes,                // the callback when receiving the hello message
+                         const sock_ptr_t sock, const streambuf_ptr_t hello_buf);
+        void onSendInit(const err_t& err, size_t t_bytes);                // the callback when sending the initial message
+        void recvSync(const int id);                                      // start receiving a sync message
+        void onRecvSync(const err_t& err, size_t t_bytes, const int id);  // the callback when receiving a sync message from a display node
+        void onSendSyncUp(const err_t& err, size_t t_bytes);              // the callback when sending the aggregated sync message
+        void onRecvSyncDown(const err_t& err, size_t t_bytes);            // the callback when receiving a sync message from the head node
+        void onSendSync(const err_t& err, size_t t_bytes, const int id);  // the callback when sending a sync message
+    
+    public:
+        RelayServer(_asio::io_service& ios, ConfigParser& parser);  // constructor
+};
+
+#endif  /* RELAY_SERVER_HPP */
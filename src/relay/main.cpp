@@ -0,0 +1,24 @@
+/***************************************
+*               main.cpp               *
+*  (main function for the relay node)  *
+***************************************/
+
+#include "main.hpp"
+
+/* main function */
+int main(int argc, char *argv[]){
+    // parse relay_conf.json
+    if(argc != ARGUMENT_NUM){
+        _ml::caution("Number of arguments is invalid", "Usage: relay_node <config file>");
+        std::exit(EXIT_FAILURE);
+    }
+    ConfigParser parser(argv[ARGUMENT_INDEX]);
+    _ml::init(parser.getLogParams());
+    
+    // launch the relay server
+    _asio::io_service ios;
+    RelayServer server(ios, parser);
+    ios.run();
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,300 @@
+/*********************************
+*       relay_server.cpp         *
+*  (class for the relay server)  *
+*********************************/
+
+#include "relay_server.hpp"
+
+/* constructor */
+RelayServer::RelayServer(_asio::io_service& ios, ConfigParser& parser):
+    ios(ios),
+    head_sock(ios),
+    acc(ios)
+{
+    // set the parameters
+    int head_port, fs_port;
+    std::tie(this->head_ip, head_port, fs_port, this->stream_port, this->node_id) = parser.getRelayServerParams();
+    this->sock_params = parser.getSocketParams();
+    this->sock = std::make_shared<_ip::tcp::socket>(ios);
+    this->acc.open(_ip::tcp::v4());
+    this->acc.set_option(_ip::tcp::acceptor::reuse_address(true));
+    this->acc.bind(_ip::tcp::endpoint(_ip::tcp::v4(), fs_port));
+    this->acc.listen();
+    _ml::notice("Waiting for display node connection at :" + std::to_string(fs_port));
+    
+    // connect to the head node
+    this->head_sock.async_connect(_ip::tcp::endpoint(_ip::address::from_string(this->head_ip), head_port),
+                                  boost::bind(&RelayServer::onConnectHead, this, _ph::error)
+    );
+}
+
+/* the callback when connecting to the head node */
+void RelayServer::onConnectHead(const err_t& err){
+    if(err){
+        _ml::caution("Could not connect to head node", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    _ml::notice("Connected to head node");
+    setSocketOptions(this->head_sock, this->sock_params);
+    
+    // identify this node, and receive the initial message
+    this->hello_msg = makeHelloMsg(this->node_id);
+    _asio::async_write(this->head_sock,
+                       _asio::buffer(this->hello_msg),
+                       boost::bind(&RelayServer::onSendHello, this, _ph::error, _ph::bytes_transferred)
+    );
+    _asio::async_read_until(this->head_sock,
+                            this->head_buf,
+                            MSG_DELIMITER,
+                            boost::bind(&RelayServer::onRecvInitMsg, this, _ph::error, _ph::bytes_transferred)
+    );
+}
+
+/* the callback when sending the hello message */
+void RelayServer::onSendHello(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Failed to send hello message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+/* the callback when receiving the initial message */
+void RelayServer::onRecvInitMsg(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Could not receive init message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    _ml::notice("Received init message from head node");
+    
+    // parse the initial message
+    const auto data = this->head_buf.data();
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
+    this->head_buf.consume(t_bytes);
+    JsonHandler init_params;
+    try{
+        init_params.deserialize(recv_msg);
+        std::stringstream id_stream(init_params.getStringParam("display_ids"));
+        std::stringstream ip_stream(init_params.getStringParam("display_ips"));
+        std::string id, ip_addr;
+        while(std::getline(id_stream, id, LIST_DELIMITER) && std::getline(ip_stream, ip_addr, LIST_DELIMITER)){
+            this->conns.push_back(std::forward_as_tuple(ip_addr, std::vector<int>(1, std::stoi(id)), false));
+        }
+    }catch(...){
+        _ml::caution("Init message is invalid", "Register this node as relay node in head config");
+        std::exit(EXIT_FAILURE);
+    }
+    this->display_num = this->conns.size();
+    this->socks = std::vector<sock_ptr_t>(this->display_num);
+    for(int i=0; i<this->display_num; ++i){
+        this->stream_bufs.push_back(std::make_shared<_asio::streambuf>());
+    }
+    
+    // launch the relay thread (bound before the display nodes know the port from the initial message)
+    const int head_stream_port = init_params.getIntParam("stream_port");
+    init_params.setIntParam("stream_port", this->stream_port);
+    try{
+        // each display node gets its own settings, which the head node prefixed with its ID
+        for(int i=0; i<this->display_num; ++i){
+            JsonHandler display_params = init_params;
+            const std::string key_prefix = std::to_string(std::get<1>(this->conns[i])[0]) + ".";
+            for(const std::string& key : NODE_PARAM_KEYS){
+                display_params.setIntParam(key, init_params.getIntParam(key_prefix+key));
+            }
+            this->init_msgs.push_back(display_params.serialize() + MSG_DELIMITER);
+        }
+    }catch(...){
+        _ml::caution("Init message is invalid", "Use the same version on head node and relay node");
+        std::exit(EXIT_FAILURE);
+    }
+    this->relay.reset(new FrameRelay(this->relay_ios,
+                                     this->head_ip,
+                                     head_stream_port,
+                                     this->stream_port,
+                                     this->conns,
+                                     this->sock_params,
+                                     this->node_id
+    ));
+    this->relay_thre = std::thread(std::bind(&FrameRelay::run, this->relay.get()));
+    
+    // start waiting for the display node connection
+    _ml::notice("Waiting for " + std::to_string(this->display_num) + " display nodes");
+    this->waitForConnection();
+}
+
+/* start waiting for the display node connection */
+void RelayServer::waitForConnection(){
+    this->acc.async_accept(*this->sock,
+                           boost::bind(&RelayServer::onConnect, this, _ph::error)
+    );
+}
+
+/* the callback when connected by the display node (the display nodes are accepted and initialized concurrently) */
+void RelayServer::onConnect(const err_t& err){
+    if(err == _asio::error::operation_aborted){
+        return;
+    }else if(err){
+        _ml::caution("Could not accept display node", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    const sock_ptr_t sock = this->sock;
+    this->sock = std::make_shared<_ip::tcp::socket>(this->ios);
+    this->waitForConnection();
+    
+    // receive the hello message to identify the display node
+    const streambuf_ptr_t hello_buf = std::make_shared<_asio::streambuf>(HELLO_SIZE_MAX);
+    _asio::async_read_until(*sock,
+                            *hello_buf,
+                            MSG_DELIMITER,
+                            boost::bind(&RelayServer::onRecvHello, this, _ph::error, _ph::bytes_transferred,
+                                        sock, hello_buf)
+    );
+}
+
+/* the callback when receiving the hello message from the display node */
+void RelayServer::onRecvHello(const err_t& err, size_t t_bytes, const sock_ptr_t sock,
+                              const streambuf_ptr_t hello_buf)
+{
+    const std::string ip_addr = sock->remote_endpoint().address().to_string();
+    if(err){
+        _ml::caution("Could not receive hello message from " + ip_addr, err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    
+    // check the ID of the display node
+    const auto data = hello_buf->data();
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
+    const std::string node_key = parseHelloMsg(recv_msg, ip_addr);
+    const int id = findConnection(this->conns, node_key);
+    if(id == CONN_NOT_FOUND || this->socks[id]){
+        _ml::caution(node_key + " is not registered", "Check config file of head node");
+        std::exit(EXIT_FAILURE);
+    }
+    _ml::notice("Accepted new display node: " + node_key);
+    setSocketOptions(*sock, this->sock_params);
+    
+    // send the initial message to the display node
+    this->socks[id] = sock;
+    _asio::async_write(*sock,
+                       _asio::buffer(this->init_msgs[id]),
+                       boost::bind(&RelayServer::onSendInit, this, _ph::error, _ph::bytes_transferred)
+    );
+}
+
+/* the callback when sending the initial message */
+void RelayServer::onSendInit(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Failed to send init message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    
+    // start relaying the sync messages when all the display nodes are initialized
+    ++this->connected_num;
+    if(this->connected_num == this->display_num){
+        _ml::notice("All display nodes connected");
+        this->acc.close();
+        for(int i=0; i<this->display_num; ++i){
+            this->recvSync(i);
+        }
+    }
+}
+
+/* start receiving a sync message from the display node */
+void RelayServer::recvSync(const int id){
+    _asio::async_read_until(*this->socks[id],
+                            *this->stream_bufs[id],
+                            MSG_DELIMITER,
+                            boost::bind(&RelayServer::onRecvSync, this, _ph::error, _ph::bytes_transferred, id)
+    );
+}
+
+/* the callback when receiving a sync message from the display node */
+void RelayServer::onRecvSync(const err_t& err, size_t t_bytes, const int id){
+    if(err){
+        _ml::caution("Failed to receive sync message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    
+    // aggregate the sync message keyed by the display ID
+    const auto data = this->stream_bufs[id]->data();
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
+    this->stream_bufs[id]->consume(t_bytes);
+    JsonHandler display_params;
+    display_params.deserialize(recv_msg);
+    const std::string key_prefix = std::to_string(std::get<1>(this->conns[id])[0]) + ".";
+    this->sync_params.setIntParam(key_prefix+"param", display_params.getIntParam("param"));
+    this->sync_params.setIntParam(key_prefix+"change", display_params.getIntParam("change"));
+    this->sync_params.setIntParam(key_prefix+"wait_us", display_params.getIntParam("wait_us"));
+    this->sync_params.setIntParam(key_prefix+"recv_depth", display_params.getIntParam("recv_depth"));
+    
+    // send the aggregated sync message when all the display nodes are synchronized
+    ++this->sync_count;
+    if(this->sync_count == this->display_num){
+        this->sync_count = 0;
+        this->sync_msg = this->sync_params.serialize() + MSG_DELIMITER;
+        this->sync_params = JsonHandler();
+        _asio::async_write(this->head_sock,
+                           _asio::buffer(this->sync_msg),
+                           boost::bind(&RelayServer::onSendSyncUp, this, _ph::error, _ph::bytes_transferred)
+        );
+    }
+}
+
+/* the callback when sending the aggregated sync message to the head node */
+void RelayServer::onSendSyncUp(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Failed to send sync message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    _asio::async_read_until(this->head_sock,
+                            this->head_buf,
+                            MSG_DELIMITER,
+                            boost::bind(&RelayServer::onRecvSyncDown, this, _ph::error, _ph::bytes_transferred)
+    );
+}
+
+/* the callback when receiving a sync message from the head node */
+void RelayServer::onRecvSyncDown(const err_t& err, size_t t_bytes){
+    if(err){
+        _ml::caution("Failed to receive sync message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    const auto data = this->head_buf.data();
+    std::string recv_msg(_asio::buffers_begin(data), _asio::buffers_begin(data)+t_bytes);
+    recv_msg.erase(recv_msg.length()-MSG_DELIMITER_LEN);
+    this->head_buf.consume(t_bytes);
+    
+    // pass each overlay command to its display node (the resources without the display ID are sent to all of them)
+    const std::vector<std::string> cmds = splitOverlayCmds(recv_msg);
+    this->sync_msgs.assign(this->display_num, cmds[0]);
+    for(size_t i=1; i<cmds.size(); ++i){
+        JsonHandler cmd;
+        cmd.deserialize(cmds[i]);
+        const bool broadcast = !cmd.hasParam("display");
+        for(int j=0; j<this->display_num; ++j){
+            if(broadcast || cmd.getIntParam("display") == std::get<1>(this->conns[j])[0]){
+                this->sync_msgs[j] += OVERLAY_DELIMITER + cmds[i];
+            }
+        }
+    }
+    
+    // broadcast the sync message to the display nodes
+    for(int i=0; i<this->display_num; ++i){
+        this->sync_msgs[i] += MSG_DELIMITER;
+        _asio::async_write(*this->socks[i],
+                           _asio::buffer(this->sync_msgs[i]),
+                           boost::bind(&RelayServer::onSendSync, this, _ph::error, _ph::bytes_transferred, i)
+        );
+    }
+}
+
+/* the callback when sending a sync message to the display node */
+void RelayServer::onSendSync(const err_t& err, size_t t_bytes, const int id){
+    if(err){
+        _ml::caution("Failed to send sync message", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+    this->recvSync(id);
+}